@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "atlas/AtlasGenerator.hpp"
+#include "atlas/GlyphGeometry.hpp"
+#include "atlas/types.hpp"
+#include "ext/import-font.hpp"
+
+namespace msdf_atlas {
+/**
+ * Serves glyph bitmaps on request, keeping loaded fonts and their edge-colored glyph shapes in memory.
+ * Requests and responses are exchanged as frames over a pair of streams (e.g. stdin and stdout of a child process).
+ * Each frame is a little-endian u32 byte length followed by the body. Request bodies start with a u32 command:
+ *   LOAD_FONT: the UTF-8 filename of the font fills the rest of the body.
+ *     Response: u32 status, u32 font id, f64 line height, ascender, descender, underline y, underline thickness
+ *   GENERATE: u32 count, followed by count 32-byte tile requests:
+ *     u32 font id, u32 identifier, u32 flags (GLYPH_INDEX), u32 image type, f64 em size in pixels, f64 pixel range
+ *     Response: u32 status, u32 count, followed by count tiles:
+ *     u32 status, u32 width, u32 height, u32 channels, f64 advance, f64 plane bounds left, bottom, right, top,
+ *     followed by width * height * channels bytes of pixels, in rows from bottom to top
+ * Metrics are in ems with the y axis pointing up. As in the atlas layout, the plane bounds correspond to the centers
+ * of the tile's outermost pixels. A GENERATE request whose response would be longer than MAX_FRAME_SIZE is rejected
+ * with INVALID_REQUEST as a whole. With the default coloring seed of zero, a tile matches the same glyph in an atlas
+ * generated with the same settings. A nonzero seed is combined with the glyph's identifier rather than its position in
+ * the atlas's glyph list, so the edge colors of MSDF and MTSDF tiles then differ from the atlas. All frames that
+ * arrive while a batch is being generated are combined into the next batch, whose tiles are generated in parallel.
+ */
+class GlyphServer
+{
+
+public:
+  enum Command : uint32_t { LOAD_FONT = 1, GENERATE = 2 };
+  enum Status : uint32_t { OK = 0, INVALID_REQUEST = 1, FONT_NOT_FOUND = 2, GLYPH_NOT_FOUND = 3 };
+  /// Tile request flag - the identifier is a glyph index rather than a Unicode codepoint
+  static const uint32_t GLYPH_INDEX = 0x01;
+  /// Request frames longer than this are rejected and end the session, longer responses are not generated
+  static const uint32_t MAX_FRAME_SIZE = 0x04000000;
+  /// Maximum em size and pixel range of a tile request
+  static constexpr double MAX_TILE_SIZE = 4096;
+
+  struct Settings
+  {
+    void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long);
+    double angleThreshold;
+    unsigned long long coloringSeed;
+    double miterLimit;
+    bool pxAlignOriginX, pxAlignOriginY;
+    GeneratorAttributes generatorAttributes;
+    int threadCount;
+  };
+
+  explicit GlyphServer(const Settings &settings);
+  ~GlyphServer();
+  GlyphServer(const GlyphServer &) = delete;
+  GlyphServer &operator=(const GlyphServer &) = delete;
+  /// Loads a font file and returns its id, or -1 on failure
+  int loadFont(const char *filename);
+  /// Processes requests from input and writes responses into output until the input ends or becomes invalid
+  bool run(FILE *input, FILE *output);
+
+private:
+  struct Font;
+  struct Tile;
+  struct ThreadScratch;
+
+  /// Size of a tile's response before its pixels
+  static const uint32_t TILE_HEADER_SIZE = 56;
+
+  Settings settings;
+  msdfgen::FreetypeHandle *ft;
+  std::vector<std::unique_ptr<Font>> fonts;
+  std::vector<Tile> tiles;
+  size_t tileCount;
+  std::vector<ThreadScratch> threadScratch;
+
+  void processFrames(std::vector<std::vector<byte>> &frames);
+  bool parseTiles(const std::vector<byte> &frame);
+  void generateTiles();
+  void writeTiles(std::vector<byte> &response, size_t tileStart, size_t tileEnd) const;
+  const GlyphGeometry *getGlyph(Font &font, uint32_t identifier, uint32_t flags);
+};
+}// namespace msdf_atlas
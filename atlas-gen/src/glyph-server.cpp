@@ -0,0 +1,372 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "atlas/FontGeometry.hpp"
+#include "atlas/Workload.hpp"
+#include "atlas/glyph-generators.hpp"
+#include "core/edge-coloring.hpp"
+#include "core/load-file.hpp"
+#include "core/pixel-conversion.hpp"
+#include "glyph-server.hpp"
+
+namespace msdf_atlas {
+struct GlyphServer::Font
+{
+  std::vector<byte> data;
+  msdfgen::FontHandle *handle;
+  msdfgen::FontMetrics metrics;
+  double geometryScale;
+  /// Edge-colored glyphs by identifier and GLYPH_INDEX flag, null for glyphs missing in the font
+  std::map<uint64_t, std::unique_ptr<GlyphGeometry>> glyphs;
+
+  Font() : handle(nullptr), metrics(), geometryScale() {}
+  ~Font()
+  {
+    if (handle) msdfgen::destroyFont(handle);
+  }
+};
+
+struct GlyphServer::Tile
+{
+  const GlyphGeometry *glyph;
+  ImageType imageType;
+  double emSize, pxRange;
+  uint32_t status;
+  int width, height, channels;
+  double advance, l, b, r, t;
+  std::vector<byte> pixels;
+};
+
+/// Buffers of a single thread, which are kept between batches
+struct GlyphServer::ThreadScratch
+{
+  GlyphGeometry glyph;
+  std::vector<float> bitmap;
+  msdfgen::GeneratorContext generatorContext;
+};
+
+static uint32_t getU32(const byte *src)
+{
+  return (uint32_t)src[0] | (uint32_t)src[1] << 8 | (uint32_t)src[2] << 16 | (uint32_t)src[3] << 24;
+}
+
+static double getF64(const byte *src)
+{
+  uint64_t bits = 0;
+  for (int i = 0; i < 8; ++i) bits |= (uint64_t)src[i] << 8 * i;
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void appendU32(std::vector<byte> &dst, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) dst.push_back((byte)(value >> 8 * i));
+}
+
+static void appendF64(std::vector<byte> &dst, double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; ++i) dst.push_back((byte)(bits >> 8 * i));
+}
+
+template<int N, GeneratorFunction<float, N> GEN_FN>
+static void generateTile(std::vector<byte> &pixels,
+  std::vector<float> &bitmap,
+  const GlyphGeometry &glyph,
+  int width,
+  int height,
+  const GeneratorAttributes &attributes)
+{
+  bitmap.resize(N * width * height);
+  GEN_FN(msdfgen::BitmapRef<float, N>(bitmap.data(), width, height), glyph, attributes);
+  pixels.resize(bitmap.size());
+  for (size_t i = 0; i < bitmap.size(); ++i) pixels[i] = msdfgen::pixelFloatToByte(bitmap[i]);
+}
+
+GlyphServer::GlyphServer(const Settings &settings)
+  : settings(settings), ft(msdfgen::initializeFreetype()), tileCount(0),
+    threadScratch(std::max(settings.threadCount, 1))
+{
+  this->settings.threadCount = (int)threadScratch.size();
+}
+
+GlyphServer::~GlyphServer()
+{
+  fonts.clear();
+  if (ft) msdfgen::deinitializeFreetype(ft);
+}
+
+int GlyphServer::loadFont(const char *filename)
+{
+  if (!ft) return -1;
+  std::unique_ptr<Font> font(new Font);
+  if (!msdfgen::loadFile(font->data, filename)) return -1;
+  if (!((font->handle = msdfgen::loadFontData(ft, font->data.data(), (int)font->data.size()))
+        && msdfgen::getFontMetrics(font->metrics, font->handle)))
+    return -1;
+  // Same normalization as FontGeometry::loadMetrics, which makes the geometry and metrics scale 1 em to 1 unit
+  msdfgen::FontMetrics &metrics = font->metrics;
+  if (metrics.emSize <= 0) metrics.emSize = MSDFLIB_DEFAULT_EM_SIZE;
+  font->geometryScale = 1 / metrics.emSize;
+  metrics.emSize = 1;
+  metrics.ascenderY *= font->geometryScale;
+  metrics.descenderY *= font->geometryScale;
+  metrics.lineHeight *= font->geometryScale;
+  metrics.underlineY *= font->geometryScale;
+  metrics.underlineThickness *= font->geometryScale;
+  fonts.push_back((std::unique_ptr<Font> &&)font);
+  return (int)fonts.size() - 1;
+}
+
+const GlyphGeometry *GlyphServer::getGlyph(Font &font, uint32_t identifier, uint32_t flags)
+{
+  uint64_t key = (uint64_t)(flags & GLYPH_INDEX) << 32 | identifier;
+  std::map<uint64_t, std::unique_ptr<GlyphGeometry>>::iterator it = font.glyphs.find(key);
+  if (it == font.glyphs.end()) {
+    std::unique_ptr<GlyphGeometry> glyph(new GlyphGeometry);
+    bool loaded = flags & GLYPH_INDEX
+                    ? glyph->load(font.handle, font.geometryScale, msdfgen::GlyphIndex(identifier))
+                    : glyph->load(font.handle, font.geometryScale, identifier);
+    if (loaded) {
+      // Colored once for all image types, with a seed derived from the identifier so that it does not depend on the
+      // order of requests. atlas-gen derives it from the glyph's list index, so the colors only match for seed zero
+      unsigned long long glyphSeed =
+        (MSDFLIB_LCG_MULTIPLIER * (settings.coloringSeed ^ identifier) + MSDFLIB_LCG_INCREMENT)
+        * !!settings.coloringSeed;
+      glyph->edgeColoring(settings.edgeColoring, settings.angleThreshold, glyphSeed);
+    } else
+      glyph.reset();
+    it = font.glyphs.insert(std::make_pair(key, (std::unique_ptr<GlyphGeometry> &&)glyph)).first;
+  }
+  return it->second.get();
+}
+
+/// Outputs the arguments of GlyphGeometry::wrapBox for a tile - masks only need a single pixel of range
+static void getTileBoxArguments(double &range,
+  double &miterLimit,
+  ImageType imageType,
+  double emSize,
+  double pxRange,
+  double maxMiterLimit)
+{
+  bool mask = imageType == ImageType::HARD_MASK || imageType == ImageType::SOFT_MASK;
+  bool miter = imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF;
+  range = (mask ? 1 : pxRange) / emSize;
+  miterLimit = miter ? maxMiterLimit : 0;
+}
+
+bool GlyphServer::parseTiles(const std::vector<byte> &frame)
+{
+  if (frame.size() < 8) return false;
+  uint32_t count = getU32(frame.data() + 4);
+  if (frame.size() != 8 + 32 * (size_t)count) return false;
+  const byte *request = frame.data() + 8;
+  // The response must fit into a frame, which is checked before anything is generated
+  size_t tileStart = tileCount;
+  uint64_t responseSize = 8;
+  for (uint32_t i = 0; i < count; ++i, request += 32) {
+    if (tileCount == tiles.size()) tiles.emplace_back();
+    Tile &tile = tiles[tileCount++];
+    uint32_t fontId = getU32(request);
+    uint32_t imageType = getU32(request + 12);
+    tile.glyph = nullptr;
+    tile.imageType = (ImageType)imageType;
+    tile.emSize = getF64(request + 16);
+    tile.pxRange = getF64(request + 24);
+    tile.width = 0, tile.height = 0, tile.channels = 0;
+    tile.advance = 0, tile.l = 0, tile.b = 0, tile.r = 0, tile.t = 0;
+    if (!(imageType <= (uint32_t)ImageType::MTSDF && tile.emSize > 0 && tile.emSize <= MAX_TILE_SIZE
+          && tile.pxRange > 0 && tile.pxRange <= MAX_TILE_SIZE))
+      tile.status = INVALID_REQUEST;
+    else if (fontId >= fonts.size())
+      tile.status = FONT_NOT_FOUND;
+    else if (!(tile.glyph = getGlyph(*fonts[fontId], getU32(request + 4), getU32(request + 8))))
+      tile.status = GLYPH_NOT_FOUND;
+    else
+      tile.status = OK;
+    responseSize += TILE_HEADER_SIZE;
+    if (tile.status == OK) {
+      double range, miterLimit;
+      int w, h;
+      getTileBoxArguments(range, miterLimit, tile.imageType, tile.emSize, tile.pxRange, settings.miterLimit);
+      tile.glyph->measureBox(w, h, tile.emSize, range, miterLimit, settings.pxAlignOriginX, settings.pxAlignOriginY);
+      int channels = tile.imageType == ImageType::MSDF ? 3 : tile.imageType == ImageType::MTSDF ? 4 : 1;
+      if (w > 0 && h > 0) responseSize += (uint64_t)w * h * channels;
+    }
+    if (responseSize > MAX_FRAME_SIZE) {
+      tileCount = tileStart;
+      return false;
+    }
+  }
+  return true;
+}
+
+void GlyphServer::generateTiles()
+{
+  Workload(
+    [this](int i, int threadNo) -> bool {
+      Tile &tile = tiles[i];
+      if (tile.status != OK) return true;
+      ThreadScratch &scratch = threadScratch[threadNo];
+      // The box is computed on a copy so that the same glyph can be generated in several sizes at once
+      GlyphGeometry &glyph = scratch.glyph;
+      glyph = *tile.glyph;
+      double range, miterLimit;
+      getTileBoxArguments(range, miterLimit, tile.imageType, tile.emSize, tile.pxRange, settings.miterLimit);
+      glyph.wrapBox(tile.emSize, range, miterLimit, settings.pxAlignOriginX, settings.pxAlignOriginY);
+      glyph.getBoxSize(tile.width, tile.height);
+      glyph.getQuadPlaneBounds(tile.l, tile.b, tile.r, tile.t);
+      tile.advance = glyph.getAdvance();
+      tile.channels = tile.imageType == ImageType::MSDF ? 3 : tile.imageType == ImageType::MTSDF ? 4 : 1;
+      tile.pixels.clear();
+      if (!(tile.width > 0 && tile.height > 0)) return true;
+
+      GeneratorAttributes attributes = settings.generatorAttributes;
+      attributes.context = &scratch.generatorContext;
+      switch (tile.imageType) {
+      case ImageType::HARD_MASK:
+        generateTile<1, scanlineGenerator>(tile.pixels, scratch.bitmap, glyph, tile.width, tile.height, attributes);
+        break;
+      case ImageType::SOFT_MASK:
+      case ImageType::SDF:
+        generateTile<1, sdfGenerator>(tile.pixels, scratch.bitmap, glyph, tile.width, tile.height, attributes);
+        break;
+      case ImageType::PSDF:
+        generateTile<1, psdfGenerator>(tile.pixels, scratch.bitmap, glyph, tile.width, tile.height, attributes);
+        break;
+      case ImageType::MSDF:
+        generateTile<3, msdfGenerator>(tile.pixels, scratch.bitmap, glyph, tile.width, tile.height, attributes);
+        break;
+      case ImageType::MTSDF:
+        generateTile<4, mtsdfGenerator>(tile.pixels, scratch.bitmap, glyph, tile.width, tile.height, attributes);
+        break;
+      }
+      return true;
+    },
+    (int)tileCount)
+    .finish(settings.threadCount);
+}
+
+void GlyphServer::writeTiles(std::vector<byte> &response, size_t tileStart, size_t tileEnd) const
+{
+  response.clear();
+  appendU32(response, OK);
+  appendU32(response, (uint32_t)(tileEnd - tileStart));
+  for (size_t i = tileStart; i < tileEnd; ++i) {
+    const Tile &tile = tiles[i];
+    appendU32(response, tile.status);
+    appendU32(response, (uint32_t)tile.width);
+    appendU32(response, (uint32_t)tile.height);
+    appendU32(response, (uint32_t)tile.channels);
+    appendF64(response, tile.advance);
+    appendF64(response, tile.l);
+    appendF64(response, tile.b);
+    appendF64(response, tile.r);
+    appendF64(response, tile.t);
+    response.insert(response.end(), tile.pixels.begin(), tile.pixels.end());
+  }
+}
+
+void GlyphServer::processFrames(std::vector<std::vector<byte>> &frames)
+{
+  // Requests are handled in order, except that the tiles of all GENERATE requests are generated together at the end,
+  // and each frame is replaced by its response
+  struct TileRange
+  {
+    size_t frame, tileStart, tileEnd;
+  };
+  std::vector<TileRange> tileRanges;
+  tileCount = 0;
+  for (size_t i = 0; i < frames.size(); ++i) {
+    std::vector<byte> &frame = frames[i];
+    uint32_t command = frame.size() >= 4 ? getU32(frame.data()) : 0;
+    if (command == LOAD_FONT) {
+      std::string filename((const char *)frame.data() + 4, frame.size() - 4);
+      int fontId = loadFont(filename.c_str());
+      frame.clear();
+      if (fontId >= 0) {
+        const msdfgen::FontMetrics &metrics = fonts[fontId]->metrics;
+        appendU32(frame, OK);
+        appendU32(frame, (uint32_t)fontId);
+        appendF64(frame, metrics.lineHeight);
+        appendF64(frame, metrics.ascenderY);
+        appendF64(frame, metrics.descenderY);
+        appendF64(frame, metrics.underlineY);
+        appendF64(frame, metrics.underlineThickness);
+      } else
+        appendU32(frame, FONT_NOT_FOUND);
+      continue;
+    }
+    size_t tileStart = tileCount;
+    if (command == GENERATE && parseTiles(frame))
+      tileRanges.push_back(TileRange{ i, tileStart, tileCount });
+    else {
+      frame.clear();
+      appendU32(frame, INVALID_REQUEST);
+    }
+  }
+  generateTiles();
+  for (const TileRange &range : tileRanges) writeTiles(frames[range.frame], range.tileStart, range.tileEnd);
+}
+
+bool GlyphServer::run(FILE *input, FILE *output)
+{
+  // Frames are read on a separate thread, so that those arriving during generation can be batched together
+  std::mutex mutex;
+  std::condition_variable frameReceived;
+  std::vector<std::vector<byte>> receivedFrames;
+  bool inputEnded = false, inputValid = true;
+  std::thread reader([&]() {
+    for (;;) {
+      byte header[4];
+      if (fread(header, 1, 4, input) != 4) break;
+      uint32_t size = getU32(header);
+      if (size > MAX_FRAME_SIZE) {
+        inputValid = false;
+        break;
+      }
+      std::vector<byte> frame(size);
+      if (fread(frame.data(), 1, size, input) != size) {
+        inputValid = false;
+        break;
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      receivedFrames.push_back((std::vector<byte> &&)frame);
+      frameReceived.notify_one();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    inputEnded = true;
+    frameReceived.notify_one();
+  });
+
+  bool success = true;
+  std::vector<std::vector<byte>> frames;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      frameReceived.wait(lock, [&]() { return !receivedFrames.empty() || inputEnded; });
+      if (receivedFrames.empty()) break;
+      frames.swap(receivedFrames);
+      receivedFrames.clear();
+    }
+    processFrames(frames);
+    for (const std::vector<byte> &frame : frames) {
+      std::vector<byte> header;
+      appendU32(header, (uint32_t)frame.size());
+      success &= fwrite(header.data(), 1, header.size(), output) == header.size();
+      success &= fwrite(frame.data(), 1, frame.size(), output) == frame.size();
+    }
+    success &= fflush(output) == 0;
+    // Without anyone to read the responses, remaining requests are ignored until the input ends
+    if (!success) break;
+  }
+  reader.join();
+  return success && inputValid;
+}
+}// namespace msdf_atlas
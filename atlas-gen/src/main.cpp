@@ -1,25 +1,42 @@
 #define _USE_MATH_DEFINES
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cstdarg>
 #include <cstdio>
 #include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
 #include <thread>
 #include <vector>
 
 #include "atlas/AtlasGenerator.hpp"
 #include "atlas/BitmapAtlasStorage.hpp"
 #include "atlas/FontGeometry.hpp"
+#include "atlas/GlyphBitmapCache.hpp"
 #include "atlas/GridAtlasPacker.hpp"
+#include "atlas/ImageStreamWriter.hpp"
 #include "atlas/ImmediateAtlasGenerator.hpp"
+#include "atlas/MappedAtlasStorage.hpp"
+#include "atlas/StreamingAtlasGenerator.hpp"
 #include "atlas/TightAtlasPacker.hpp"
 #include "atlas/Workload.hpp"
+#include "atlas/binary-layout-export.hpp"
 #include "atlas/csv-export.hpp"
+#include "atlas/geometry-serialization.hpp"
 #include "atlas/glyph-generators.hpp"
 #include "atlas/image-save.hpp"
 #include "atlas/json-export.hpp"
 #include "atlas/shadron-preview-generator.hpp"
 #include "atlas/utf8.hpp"
 #include "core/edge-coloring.hpp"
+#include "core/load-file.hpp"
+#include "glyph-server.hpp"
 
 using namespace msdf_atlas;
 
@@ -28,8 +45,6 @@ using namespace msdf_atlas;
 #define DEFAULT_PIXEL_RANGE 2.0
 #define SDF_ERROR_ESTIMATE_PRECISION 19
 #define GLYPH_FILL_RULE msdfgen::FILL_NONZERO
-#define LCG_MULTIPLIER 6364136223846793005ull
-#define LCG_INCREMENT 1442695040888963407ull
 
 #define STRINGIZE_(x) #x
 #define STRINGIZE(x) STRINGIZE_(x)
@@ -57,17 +72,29 @@ INPUT SPECIFICATION
       Specifies a name for the font that will be propagated into the output files as metadata.
   -and
       Separates multiple inputs to be combined into a single atlas.
+  -geometry <filename>
+      Loads the glyph geometry, metrics and kerning of all inputs from a file saved with -savegeometry instead of fonts.
+      Edge coloring stored in the file is reused.
 
 ATLAS CONFIGURATION
   -type <hardmask / softmask / sdf / psdf / msdf / mtsdf>
-      Selects the type of atlas to be generated.
+      Selects the type of atlas to be generated. A comma-separated list of types generates an atlas of each type
+      from the same loaded geometry, in which case output filenames must contain {type}.
   -format <png / bmp / tiff / text / textfloat / bin / binfloat / binfloatbe>
       Selects the format for the atlas image output. Some image formats may be incompatible with embedded output formats.
   -dimensions <width> <height>
       Sets the atlas to have fixed dimensions (width x height).
+  -maxdimensions <width> <height>
+      Limits the atlas dimensions. Glyphs that do not fit spill into additional pages, saved as separate images.
   -pots / -potr / -square / -square2 / -square4
       Picks the minimum atlas dimensions that fit all glyphs and satisfy the selected constraint:
       power of two square / ... rectangle / any square / square with side divisible by 2 / ... 4
+  -packer <guillotine / skyline>
+      Selects the rectangle packing algorithm. Skyline is much faster for large glyph sets but packs less tightly.
+  -allowrotate
+      Allows glyphs to be rotated by 90 degrees in the atlas for denser packing. Rotated glyphs are flagged in the layout.
+  -dedup
+      Glyphs with identical geometry (e.g. from multiple codepoints or fonts) are generated once and share one box.
   -uniformgrid
       Lays out the atlas into a uniform grid. Enables following options starting with -uniform:
     -uniformcols <N>
@@ -84,16 +111,28 @@ ATLAS CONFIGURATION
 OUTPUT SPECIFICATION - one or more can be specified
   -imageout <filename.*>
       Saves the atlas as an image file with the specified format. Layout data must be stored separately.
+  -streaming
+      Generates the atlas image in bands of rows written directly into the image file to reduce peak memory usage.
+  -mmap
+      Generates the atlas directly into a memory-mapped image file, which may exceed available memory. Raw binary formats only.
+  -cachedir <directory>
+      Reuses glyph bitmaps generated by previous runs with identical settings from the directory and stores new ones into it.
   -json <filename.json>
       Writes the atlas's layout data, as well as other metrics into a structured JSON file.
   -csv <filename.csv>
       Writes the layout data of the glyphs into a simple CSV file.
+  -binlayout <filename>
+      Writes the same data as the JSON file into a compact binary file that can be read without parsing.
   -shadronpreview <filename.shadron> <sample text>
       Generates a Shadron script that uses the generated atlas to draw a sample text as a preview.
+  -savegeometry <filename>
+      Saves the loaded glyph geometry, metrics and kerning into a binary file that can be loaded with -geometry.
+      Shapes are edge colored first if the atlas type is msdf or mtsdf.
 
 GLYPH CONFIGURATION
   -size <em size>
-      Specifies the size of the glyphs in the atlas bitmap in pixels per em.
+      Specifies the size of the glyphs in the atlas bitmap in pixels per em. A comma-separated list of sizes generates
+      an atlas of each size, in which case output filenames must contain {size}.
   -minsize <em size>
       Specifies the minimum size. The largest possible size that fits the same atlas dimensions will be used.
   -emrange <em range>
@@ -104,6 +143,8 @@ GLYPH CONFIGURATION
       Specifies whether each glyph's origin point should be aligned with the pixel grid.
   -nokerning
       Disables inclusion of kerning pair table in output files.
+  -gposkerning
+      Also reads kerning pairs from the GPOS table of OpenType fonts, for pairs not present in the legacy kern table.
 
 DISTANCE FIELD GENERATOR SETTINGS
   -angle <angle>
@@ -126,6 +167,21 @@ DISTANCE FIELD GENERATOR SETTINGS
       Sets the initial seed for the edge coloring heuristic.
   -threads <N>
       Sets the number of threads for the parallel computation. (0 = auto)
+
+BATCH PROCESSING
+  -manifest <filename>
+      Runs each line of the file as a separate job with its own arguments, in a single process that reads each font
+      file only once and shares its threads between jobs. Must be the first argument. Further arguments apply to all
+      jobs. Empty lines and lines starting with # are skipped, arguments with spaces can be enclosed in double quotes.
+  -jobs <N>
+      Sets the number of manifest jobs that run at the same time. Must follow the manifest filename. The default is 2.
+
+GLYPH SERVER
+  -server
+      Keeps running and generates individual glyph bitmaps requested over stdin, writing them into stdout. Loaded fonts
+      and glyph shapes are kept in memory between requests. Must be the first argument. Refer to glyph-server.hpp for
+      the protocol. Other options which apply: -font (preloaded in order as font 0, 1, ...), -coloringstrategy, -angle,
+      -seed, -miterlimit, -threads.
 )";
 
 static const char *errorCorrectionHelpText = R"(
@@ -154,19 +210,19 @@ static char toupper(char c) { return c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c; }
 
 static bool parseUnsigned(unsigned &value, const char *arg)
 {
-  static char c;
+  char c;
   return sscanf(arg, "%u%c", &value, &c) == 1;
 }
 
 static bool parseUnsignedLL(unsigned long long &value, const char *arg)
 {
-  static char c;
+  char c;
   return sscanf(arg, "%llu%c", &value, &c) == 1;
 }
 
 static bool parseDouble(double &value, const char *arg)
 {
-  static char c;
+  char c;
   return sscanf(arg, "%lf%c", &value, &c) == 1;
 }
 
@@ -182,6 +238,55 @@ static bool parseAngle(double &value, const char *arg)
   return false;
 }
 
+/// Splits a comma-separated list
+static void splitList(std::vector<std::string> &items, const char *list)
+{
+  for (const char *item = list;;) {
+    size_t length = strcspn(item, ",");
+    items.push_back(std::string(item, length));
+    if (!item[length]) break;
+    item += length + 1;
+  }
+}
+
+static bool parseImageType(ImageType &imageType, const char *name)
+{
+  if (!strcmp(name, "hardmask"))
+    imageType = ImageType::HARD_MASK;
+  else if (!strcmp(name, "softmask"))
+    imageType = ImageType::SOFT_MASK;
+  else if (!strcmp(name, "sdf"))
+    imageType = ImageType::SDF;
+  else if (!strcmp(name, "psdf"))
+    imageType = ImageType::PSDF;
+  else if (!strcmp(name, "msdf"))
+    imageType = ImageType::MSDF;
+  else if (!strcmp(name, "mtsdf"))
+    imageType = ImageType::MTSDF;
+  else
+    return false;
+  return true;
+}
+
+static const char *imageTypeName(ImageType imageType)
+{
+  switch (imageType) {
+  case ImageType::HARD_MASK:
+    return "hardmask";
+  case ImageType::SOFT_MASK:
+    return "softmask";
+  case ImageType::SDF:
+    return "sdf";
+  case ImageType::PSDF:
+    return "psdf";
+  case ImageType::MSDF:
+    return "msdf";
+  case ImageType::MTSDF:
+    return "mtsdf";
+  }
+  return nullptr;
+}
+
 static bool cmpExtension(const char *path, const char *ext)
 {
   for (const char *a = path + strlen(path) - 1, *b = ext + strlen(ext) - 1; b >= ext; --a, --b)
@@ -189,6 +294,32 @@ static bool cmpExtension(const char *path, const char *ext)
   return true;
 }
 
+/// Inserts the page index before the extension of the filename of a multi-page atlas's image
+static std::string pageFilename(const char *filename, int page, int pageCount)
+{
+  std::string result(filename);
+  if (pageCount > 1) {
+    size_t extension = result.find_last_of('.');
+    size_t separator = result.find_last_of("/\\");
+    if (extension == std::string::npos || (separator != std::string::npos && extension < separator))
+      extension = result.size();
+    result.insert(extension, "_" + std::to_string(page));
+  }
+  return result;
+}
+
+/// Replaces the {type} and {size} placeholders in an output filename
+static std::string outputFilename(const char *filename, ImageType imageType, double emSize)
+{
+  std::string result(filename);
+  char size[32];
+  snprintf(size, sizeof(size), "%.9g", emSize);
+  for (size_t pos; (pos = result.find("{type}")) != std::string::npos;)
+    result.replace(pos, 6, imageTypeName(imageType));
+  for (size_t pos; (pos = result.find("{size}")) != std::string::npos;) result.replace(pos, 6, size);
+  return result;
+}
+
 static bool strStartsWith(const char *str, const char *prefix)
 {
   while (*prefix)
@@ -212,6 +343,8 @@ struct Configuration
   ImageFormat imageFormat;
   YDirection yDirection;
   int width, height;
+  int pageCount;
+  bool allowRotation;
   double emSize;
   double pxRange;
   double angleThreshold;
@@ -229,44 +362,269 @@ struct Configuration
   GeneratorAttributes generatorAttributes;
   bool preprocessGeometry;
   bool kerning;
+  bool gposKerning;
   int threadCount;
+  bool streaming;
+  bool mappedImage;
+  const char *bitmapCacheDirectory;
   const char *imageFilename;
   const char *jsonFilename;
   const char *csvFilename;
+  const char *binaryLayoutFilename;
   const char *shadronPreviewFilename;
   const char *shadronPreviewText;
 };
 
+/// Glyph layout parameters that depend on the atlas type
+struct LayoutSettings
+{
+  int spacing;
+  double miterLimit;
+  double pxRange, unitRange;
+
+  bool operator==(const LayoutSettings &other) const
+  {
+    return spacing == other.spacing && miterLimit == other.miterLimit && pxRange == other.pxRange
+           && unitRange == other.unitRange;
+  }
+};
+
+/// Keeps the contents of font files in memory so that each is only read once, e.g. by multiple jobs of a manifest
+class FontDataCache
+{
+
+public:
+  /// Returns the contents of the font file, or null if it could not be read
+  const std::vector<byte> *get(const char *filename)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, std::vector<byte>>::iterator it = files.find(filename);
+    if (it == files.end()) {
+      std::vector<byte> data;
+      if (!msdfgen::loadFile(data, filename)) return nullptr;
+      it = files.insert(std::make_pair(std::string(filename), (std::vector<byte> &&)data)).first;
+    }
+    return &it->second;
+  }
+
+private:
+  std::mutex mutex;
+  std::map<std::string, std::vector<byte>> files;
+};
+
+/// Prefix of the messages of the job run by the current thread, which identifies it when jobs run concurrently
+static thread_local const char *messagePrefix = nullptr;
+
+static void appendFormattedV(std::string &output, const char *format, va_list args)
+{
+  va_list argsCopy;
+  va_copy(argsCopy, args);
+  int length = vsnprintf(nullptr, 0, format, argsCopy);
+  va_end(argsCopy);
+  if (length <= 0) return;
+  size_t prevSize = output.size();
+  output.resize(prevSize + length + 1);
+  vsnprintf(&output[prevSize], length + 1, format, args);
+  output.resize(prevSize + length);
+}
+
+/// Appends printf-formatted text to output
+static void appendFormatted(std::string &output, const char *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  appendFormattedV(output, format, args);
+  va_end(args);
+}
+
+/// Prints a message, which consists of whole lines, in a single write, so that it does not get mixed with messages
+/// of other jobs. Each line starts with the current job's prefix
+static void printMessage(FILE *stream, const char *format, ...)
+{
+  std::string text;
+  va_list args;
+  va_start(args, format);
+  appendFormattedV(text, format, args);
+  va_end(args);
+  std::string output;
+  for (size_t line = 0; line < text.size();) {
+    size_t lineEnd = text.find('\n', line);
+    lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+    if (messagePrefix) output += messagePrefix;
+    output.append(text, line, lineEnd - line);
+    line = lineEnd;
+  }
+  fwrite(output.data(), 1, output.size(), stream);
+}
+
+static void colorEdges(std::vector<GlyphGeometry> &glyphs, const Configuration &config)
+{
+  if (config.expensiveColoring) {
+    Workload(
+      [&glyphs, &config](int i, int threadNo) -> bool {
+        unsigned long long glyphSeed =
+          (MSDFLIB_LCG_MULTIPLIER * (config.coloringSeed ^ i) + MSDFLIB_LCG_INCREMENT) * !!config.coloringSeed;
+        if (!glyphs[i].isBoxDuplicate()) glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
+        return true;
+      },
+      glyphs.size())
+      .finish(config.threadCount);
+  } else {
+    unsigned long long glyphSeed = config.coloringSeed;
+    for (GlyphGeometry &glyph : glyphs) {
+      glyphSeed *= MSDFLIB_LCG_MULTIPLIER;
+      if (!glyph.isBoxDuplicate()) glyph.edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
+    }
+  }
+}
+
+static void printBitmapCacheStats(const GlyphBitmapCache &cache)
+{
+  GlyphBitmapCache::Stats stats = cache.getStats();
+  printMessage(stderr,
+    "Glyph bitmap cache: %llu hits, %llu misses, %llu KiB read, %llu KiB written.\n",
+    stats.hits,
+    stats.misses,
+    (stats.bytesRead + 1023) / 1024,
+    (stats.bytesWritten + 1023) / 1024);
+}
+
 template<typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
 static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs,
   const std::vector<FontGeometry> &fonts,
-  const Configuration &config)
+  const Configuration &config,
+  const char *generatorName)
 {
+  GlyphBitmapCache bitmapCache;
+  if (config.bitmapCacheDirectory && !config.streaming && !bitmapCache.open(config.bitmapCacheDirectory))
+    printMessage(stderr, "Warning: Failed to open the glyph bitmap cache directory, glyphs will not be cached.\n");
+
+  if (config.streaming) {
+    StreamingAtlasGenerator<S, N, GEN_FN> generator(config.width, config.height);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    bool success = true;
+    for (int page = 0; page < config.pageCount && success; ++page) {
+      ImageStreamWriter<T, N> writer;
+      success = writer.open(pageFilename(config.imageFilename, page, config.pageCount).c_str(),
+        config.imageFormat,
+        config.width,
+        config.height,
+        config.yDirection);
+      if (success) {
+        success = generator.generate(glyphs.data(), glyphs.size(), writer, page);
+        success &= writer.close();
+      }
+    }
+    if (success)
+      printMessage(stderr, "Atlas image file saved.\n");
+    else
+      printMessage(stderr, "Failed to save the atlas as an image file.\n");
+    return success;
+  }
+
+  if (config.mappedImage) {
+    ImmediateAtlasGenerator<S, N, GEN_FN, MappedAtlasStorage<T, N>> generator(config.width,
+      config.height,
+      pageFilename(config.imageFilename, 0, config.pageCount).c_str(),
+      config.yDirection);
+    for (int page = 1; page < config.pageCount; ++page)
+      generator.addPage(config.width,
+        config.height,
+        pageFilename(config.imageFilename, page, config.pageCount).c_str(),
+        config.yDirection);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    if (bitmapCache.isOpen()) generator.setBitmapCache(&bitmapCache, generatorName);
+    bool success = true;
+    for (int page = 0; page < config.pageCount; ++page) success &= generator.atlasStorage(page).isOpen();
+    if (success) {
+      generator.generate(glyphs.data(), glyphs.size());
+      if (bitmapCache.isOpen()) printBitmapCacheStats(bitmapCache);
+      for (int page = 0; page < config.pageCount; ++page) success &= generator.atlasStorage(page).flush();
+    }
+    if (success)
+      printMessage(stderr, "Atlas image file saved.\n");
+    else
+      printMessage(stderr, "Failed to save the atlas as an image file.\n");
+    return success;
+  }
+
   ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N>> generator(config.width, config.height);
+  for (int page = 1; page < config.pageCount; ++page) generator.addPage(config.width, config.height);
   generator.setAttributes(config.generatorAttributes);
   generator.setThreadCount(config.threadCount);
+  if (bitmapCache.isOpen()) generator.setBitmapCache(&bitmapCache, generatorName);
   generator.generate(glyphs.data(), glyphs.size());
-  msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>)generator.atlasStorage();
+  if (bitmapCache.isOpen()) printBitmapCacheStats(bitmapCache);
 
   bool success = true;
 
   if (config.imageFilename) {
-    if (saveImage(bitmap, config.imageFormat, config.imageFilename, config.yDirection))
-      fputs("Atlas image file saved.\n", stderr);
-    else {
-      success = false;
-      fputs("Failed to save the atlas as an image file.\n", stderr);
+    for (int page = 0; page < config.pageCount; ++page) {
+      msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>)generator.atlasStorage(page);
+      success &= saveImage(bitmap,
+        config.imageFormat,
+        pageFilename(config.imageFilename, page, config.pageCount).c_str(),
+        config.yDirection);
     }
+    if (success)
+      printMessage(stderr, "Atlas image file saved.\n");
+    else
+      printMessage(stderr, "Failed to save the atlas as an image file.\n");
   }
   return success;
 }
 
-int main(int argc, const char *const *argv)
+/// Generates the atlas image of the configured type with the corresponding instantiation of makeAtlas
+static bool generateAtlas(const std::vector<GlyphGeometry> &glyphs,
+  const std::vector<FontGeometry> &fonts,
+  const Configuration &config,
+  bool floatingPointFormat)
 {
-#define ABORT(msg)           \
-  do {                       \
-    fputs(msg "\n", stderr); \
-    return 1;                \
+  bool success = false;
+  switch (config.imageType) {
+  case ImageType::HARD_MASK:
+    if (floatingPointFormat)
+      success = makeAtlas<float, float, 1, scanlineGenerator>(glyphs, fonts, config, "scanline");
+    else
+      success = makeAtlas<byte, float, 1, scanlineGenerator>(glyphs, fonts, config, "scanline");
+    break;
+  case ImageType::SOFT_MASK:
+  case ImageType::SDF:
+    if (floatingPointFormat)
+      success = makeAtlas<float, float, 1, sdfGenerator>(glyphs, fonts, config, "sdf");
+    else
+      success = makeAtlas<byte, float, 1, sdfGenerator>(glyphs, fonts, config, "sdf");
+    break;
+  case ImageType::PSDF:
+    if (floatingPointFormat)
+      success = makeAtlas<float, float, 1, psdfGenerator>(glyphs, fonts, config, "psdf");
+    else
+      success = makeAtlas<byte, float, 1, psdfGenerator>(glyphs, fonts, config, "psdf");
+    break;
+  case ImageType::MSDF:
+    if (floatingPointFormat)
+      success = makeAtlas<float, float, 3, msdfGenerator>(glyphs, fonts, config, "msdf");
+    else
+      success = makeAtlas<byte, float, 3, msdfGenerator>(glyphs, fonts, config, "msdf");
+    break;
+  case ImageType::MTSDF:
+    if (floatingPointFormat)
+      success = makeAtlas<float, float, 4, mtsdfGenerator>(glyphs, fonts, config, "mtsdf");
+    else
+      success = makeAtlas<byte, float, 4, mtsdfGenerator>(glyphs, fonts, config, "mtsdf");
+    break;
+  }
+  return success;
+}
+
+static int runJob(int argc, const char *const *argv, FontDataCache &fontDataCache)
+{
+#define ABORT(msg)                     \
+  do {                                 \
+    printMessage(stderr, "%s\n", msg); \
+    return 1;                          \
   } while (false)
 
   int result = 0;
@@ -275,14 +633,15 @@ int main(int argc, const char *const *argv)
   Configuration config = {};
   fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
   fontInput.fontScale = -1;
-  config.imageType = ImageType::MSDF;
   config.imageFormat = ImageFormat::UNSPECIFIED;
   config.yDirection = YDirection::BOTTOM_UP;
   config.grid.fixedOriginX = false, config.grid.fixedOriginY = true;
   config.edgeColoring = msdfgen::edgeColoringInkTrap;
   config.kerning = true;
+  config.gposKerning = false;
   const char *imageFormatName = nullptr;
   int fixedWidth = -1, fixedHeight = -1;
+  int maxPageWidth = -1, maxPageHeight = -1;
   int fixedCellWidth = -1, fixedCellHeight = -1;
   config.preprocessGeometry = (
 #ifdef MSDFGEN_USE_SKIA
@@ -293,6 +652,8 @@ int main(int argc, const char *const *argv)
   );
   config.generatorAttributes.config.overlapSupport = !config.preprocessGeometry;
   config.generatorAttributes.scanlinePass = !config.preprocessGeometry;
+  std::vector<ImageType> imageTypes(1, ImageType::MSDF);
+  std::vector<double> emSizes;
   double minEmSize = 0;
   enum {
     /// Range specified in ems
@@ -302,6 +663,10 @@ int main(int argc, const char *const *argv)
   } rangeMode = RANGE_PIXEL;
   double rangeValue = 0;
   PackingStyle packingStyle = PackingStyle::TIGHT;
+  PackingAlgorithm packingAlgorithm = PackingAlgorithm::GUILLOTINE;
+  bool deduplication = false;
+  const char *geometryFilename = nullptr;
+  const char *geometryOutputFilename = nullptr;
   DimensionsConstraint atlasSizeConstraint = DimensionsConstraint::NONE;
   DimensionsConstraint cellSizeConstraint = DimensionsConstraint::NONE;
   config.angleThreshold = DEFAULT_ANGLE_THRESHOLD;
@@ -325,21 +690,16 @@ int main(int argc, const char *const *argv)
 
     ARG_CASE("-type", 1)
     {
-      if (ARG_IS("hardmask"))
-        config.imageType = ImageType::HARD_MASK;
-      else if (ARG_IS("softmask"))
-        config.imageType = ImageType::SOFT_MASK;
-      else if (ARG_IS("sdf"))
-        config.imageType = ImageType::SDF;
-      else if (ARG_IS("psdf"))
-        config.imageType = ImageType::PSDF;
-      else if (ARG_IS("msdf"))
-        config.imageType = ImageType::MSDF;
-      else if (ARG_IS("mtsdf"))
-        config.imageType = ImageType::MTSDF;
-      else
-        ABORT("Invalid atlas type. Valid types are: hardmask, softmask, sdf, psdf, msdf, mtsdf");
-      ++argPos;
+      std::vector<std::string> names;
+      splitList(names, argv[argPos++]);
+      imageTypes.clear();
+      for (const std::string &name : names) {
+        ImageType imageType;
+        if (!parseImageType(imageType, name.c_str()))
+          ABORT("Invalid atlas type. Valid types are: hardmask, softmask, sdf, psdf, msdf, mtsdf");
+        if (std::find(imageTypes.begin(), imageTypes.end(), imageType) == imageTypes.end())
+          imageTypes.push_back(imageType);
+      }
       continue;
     }
     ARG_CASE("-format", 1)
@@ -419,11 +779,36 @@ int main(int argc, const char *const *argv)
       fontInput.fontName = nullptr;
       continue;
     }
+    ARG_CASE("-geometry", 1)
+    {
+      geometryFilename = argv[argPos++];
+      continue;
+    }
+    ARG_CASE("-savegeometry", 1)
+    {
+      geometryOutputFilename = argv[argPos++];
+      continue;
+    }
     ARG_CASE("-imageout", 1)
     {
       config.imageFilename = argv[argPos++];
       continue;
     }
+    ARG_CASE("-streaming", 0)
+    {
+      config.streaming = true;
+      continue;
+    }
+    ARG_CASE("-mmap", 0)
+    {
+      config.mappedImage = true;
+      continue;
+    }
+    ARG_CASE("-cachedir", 1)
+    {
+      config.bitmapCacheDirectory = argv[argPos++];
+      continue;
+    }
     ARG_CASE("-json", 1)
     {
       config.jsonFilename = argv[argPos++];
@@ -434,6 +819,11 @@ int main(int argc, const char *const *argv)
       config.csvFilename = argv[argPos++];
       continue;
     }
+    ARG_CASE("-binlayout", 1)
+    {
+      config.binaryLayoutFilename = argv[argPos++];
+      continue;
+    }
     ARG_CASE("-shadronpreview", 2)
     {
       config.shadronPreviewFilename = argv[argPos++];
@@ -448,6 +838,14 @@ int main(int argc, const char *const *argv)
       fixedWidth = w, fixedHeight = h;
       continue;
     }
+    ARG_CASE("-maxdimensions", 2)
+    {
+      unsigned w, h;
+      if (!(parseUnsigned(w, argv[argPos++]) && parseUnsigned(h, argv[argPos++]) && w && h))
+        ABORT("Invalid maximum atlas dimensions. Use -maxdimensions <width> <height> with two positive integers.");
+      maxPageWidth = w, maxPageHeight = h;
+      continue;
+    }
     ARG_CASE("-pots", 0)
     {
       atlasSizeConstraint = DimensionsConstraint::POWER_OF_TWO_SQUARE;
@@ -478,6 +876,27 @@ int main(int argc, const char *const *argv)
       fixedWidth = -1, fixedHeight = -1;
       continue;
     }
+    ARG_CASE("-packer", 1)
+    {
+      if (ARG_IS("guillotine"))
+        packingAlgorithm = PackingAlgorithm::GUILLOTINE;
+      else if (ARG_IS("skyline"))
+        packingAlgorithm = PackingAlgorithm::SKYLINE;
+      else
+        ABORT("Unknown packing algorithm. Use -packer with one of: guillotine, skyline.");
+      ++argPos;
+      continue;
+    }
+    ARG_CASE("-dedup", 0)
+    {
+      deduplication = true;
+      continue;
+    }
+    ARG_CASE("-allowrotate", 0)
+    {
+      config.allowRotation = true;
+      continue;
+    }
     ARG_CASE("-yorigin", 1)
     {
       if (ARG_IS("bottom"))
@@ -491,10 +910,15 @@ int main(int argc, const char *const *argv)
     }
     ARG_CASE("-size", 1)
     {
-      double s;
-      if (!(parseDouble(s, argv[argPos++]) && s > 0))
-        ABORT("Invalid em size argument. Use -size <em size> with a positive real number.");
-      config.emSize = s;
+      std::vector<std::string> values;
+      splitList(values, argv[argPos++]);
+      emSizes.clear();
+      for (const std::string &value : values) {
+        double s;
+        if (!(parseDouble(s, value.c_str()) && s > 0))
+          ABORT("Invalid em size argument. Use -size <em size> with a positive real number or a list of them.");
+        if (std::find(emSizes.begin(), emSizes.end(), s) == emSizes.end()) emSizes.push_back(s);
+      }
       continue;
     }
     ARG_CASE("-minsize", 1)
@@ -638,7 +1062,7 @@ int main(int argc, const char *const *argv)
         ec.mode = msdfgen::ErrorCorrectionConfig::EDGE_ONLY;
         ec.distanceCheckMode = msdfgen::ErrorCorrectionConfig::ALWAYS_CHECK_DISTANCE;
       } else if (ARG_IS("help")) {
-        puts(errorCorrectionHelpText);
+        printMessage(stdout, "%s\n", errorCorrectionHelpText);
         return 0;
       } else
         ABORT("Unknown error correction mode. Use -errorcorrection help for more information.");
@@ -671,7 +1095,7 @@ int main(int argc, const char *const *argv)
       else if (ARG_IS("distance"))
         config.edgeColoring = &msdfgen::edgeColoringByDistance, config.expensiveColoring = true;
       else
-        fputs("Unknown coloring strategy specified.\n", stderr);
+        printMessage(stderr, "Unknown coloring strategy specified.\n");
       ++argPos;
       continue;
     }
@@ -693,6 +1117,12 @@ int main(int argc, const char *const *argv)
       config.kerning = true;
       continue;
     }
+    ARG_CASE("-gposkerning", 0)
+    {
+      config.kerning = true;
+      config.gposKerning = true;
+      continue;
+    }
     ARG_CASE("-nopreprocess", 0)
     {
       config.preprocessGeometry = false;
@@ -739,34 +1169,39 @@ int main(int argc, const char *const *argv)
     }
     ARG_CASE("-version", 0)
     {
-      puts(versionText);
+      printMessage(stdout, "%s\n", versionText);
       return 0;
     }
     ARG_CASE("-help", 0)
     {
-      puts(helpText);
+      printMessage(stdout, "%s\n", helpText);
       return 0;
     }
-    fprintf(stderr, "Unknown setting or insufficient parameters: %s\n", argv[argPos++]);
+    printMessage(stderr, "Unknown setting or insufficient parameters: %s\n", argv[argPos++]);
     suggestHelp = true;
   }
-  if (suggestHelp) fputs("Use -help for more information.\n", stderr);
+  if (suggestHelp) printMessage(stderr, "Use -help for more information.\n");
 
   // Nothing to do?
   if (argc == 1) {
-    fputs(
+    printMessage(stderr,
       "Usage: msdf-atlas-gen"
 #ifdef _WIN32
       ".exe"
 #endif
       " -font <filename.ttf/otf> -charset <charset> <output specification> <options>\n"
-      "Use -help for more information.\n",
-      stderr);
+      "Use -help for more information.\n");
     return 0;
   }
-  if (!fontInput.fontFilename) ABORT("No font specified.");
-  if (!(config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename)) {
-    fputs("No output specified.\n", stderr);
+  if (geometryFilename) {
+    if (fontInput.fontFilename || !fontInputs.empty())
+      ABORT("The -geometry option cannot be combined with font inputs.");
+  } else if (!fontInput.fontFilename)
+    ABORT("No font specified.");
+  bool anyOutput = config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename
+                   || config.shadronPreviewFilename;
+  if (!(anyOutput || geometryOutputFilename)) {
+    printMessage(stderr, "No output specified.\n");
     return 0;
   }
   bool layoutOnly = !(config.imageFilename);
@@ -787,22 +1222,36 @@ int main(int argc, const char *const *argv)
   // Fix up configuration based on related values
   if (packingStyle == PackingStyle::TIGHT && atlasSizeConstraint == DimensionsConstraint::NONE)
     atlasSizeConstraint = DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
-  if (!(config.imageType == ImageType::PSDF || config.imageType == ImageType::MSDF
-        || config.imageType == ImageType::MTSDF))
-    config.miterLimit = 0;
-  if (config.emSize > minEmSize) minEmSize = config.emSize;
-  if (!(fixedWidth > 0 && fixedHeight > 0) && !(fixedCellWidth > 0 && fixedCellHeight > 0) && !(minEmSize > 0)) {
-    fputs("Neither atlas size nor glyph size selected, using default...\n", stderr);
+  if (!(fixedWidth > 0 && fixedHeight > 0) && !(fixedCellWidth > 0 && fixedCellHeight > 0) && !(minEmSize > 0)
+      && emSizes.empty()) {
+    printMessage(stderr, "Neither atlas size nor glyph size selected, using default...\n");
     minEmSize = MSDFLIB_DEFAULT_EM_SIZE;
   }
-  if (config.imageType == ImageType::HARD_MASK || config.imageType == ImageType::SOFT_MASK) {
-    rangeMode = RANGE_PIXEL;
-    rangeValue = 1;
-  } else if (rangeValue <= 0) {
+  if (rangeValue <= 0) {
     rangeMode = RANGE_PIXEL;
     rangeValue = DEFAULT_PIXEL_RANGE;
   }
-  if (config.kerning && !(config.jsonFilename || config.shadronPreviewFilename)) config.kerning = false;
+  {
+    // Outputs of multiple atlas types or sizes must go into distinct files
+    const char *outputFilenames[] = { config.imageFilename,
+      config.jsonFilename,
+      config.csvFilename,
+      config.binaryLayoutFilename,
+      config.shadronPreviewFilename };
+    for (const char *filename : outputFilenames) {
+      if (filename && imageTypes.size() > 1 && !strstr(filename, "{type}"))
+        ABORT("Output filenames must contain {type} when multiple atlas types are selected.");
+      if (filename && emSizes.size() > 1 && !strstr(filename, "{size}"))
+        ABORT("Output filenames must contain {size} when multiple glyph sizes are selected.");
+    }
+  }
+  bool edgeColoringNeeded =
+    std::find(imageTypes.begin(), imageTypes.end(), ImageType::MSDF) != imageTypes.end()
+    || std::find(imageTypes.begin(), imageTypes.end(), ImageType::MTSDF) != imageTypes.end();
+  if (config.kerning
+      && !(config.jsonFilename || config.binaryLayoutFilename || config.shadronPreviewFilename
+           || geometryOutputFilename))
+    config.kerning = false;
   if (config.threadCount <= 0) config.threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
   if (config.generatorAttributes.scanlinePass) {
     if (explicitErrorCorrectionMode
@@ -823,7 +1272,7 @@ int main(int argc, const char *const *argv)
         fallbackModeName = "edge-fast";
         break;
       }
-      fprintf(stderr,
+      printMessage(stderr,
         "Selected error correction mode not compatible with scanline mode, falling back to %s.\n",
         fallbackModeName);
     }
@@ -849,7 +1298,8 @@ int main(int argc, const char *const *argv)
     config.imageFormat = ImageFormat::PNG;
     imageFormatName = "png";
   }
-  if (config.imageType == ImageType::MTSDF && config.imageFormat == ImageFormat::BMP)
+  if (std::find(imageTypes.begin(), imageTypes.end(), ImageType::MTSDF) != imageTypes.end()
+      && config.imageFormat == ImageFormat::BMP)
     ABORT("Atlas type not compatible with image format. MTSDF requires a format with alpha channel.");
   if (imageExtension != ImageFormat::UNSPECIFIED) {
     // Warn if image format mismatches -imageout extension
@@ -868,32 +1318,53 @@ int main(int argc, const char *const *argv)
       mismatch = imageExtension != config.imageFormat;
     }
     if (mismatch)
-      fprintf(stderr,
+      printMessage(stderr,
         "Warning: Output image file extension does not match the image's actual format (%s)!\n",
         imageFormatName);
   }
   imageFormatName = nullptr;// No longer consistent with imageFormat
+  if (config.mappedImage) {
+    if (config.streaming) ABORT("The -streaming and -mmap options cannot be combined.");
+#ifdef __BIG_ENDIAN__
+    if (!(config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT_BE))
+      ABORT("Memory-mapped image output requires the bin or binfloatbe image format.");
+#else
+    if (!(config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT))
+      ABORT("Memory-mapped image output requires the bin or binfloat image format.");
+#endif
+  }
+  if (config.bitmapCacheDirectory && config.streaming)
+    printMessage(stderr, "Warning: The glyph bitmap cache is not supported in streaming mode and will be ignored.\n");
   bool floatingPointFormat =
     (config.imageFormat == ImageFormat::TIFF || config.imageFormat == ImageFormat::TEXT_FLOAT
       || config.imageFormat == ImageFormat::BINARY_FLOAT || config.imageFormat == ImageFormat::BINARY_FLOAT_BE);
-  // TODO: In this case (if spacing is -1), the border pixels of each glyph are black, but still computed. For
-  // floating-point output, this may play a role.
-  int spacing = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF ? 0 : -1;
-  double uniformOriginX, uniformOriginY;
 
   // Load fonts
   std::vector<GlyphGeometry> glyphs;
   std::vector<FontGeometry> fonts;
   bool anyCodepointsAvailable = false;
-  {
+  bool edgesColored = false;
+  if (geometryFilename) {
+    if (!loadGeometry(fonts, glyphs, edgesColored, geometryFilename))
+      ABORT("Failed to load the specified geometry file.");
+    for (const FontGeometry &fontGeometry : fonts)
+      anyCodepointsAvailable |= fontGeometry.getPreferredIdentifierType() == GlyphIdentifierType::UNICODE_CODEPOINT
+                                && !fontGeometry.getGlyphs().empty();
+    printMessage(stdout, "Loaded geometry of %d glyphs from \"%s\".\n", (int)glyphs.size(), geometryFilename);
+  } else {
     class FontHolder
     {
       msdfgen::FreetypeHandle *ft;
       msdfgen::FontHandle *font;
       const char *fontFilename;
+      FontDataCache &fontDataCache;
+      const std::vector<byte> *fontData;
 
     public:
-      FontHolder() : ft(msdfgen::initializeFreetype()), font(nullptr), fontFilename(nullptr) {}
+      explicit FontHolder(FontDataCache &fontDataCache)
+        : ft(msdfgen::initializeFreetype()), font(nullptr), fontFilename(nullptr), fontDataCache(fontDataCache),
+          fontData(nullptr)
+      {}
       ~FontHolder()
       {
         if (ft) {
@@ -905,8 +1376,13 @@ int main(int argc, const char *const *argv)
       {
         if (ft && fontFilename) {
           if (this->fontFilename && !strcmp(this->fontFilename, fontFilename)) return true;
-          if (font) msdfgen::destroyFont(font);
-          if ((font = (msdfgen::loadFont(ft, fontFilename)))) {
+          if (font) {
+            msdfgen::destroyFont(font);
+            font = nullptr;
+          }
+          // The file is kept in memory so that glyphs can be loaded in parallel from separate font handles
+          if ((fontData = fontDataCache.get(fontFilename))
+              && (font = msdfgen::loadFontData(ft, fontData->data(), (int)fontData->size()))) {
             this->fontFilename = fontFilename;
             return true;
           }
@@ -915,7 +1391,9 @@ int main(int argc, const char *const *argv)
         return false;
       }
       operator msdfgen::FontHandle *() const { return font; }
-    } font;
+      const byte *data() const { return fontData->data(); }
+      int dataLength() const { return (int)fontData->size(); }
+    } font(fontDataCache);
 
     for (FontInput &fontInput : fontInputs) {
       if (!font.load(fontInput.fontFilename)) ABORT("Failed to load specified font file.");
@@ -938,28 +1416,50 @@ int main(int argc, const char *const *argv)
       // Load glyphs
       FontGeometry fontGeometry(&glyphs);
       int glyphsLoaded = -1;
+      // GPOS kerning is loaded separately below
+      bool loadKerning = config.kerning && !config.gposKerning;
       switch (fontInput.glyphIdentifierType) {
       case GlyphIdentifierType::GLYPH_INDEX:
         if (allGlyphCount)
-          glyphsLoaded = fontGeometry.loadGlyphRange(
-            font, fontInput.fontScale, 0, allGlyphCount, config.preprocessGeometry, config.kerning);
+          glyphsLoaded = fontGeometry.loadGlyphRange(font.data(),
+            font.dataLength(),
+            fontInput.fontScale,
+            0,
+            allGlyphCount,
+            config.threadCount,
+            config.preprocessGeometry,
+            loadKerning);
         else
-          glyphsLoaded =
-            fontGeometry.loadGlyphset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+          glyphsLoaded = fontGeometry.loadGlyphset(font.data(),
+            font.dataLength(),
+            fontInput.fontScale,
+            charset,
+            config.threadCount,
+            config.preprocessGeometry,
+            loadKerning);
         break;
       case GlyphIdentifierType::UNICODE_CODEPOINT:
-        glyphsLoaded =
-          fontGeometry.loadCharset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+        glyphsLoaded = fontGeometry.loadCharset(font.data(),
+          font.dataLength(),
+          fontInput.fontScale,
+          charset,
+          config.threadCount,
+          config.preprocessGeometry,
+          loadKerning);
         anyCodepointsAvailable |= glyphsLoaded > 0;
         break;
       }
+      if (config.kerning && config.gposKerning && glyphsLoaded >= 0) fontGeometry.loadKerning(font, true);
       if (glyphsLoaded < 0) ABORT("Failed to load glyphs from font.");
-      printf("Loaded geometry of %d out of %d glyphs", glyphsLoaded, (int)(allGlyphCount + charset.size()));
-      if (fontInputs.size() > 1) printf(" from font \"%s\"", fontInput.fontFilename);
-      printf(".\n");
+      std::string message;
+      appendFormatted(
+        message, "Loaded geometry of %d out of %d glyphs", glyphsLoaded, (int)(allGlyphCount + charset.size()));
+      if (fontInputs.size() > 1) appendFormatted(message, " from font \"%s\"", fontInput.fontFilename);
+      printMessage(stdout, "%s.\n", message.c_str());
       // List missing glyphs
+      message.clear();
       if (glyphsLoaded < (int)charset.size()) {
-        fprintf(stderr,
+        appendFormatted(message,
           "Missing %d %s",
           (int)charset.size() - glyphsLoaded,
           fontInput.glyphIdentifierType == GlyphIdentifierType::UNICODE_CODEPOINT ? "codepoints" : "glyphs");
@@ -968,22 +1468,22 @@ int main(int argc, const char *const *argv)
         case GlyphIdentifierType::GLYPH_INDEX:
           for (unicode_t cp : charset)
             if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(cp)))
-              fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
+              appendFormatted(message, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
           break;
         case GlyphIdentifierType::UNICODE_CODEPOINT:
           for (unicode_t cp : charset)
-            if (!fontGeometry.getGlyph(cp)) fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
+            if (!fontGeometry.getGlyph(cp))
+              appendFormatted(message, "%c 0x%02X", first ? ((first = false), ':') : ',', cp);
           break;
         }
-        fprintf(stderr, "\n");
       } else if (glyphsLoaded < (int)allGlyphCount) {
-        fprintf(stderr, "Missing %d glyphs", (int)allGlyphCount - glyphsLoaded);
+        appendFormatted(message, "Missing %d glyphs", (int)allGlyphCount - glyphsLoaded);
         bool first = true;
         for (unsigned i = 0; i < allGlyphCount; ++i)
           if (!fontGeometry.getGlyph(msdfgen::GlyphIndex(i)))
-            fprintf(stderr, "%c 0x%02X", first ? ((first = false), ':') : ',', i);
-        fprintf(stderr, "\n");
+            appendFormatted(message, "%c 0x%02X", first ? ((first = false), ':') : ',', i);
       }
+      if (!message.empty()) printMessage(stderr, "%s\n", message.c_str());
 
       if (fontInput.fontName) fontGeometry.setName(fontInput.fontName);
 
@@ -991,20 +1491,48 @@ int main(int argc, const char *const *argv)
     }
   }
   if (glyphs.empty()) ABORT("No glyphs loaded.");
+  // Glyph and kerning lookups only follow from here on
+  for (FontGeometry &font : fonts) font.freeze();
 
-  // Determine final atlas dimensions, scale and range, pack glyphs
-  {
-    double unitRange = 0, pxRange = 0;
-    switch (rangeMode) {
-    case RANGE_EM:
-      unitRange = rangeValue;
-      break;
-    case RANGE_PIXEL:
-      pxRange = rangeValue;
-      break;
+  // Save prepared geometry
+  if (geometryOutputFilename) {
+    if (edgeColoringNeeded && !edgesColored) {
+      colorEdges(glyphs, config);
+      edgesColored = true;
     }
+    if (saveGeometry(fonts.data(), fonts.size(), edgesColored, geometryOutputFilename))
+      printMessage(stderr, "Geometry file saved.\n");
+    else {
+      printMessage(stderr, "Failed to save the geometry file.\n");
+      result = 1;
+    }
+    if (!anyOutput) return result;
+  }
+
+  auto layoutSettings = [&](ImageType imageType) -> LayoutSettings {
+    LayoutSettings layout = {};
+    // TODO: In this case (if spacing is -1), the border pixels of each glyph are black, but still computed. For
+    // floating-point output, this may play a role.
+    layout.spacing = imageType == ImageType::MSDF || imageType == ImageType::MTSDF ? 0 : -1;
+    if (imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF)
+      layout.miterLimit = config.miterLimit;
+    if (imageType == ImageType::HARD_MASK || imageType == ImageType::SOFT_MASK)
+      layout.pxRange = 1;
+    else if (rangeMode == RANGE_EM)
+      layout.unitRange = rangeValue;
+    else
+      layout.pxRange = rangeValue;
+    return layout;
+  };
+
+  // Determines final atlas dimensions, scale and range, packs glyphs
+  auto packGlyphs = [&](Configuration &layoutConfig,
+                      const LayoutSettings &layout,
+                      double &uniformOriginX,
+                      double &uniformOriginY) -> int {
+    double unitRange = layout.unitRange, pxRange = layout.pxRange;
     bool fixedDimensions = fixedWidth >= 0 && fixedHeight >= 0;
-    bool fixedScale = config.emSize > 0;
+    bool fixedScale = layoutConfig.emSize > 0;
     switch (packingStyle) {
 
     case PackingStyle::TIGHT: {
@@ -1013,217 +1541,474 @@ int main(int argc, const char *const *argv)
         atlasPacker.setDimensions(fixedWidth, fixedHeight);
       else
         atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
-      atlasPacker.setSpacing(spacing);
+      if (maxPageWidth > 0 && maxPageHeight > 0) atlasPacker.setMaximumPageDimensions(maxPageWidth, maxPageHeight);
+      atlasPacker.setPackingAlgorithm(packingAlgorithm);
+      atlasPacker.setRotationAllowed(layoutConfig.allowRotation);
+      atlasPacker.setDeduplication(deduplication);
+      atlasPacker.setSpacing(layout.spacing);
       if (fixedScale)
-        atlasPacker.setScale(config.emSize);
+        atlasPacker.setScale(layoutConfig.emSize);
       else
         atlasPacker.setMinimumScale(minEmSize);
       atlasPacker.setPixelRange(pxRange);
       atlasPacker.setUnitRange(unitRange);
-      atlasPacker.setMiterLimit(config.miterLimit);
-      atlasPacker.setOriginPixelAlignment(config.pxAlignOriginX, config.pxAlignOriginY);
+      atlasPacker.setMiterLimit(layoutConfig.miterLimit);
+      atlasPacker.setOriginPixelAlignment(layoutConfig.pxAlignOriginX, layoutConfig.pxAlignOriginY);
+      atlasPacker.setThreadCount(layoutConfig.threadCount);
       if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
         if (remaining < 0) {
           ABORT("Failed to pack glyphs into atlas.");
         } else {
-          fprintf(stderr, "Error: Could not fit %d out of %d glyphs into the atlas.\n", remaining, (int)glyphs.size());
+          printMessage(
+            stderr, "Error: Could not fit %d out of %d glyphs into the atlas.\n", remaining, (int)glyphs.size());
           return 1;
         }
       }
-      atlasPacker.getDimensions(config.width, config.height);
-      if (!(config.width > 0 && config.height > 0)) ABORT("Unable to determine atlas size.");
-      config.emSize = atlasPacker.getScale();
-      config.pxRange = atlasPacker.getPixelRange();
-      if (!fixedScale) printf("Glyph size: %.9g pixels/em\n", config.emSize);
-      if (!fixedDimensions) printf("Atlas dimensions: %d x %d\n", config.width, config.height);
+      atlasPacker.getDimensions(layoutConfig.width, layoutConfig.height);
+      if (!(layoutConfig.width > 0 && layoutConfig.height > 0)) ABORT("Unable to determine atlas size.");
+      layoutConfig.pageCount = atlasPacker.getPageCount();
+      layoutConfig.emSize = atlasPacker.getScale();
+      layoutConfig.pxRange = atlasPacker.getPixelRange();
+      if (!fixedScale) printMessage(stdout, "Glyph size: %.9g pixels/em\n", layoutConfig.emSize);
+      if (layoutConfig.pageCount > 1)
+        printMessage(stdout,
+          "Atlas dimensions: %d x %d x %d pages\n",
+          layoutConfig.width,
+          layoutConfig.height,
+          layoutConfig.pageCount);
+      else if (!fixedDimensions)
+        printMessage(stdout, "Atlas dimensions: %d x %d\n", layoutConfig.width, layoutConfig.height);
       break;
     }
 
     case PackingStyle::GRID: {
       GridAtlasPacker atlasPacker;
-      atlasPacker.setFixedOrigin(config.grid.fixedOriginX, config.grid.fixedOriginY);
+      atlasPacker.setFixedOrigin(layoutConfig.grid.fixedOriginX, layoutConfig.grid.fixedOriginY);
       if (fixedCellWidth >= 0 && fixedCellHeight >= 0)
         atlasPacker.setCellDimensions(fixedCellWidth, fixedCellHeight);
       else
         atlasPacker.setCellDimensionsConstraint(cellSizeConstraint);
-      if (config.grid.cols > 0) atlasPacker.setColumns(config.grid.cols);
+      if (layoutConfig.grid.cols > 0) atlasPacker.setColumns(layoutConfig.grid.cols);
       if (fixedDimensions)
         atlasPacker.setDimensions(fixedWidth, fixedHeight);
       else
         atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
-      atlasPacker.setSpacing(spacing);
+      atlasPacker.setSpacing(layout.spacing);
       if (fixedScale)
-        atlasPacker.setScale(config.emSize);
+        atlasPacker.setScale(layoutConfig.emSize);
       else
         atlasPacker.setMinimumScale(minEmSize);
       atlasPacker.setPixelRange(pxRange);
       atlasPacker.setUnitRange(unitRange);
-      atlasPacker.setMiterLimit(config.miterLimit);
-      atlasPacker.setOriginPixelAlignment(config.pxAlignOriginX, config.pxAlignOriginY);
+      atlasPacker.setMiterLimit(layoutConfig.miterLimit);
+      atlasPacker.setOriginPixelAlignment(layoutConfig.pxAlignOriginX, layoutConfig.pxAlignOriginY);
+      atlasPacker.setDeduplication(deduplication);
+      atlasPacker.setThreadCount(layoutConfig.threadCount);
       if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
         if (remaining < 0) {
           ABORT("Failed to pack glyphs into atlas.");
         } else {
-          fprintf(stderr, "Error: Could not fit %d out of %d glyphs into the atlas.\n", remaining, (int)glyphs.size());
+          printMessage(
+            stderr, "Error: Could not fit %d out of %d glyphs into the atlas.\n", remaining, (int)glyphs.size());
           return 1;
         }
       }
+      layoutConfig.pageCount = 1;
+      if (maxPageWidth > 0 && maxPageHeight > 0)
+        printMessage(
+          stderr, "Warning: Maximum atlas dimensions are not supported in uniform grid mode and will be ignored.\n");
+      if (layoutConfig.allowRotation) {
+        printMessage(stderr, "Warning: Glyph rotation is not supported in uniform grid mode and will be ignored.\n");
+        layoutConfig.allowRotation = false;
+      }
       if (atlasPacker.hasCutoff())
-        fputs("Warning: Grid cell too constrained to fully fit all glyphs, some may be cut off!\n", stderr);
-      atlasPacker.getDimensions(config.width, config.height);
-      if (!(config.width > 0 && config.height > 0)) ABORT("Unable to determine atlas size.");
-      config.emSize = atlasPacker.getScale();
-      config.pxRange = atlasPacker.getPixelRange();
-      atlasPacker.getCellDimensions(config.grid.cellWidth, config.grid.cellHeight);
-      config.grid.cols = atlasPacker.getColumns();
-      config.grid.rows = atlasPacker.getRows();
-      if (!fixedScale) printf("Glyph size: %.9g pixels/em\n", config.emSize);
-      if (config.grid.fixedOriginX || config.grid.fixedOriginY) {
+        printMessage(stderr, "Warning: Grid cell too constrained to fully fit all glyphs, some may be cut off!\n");
+      atlasPacker.getDimensions(layoutConfig.width, layoutConfig.height);
+      if (!(layoutConfig.width > 0 && layoutConfig.height > 0)) ABORT("Unable to determine atlas size.");
+      layoutConfig.emSize = atlasPacker.getScale();
+      layoutConfig.pxRange = atlasPacker.getPixelRange();
+      atlasPacker.getCellDimensions(layoutConfig.grid.cellWidth, layoutConfig.grid.cellHeight);
+      layoutConfig.grid.cols = atlasPacker.getColumns();
+      layoutConfig.grid.rows = atlasPacker.getRows();
+      if (!fixedScale) printMessage(stdout, "Glyph size: %.9g pixels/em\n", layoutConfig.emSize);
+      if (layoutConfig.grid.fixedOriginX || layoutConfig.grid.fixedOriginY) {
         atlasPacker.getFixedOrigin(uniformOriginX, uniformOriginY);
-        printf("Grid cell origin: ");
-        if (config.grid.fixedOriginX) printf("X = %.9g", uniformOriginX);
-        if (config.grid.fixedOriginX && config.grid.fixedOriginY) printf(", ");
-        if (config.grid.fixedOriginY) {
-          switch (config.yDirection) {
+        std::string message = "Grid cell origin: ";
+        if (layoutConfig.grid.fixedOriginX) appendFormatted(message, "X = %.9g", uniformOriginX);
+        if (layoutConfig.grid.fixedOriginX && layoutConfig.grid.fixedOriginY) message += ", ";
+        if (layoutConfig.grid.fixedOriginY) {
+          switch (layoutConfig.yDirection) {
           case YDirection::BOTTOM_UP:
-            printf("Y = %.9g", uniformOriginY);
+            appendFormatted(message, "Y = %.9g", uniformOriginY);
             break;
           case YDirection::TOP_DOWN:
-            printf("Y = %.9g", (config.grid.cellHeight - spacing - 1) / config.emSize - uniformOriginY);
+            appendFormatted(message,
+              "Y = %.9g",
+              (layoutConfig.grid.cellHeight - layout.spacing - 1) / layoutConfig.emSize - uniformOriginY);
             break;
           }
         }
-        printf("\n");
+        printMessage(stdout, "%s\n", message.c_str());
       }
-      printf("Grid cell dimensions: %d x %d\n", config.grid.cellWidth, config.grid.cellHeight);
-      printf("Atlas dimensions: %d x %d (%d columns x %d rows)\n",
-        config.width,
-        config.height,
-        config.grid.cols,
-        config.grid.rows);
+      printMessage(
+        stdout, "Grid cell dimensions: %d x %d\n", layoutConfig.grid.cellWidth, layoutConfig.grid.cellHeight);
+      printMessage(stdout,
+        "Atlas dimensions: %d x %d (%d columns x %d rows)\n",
+        layoutConfig.width,
+        layoutConfig.height,
+        layoutConfig.grid.cols,
+        layoutConfig.grid.rows);
       break;
     }
     }
-  }
+    return 0;
+  };
+
+  // Writes the layout outputs of an atlas
+  auto writeOutputs = [&](const Configuration &atlasConfig,
+                        const LayoutSettings &layout,
+                        double uniformOriginX,
+                        double uniformOriginY) {
+    if (atlasConfig.csvFilename) {
+      if (exportCSV(fonts.data(),
+            fonts.size(),
+            atlasConfig.width,
+            atlasConfig.height,
+            atlasConfig.yDirection,
+            atlasConfig.csvFilename,
+            atlasConfig.pageCount,
+            atlasConfig.allowRotation,
+            atlasConfig.threadCount))
+        printMessage(stderr, "Glyph layout written into CSV file.\n");
+      else {
+        result = 1;
+        printMessage(stderr, "Failed to write CSV output file.\n");
+      }
+    }
+
+    if (atlasConfig.jsonFilename || atlasConfig.binaryLayoutFilename) {
+      JsonAtlasMetrics jsonMetrics = {};
+      JsonAtlasMetrics::GridMetrics gridMetrics = {};
+      jsonMetrics.distanceRange = atlasConfig.pxRange;
+      jsonMetrics.size = atlasConfig.emSize;
+      jsonMetrics.width = atlasConfig.width, jsonMetrics.height = atlasConfig.height;
+      jsonMetrics.pageCount = atlasConfig.pageCount;
+      jsonMetrics.yDirection = atlasConfig.yDirection;
+      if (packingStyle == PackingStyle::GRID) {
+        gridMetrics.cellWidth = atlasConfig.grid.cellWidth, gridMetrics.cellHeight = atlasConfig.grid.cellHeight;
+        gridMetrics.columns = atlasConfig.grid.cols, gridMetrics.rows = atlasConfig.grid.rows;
+        if (atlasConfig.grid.fixedOriginX) gridMetrics.originX = &uniformOriginX;
+        if (atlasConfig.grid.fixedOriginY) gridMetrics.originY = &uniformOriginY;
+        gridMetrics.spacing = layout.spacing;
+        jsonMetrics.grid = &gridMetrics;
+      }
+      if (atlasConfig.jsonFilename) {
+        if (exportJSON(fonts.data(),
+              fonts.size(),
+              atlasConfig.imageType,
+              jsonMetrics,
+              atlasConfig.jsonFilename,
+              atlasConfig.kerning,
+              atlasConfig.threadCount))
+          printMessage(stderr, "Glyph layout and metadata written into JSON file.\n");
+        else {
+          result = 1;
+          printMessage(stderr, "Failed to write JSON output file.\n");
+        }
+      }
+      if (atlasConfig.binaryLayoutFilename) {
+        if (exportBinaryLayout(fonts.data(),
+              fonts.size(),
+              atlasConfig.imageType,
+              jsonMetrics,
+              atlasConfig.binaryLayoutFilename,
+              atlasConfig.kerning))
+          printMessage(stderr, "Glyph layout and metadata written into binary layout file.\n");
+        else {
+          result = 1;
+          printMessage(stderr, "Failed to write binary layout output file.\n");
+        }
+      }
+    }
+
+    if (atlasConfig.shadronPreviewFilename && atlasConfig.shadronPreviewText) {
+      if (atlasConfig.pageCount > 1) {
+        result = 1;
+        printMessage(stderr, "Shadron preview not supported for multi-page atlases.\n");
+      } else if (anyCodepointsAvailable) {
+        std::vector<unicode_t> previewText;
+        utf8Decode(previewText, atlasConfig.shadronPreviewText);
+        previewText.push_back(0);
+        if (generateShadronPreview(fonts.data(),
+              fonts.size(),
+              atlasConfig.imageType,
+              atlasConfig.width,
+              atlasConfig.height,
+              atlasConfig.pxRange,
+              previewText.data(),
+              atlasConfig.imageFilename,
+              floatingPointFormat,
+              atlasConfig.shadronPreviewFilename))
+          printMessage(stderr, "Shadron preview script generated.\n");
+        else {
+          result = 1;
+          printMessage(stderr, "Failed to generate Shadron preview file.\n");
+        }
+      } else {
+        result = 1;
+        printMessage(stderr, "Shadron preview not supported in -glyphset mode.\n");
+      }
+    }
+  };
 
-  // Generate atlas bitmap
-  if (!layoutOnly) {
+  // Glyphs are packed once for each glyph size and group of atlas types with the same glyph layout, after which the
+  // atlases of the group are generated in parallel. Loaded fonts and edge coloring are shared by all of them
+  if (emSizes.empty()) emSizes.push_back(0);
+  for (double emSize : emSizes) {
+    std::vector<ImageType> remainingTypes = imageTypes;
+    while (!remainingTypes.empty()) {
+      LayoutSettings layout = layoutSettings(remainingTypes.front());
+      std::vector<ImageType> groupTypes;
+      for (std::vector<ImageType>::iterator it = remainingTypes.begin(); it != remainingTypes.end();) {
+        if (layoutSettings(*it) == layout) {
+          groupTypes.push_back(*it);
+          it = remainingTypes.erase(it);
+        } else
+          ++it;
+      }
+      Configuration layoutConfig = config;
+      layoutConfig.emSize = emSize;
+      layoutConfig.miterLimit = layout.miterLimit;
+      double uniformOriginX = 0, uniformOriginY = 0;
+      if (int packResult = packGlyphs(layoutConfig, layout, uniformOriginX, uniformOriginY)) return packResult;
 
-    // Edge coloring
-    if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) {
-      if (config.expensiveColoring) {
+      struct AtlasVariant
+      {
+        Configuration config;
+        std::string imageFilename, jsonFilename, csvFilename, binaryLayoutFilename, shadronPreviewFilename;
+      };
+      std::vector<AtlasVariant> variants(groupTypes.size());
+      for (size_t i = 0; i < variants.size(); ++i) {
+        Configuration &variantConfig = variants[i].config;
+        variantConfig = layoutConfig;
+        variantConfig.imageType = groupTypes[i];
+        auto substitute = [&variantConfig](const char *&filename, std::string &storage) {
+          if (filename) {
+            storage = outputFilename(filename, variantConfig.imageType, variantConfig.emSize);
+            filename = storage.c_str();
+          }
+        };
+        substitute(variantConfig.imageFilename, variants[i].imageFilename);
+        substitute(variantConfig.jsonFilename, variants[i].jsonFilename);
+        substitute(variantConfig.csvFilename, variants[i].csvFilename);
+        substitute(variantConfig.binaryLayoutFilename, variants[i].binaryLayoutFilename);
+        substitute(variantConfig.shadronPreviewFilename, variants[i].shadronPreviewFilename);
+      }
+
+      // Generate atlas bitmaps
+      if (!layoutOnly) {
+        // Edge coloring
+        if (!edgesColored
+            && (std::find(groupTypes.begin(), groupTypes.end(), ImageType::MSDF) != groupTypes.end()
+                || std::find(groupTypes.begin(), groupTypes.end(), ImageType::MTSDF) != groupTypes.end())) {
+          colorEdges(glyphs, config);
+          edgesColored = true;
+        }
+
+        std::vector<byte> generated(variants.size());
         Workload(
-          [&glyphs, &config](int i, int threadNo) -> bool {
-            unsigned long long glyphSeed =
-              (LCG_MULTIPLIER * (config.coloringSeed ^ i) + LCG_INCREMENT) * !!config.coloringSeed;
-            glyphs[i].edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
+          [&](int i, int threadNo) -> bool {
+            generated[i] = generateAtlas(glyphs, fonts, variants[i].config, floatingPointFormat);
             return true;
           },
-          glyphs.size())
-          .finish(config.threadCount);
-      } else {
-        unsigned long long glyphSeed = config.coloringSeed;
-        for (GlyphGeometry &glyph : glyphs) {
-          glyphSeed *= LCG_MULTIPLIER;
-          glyph.edgeColoring(config.edgeColoring, config.angleThreshold, glyphSeed);
-        }
+          (int)variants.size())
+          .finish((int)variants.size());
+        if (std::find(generated.begin(), generated.end(), byte(0)) != generated.end()) result = 1;
       }
-    }
 
-    bool success = false;
-    switch (config.imageType) {
-    case ImageType::HARD_MASK:
-      if (floatingPointFormat)
-        success = makeAtlas<float, float, 1, scanlineGenerator>(glyphs, fonts, config);
-      else
-        success = makeAtlas<byte, float, 1, scanlineGenerator>(glyphs, fonts, config);
-      break;
-    case ImageType::SOFT_MASK:
-    case ImageType::SDF:
-      if (floatingPointFormat)
-        success = makeAtlas<float, float, 1, sdfGenerator>(glyphs, fonts, config);
-      else
-        success = makeAtlas<byte, float, 1, sdfGenerator>(glyphs, fonts, config);
-      break;
-    case ImageType::PSDF:
-      if (floatingPointFormat)
-        success = makeAtlas<float, float, 1, psdfGenerator>(glyphs, fonts, config);
-      else
-        success = makeAtlas<byte, float, 1, psdfGenerator>(glyphs, fonts, config);
-      break;
-    case ImageType::MSDF:
-      if (floatingPointFormat)
-        success = makeAtlas<float, float, 3, msdfGenerator>(glyphs, fonts, config);
-      else
-        success = makeAtlas<byte, float, 3, msdfGenerator>(glyphs, fonts, config);
-      break;
-    case ImageType::MTSDF:
-      if (floatingPointFormat)
-        success = makeAtlas<float, float, 4, mtsdfGenerator>(glyphs, fonts, config);
-      else
-        success = makeAtlas<byte, float, 4, mtsdfGenerator>(glyphs, fonts, config);
-      break;
+      for (const AtlasVariant &variant : variants)
+        writeOutputs(variant.config, layout, uniformOriginX, uniformOriginY);
     }
-    if (!success) result = 1;
   }
 
-  if (config.csvFilename) {
-    if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename))
-      fputs("Glyph layout written into CSV file.\n", stderr);
-    else {
-      result = 1;
-      fputs("Failed to write CSV output file.\n", stderr);
+  return result;
+}
+
+/// Splits a line of a manifest into arguments separated by whitespace, which may be enclosed in double quotes
+static void splitArguments(std::vector<std::string> &args, const char *line, const char *end)
+{
+  while (line < end) {
+    if (*line == ' ' || *line == '\t' || *line == '\r') {
+      ++line;
+      continue;
     }
+    std::string arg;
+    if (*line == '"') {
+      for (++line; line < end && *line != '"'; ++line) arg.push_back(*line);
+      ++line;
+    } else
+      for (; line < end && !(*line == ' ' || *line == '\t' || *line == '\r'); ++line) arg.push_back(*line);
+    args.push_back((std::string &&)arg);
   }
+}
 
-  if (config.jsonFilename) {
-    JsonAtlasMetrics jsonMetrics = {};
-    JsonAtlasMetrics::GridMetrics gridMetrics = {};
-    jsonMetrics.distanceRange = config.pxRange;
-    jsonMetrics.size = config.emSize;
-    jsonMetrics.width = config.width, jsonMetrics.height = config.height;
-    jsonMetrics.yDirection = config.yDirection;
-    if (packingStyle == PackingStyle::GRID) {
-      gridMetrics.cellWidth = config.grid.cellWidth, gridMetrics.cellHeight = config.grid.cellHeight;
-      gridMetrics.columns = config.grid.cols, gridMetrics.rows = config.grid.rows;
-      if (config.grid.fixedOriginX) gridMetrics.originX = &uniformOriginX;
-      if (config.grid.fixedOriginY) gridMetrics.originY = &uniformOriginY;
-      gridMetrics.spacing = spacing;
-      jsonMetrics.grid = &gridMetrics;
-    }
-    if (exportJSON(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.jsonFilename, config.kerning))
-      fputs("Glyph layout and metadata written into JSON file.\n", stderr);
-    else {
-      result = 1;
-      fputs("Failed to write JSON output file.\n", stderr);
+static int runManifest(int argc, const char *const *argv, FontDataCache &fontDataCache)
+{
+  int argPos = 2;
+  if (argPos >= argc) ABORT("No manifest file specified. Use -manifest <filename>.");
+  const char *manifestFilename = argv[argPos++];
+  unsigned concurrentJobs = 2;
+  if (argPos + 1 < argc && (!strcmp(argv[argPos], "-jobs") || !strcmp(argv[argPos], "--jobs"))) {
+    if (!(parseUnsigned(concurrentJobs, argv[argPos + 1]) && concurrentJobs))
+      ABORT("Invalid number of concurrent jobs. Use -jobs <N> with a positive integer.");
+    argPos += 2;
+  }
+  std::vector<byte> manifest;
+  if (!msdfgen::loadFile(manifest, manifestFilename)) ABORT("Failed to read the manifest file.");
+
+  // Each non-empty line that is not a # comment is a job
+  struct Job
+  {
+    int line;
+    std::vector<std::string> args;
+  };
+  std::vector<Job> jobs;
+  const char *cur = (const char *)manifest.data(), *end = cur + manifest.size();
+  for (int line = 1; cur < end; ++line) {
+    const char *lineEnd = std::find(cur, end, '\n');
+    Job job = { line, {} };
+    splitArguments(job.args, cur, lineEnd);
+    if (!job.args.empty() && job.args[0][0] != '#') jobs.push_back((Job &&)job);
+    cur = lineEnd + (lineEnd < end);
+  }
+  if (jobs.empty()) {
+    fputs("No jobs specified in the manifest file.\n", stderr);
+    return 0;
+  }
+
+  // Jobs are started in order, several at a time so that the sequential stages of one overlap the parallel stages
+  // of another. Remaining command line arguments apply to all jobs and can be overridden by their own
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<int> results(jobs.size());
+  Workload(
+    [&](int i, int threadNo) -> bool {
+      std::vector<const char *> jobArgv(argv, argv + 1);
+      jobArgv.insert(jobArgv.end(), argv + argPos, argv + argc);
+      for (const std::string &arg : jobs[i].args) jobArgv.push_back(arg.c_str());
+      // The job's messages are prefixed with its number, since other jobs print theirs at the same time
+      char prefix[32];
+      snprintf(prefix, sizeof(prefix), "Job %d: ", i + 1);
+      messagePrefix = prefix;
+      std::chrono::steady_clock::time_point jobStart = std::chrono::steady_clock::now();
+      results[i] = runJob((int)jobArgv.size(), jobArgv.data(), fontDataCache);
+      messagePrefix = nullptr;
+      std::chrono::duration<double> jobTime = std::chrono::steady_clock::now() - jobStart;
+      fprintf(stderr,
+        "Job %d (line %d) %s in %.3f s.\n",
+        i + 1,
+        jobs[i].line,
+        results[i] ? "failed" : "finished",
+        jobTime.count());
+      return true;
+    },
+    (int)jobs.size())
+    .finish((int)concurrentJobs);
+  std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - start;
+  int failed = (int)std::count_if(results.begin(), results.end(), [](int result) { return result != 0; });
+  fprintf(stderr,
+    "%d of %d jobs finished in %.3f s.\n",
+    (int)jobs.size() - failed,
+    (int)jobs.size(),
+    totalTime.count());
+  return failed ? 1 : 0;
+}
+
+static int runServer(int argc, const char *const *argv)
+{
+  GlyphServer::Settings settings = {};
+  settings.edgeColoring = msdfgen::edgeColoringInkTrap;
+  settings.angleThreshold = DEFAULT_ANGLE_THRESHOLD;
+  settings.miterLimit = DEFAULT_MITER_LIMIT;
+  settings.pxAlignOriginX = false, settings.pxAlignOriginY = true;
+  settings.generatorAttributes.config.overlapSupport = true;
+  settings.generatorAttributes.scanlinePass = true;
+  settings.generatorAttributes.config.errorCorrection.distanceCheckMode =
+    msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
+  std::vector<const char *> fontFilenames;
+
+  int argPos = 2;
+  while (argPos < argc) {
+    const char *arg = argv[argPos];
+    ARG_CASE("-font", 1)
+    {
+      fontFilenames.push_back(argv[argPos++]);
+      continue;
+    }
+    ARG_CASE("-coloringstrategy" ARG_CASE_OR "-edgecoloring", 1)
+    {
+      if (ARG_IS("simple"))
+        settings.edgeColoring = &msdfgen::edgeColoringSimple;
+      else if (ARG_IS("inktrap"))
+        settings.edgeColoring = &msdfgen::edgeColoringInkTrap;
+      else if (ARG_IS("distance"))
+        settings.edgeColoring = &msdfgen::edgeColoringByDistance;
+      else
+        fputs("Unknown coloring strategy specified.\n", stderr);
+      ++argPos;
+      continue;
     }
+    ARG_CASE("-angle", 1)
+    {
+      if (!parseAngle(settings.angleThreshold, argv[argPos++]))
+        ABORT(
+          "Invalid angle threshold. Use -angle <min angle> with a positive real number less than PI or a value in "
+          "degrees followed by 'd' below 180d.");
+      continue;
+    }
+    ARG_CASE("-seed", 1)
+    {
+      if (!parseUnsignedLL(settings.coloringSeed, argv[argPos++]))
+        ABORT("Invalid seed. Use -seed <N> with N being a non-negative integer.");
+      continue;
+    }
+    ARG_CASE("-miterlimit", 1)
+    {
+      if (!(parseDouble(settings.miterLimit, argv[argPos++]) && settings.miterLimit >= 0))
+        ABORT("Invalid miter limit argument. Use -miterlimit <limit> with a positive real number.");
+      continue;
+    }
+    ARG_CASE("-threads", 1)
+    {
+      unsigned tc;
+      if (!(parseUnsigned(tc, argv[argPos++]) && (int)tc >= 0))
+        ABORT("Invalid thread count. Use -threads <N> with N being a non-negative integer.");
+      settings.threadCount = (int)tc;
+      continue;
+    }
+    fprintf(stderr, "Unknown setting or insufficient parameters: %s\n", arg);
+    return 1;
   }
+  if (settings.threadCount <= 0) settings.threadCount = std::max((int)std::thread::hardware_concurrency(), 1);
 
-  if (config.shadronPreviewFilename && config.shadronPreviewText) {
-    if (anyCodepointsAvailable) {
-      std::vector<unicode_t> previewText;
-      utf8Decode(previewText, config.shadronPreviewText);
-      previewText.push_back(0);
-      if (generateShadronPreview(fonts.data(),
-            fonts.size(),
-            config.imageType,
-            config.width,
-            config.height,
-            config.pxRange,
-            previewText.data(),
-            config.imageFilename,
-            floatingPointFormat,
-            config.shadronPreviewFilename))
-        fputs("Shadron preview script generated.\n", stderr);
-      else {
-        result = 1;
-        fputs("Failed to generate Shadron preview file.\n", stderr);
-      }
-    } else {
-      result = 1;
-      fputs("Shadron preview not supported in -glyphset mode.\n", stderr);
+  GlyphServer server(settings);
+  for (const char *fontFilename : fontFilenames) {
+    if (server.loadFont(fontFilename) < 0) {
+      fprintf(stderr, "Failed to load font file %s.\n", fontFilename);
+      return 1;
     }
   }
+#ifdef _WIN32
+  _setmode(_fileno(stdin), _O_BINARY);
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
+  return server.run(stdin, stdout) ? 0 : 1;
+}
 
-  return result;
+int main(int argc, const char *const *argv)
+{
+  FontDataCache fontDataCache;
+  if (argc >= 2 && (!strcmp(argv[1], "-manifest") || !strcmp(argv[1], "--manifest")))
+    return runManifest(argc, argv, fontDataCache);
+  if (argc >= 2 && (!strcmp(argv[1], "-server") || !strcmp(argv[1], "--server"))) return runServer(argc, argv);
+  return runJob(argc, argv, fontDataCache);
 }
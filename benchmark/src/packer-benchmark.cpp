@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "atlas/rectangle-packing.hpp"
+#include "atlas/size-selectors.hpp"
+
+using namespace msdf_atlas;
+
+static const char *const helpText = R"(
+Rectangle packer benchmark - compares RectanglePacker (guillotine) and SkylinePacker
+
+Usage: msdf-packer-benchmark [options]
+
+  -count <n>
+      Number of rectangles, 20000 by default.
+  -seed <n>
+      Seed of the random rectangle dimensions, 1 by default.
+  -packer <guillotine / skyline / all>
+      Selects the packers to measure, all by default.
+
+The rectangles have random glyph-like dimensions (8 to 48 x 10 to 56 pixels). Each packer finds the minimum square
+atlas with SquareSizeSelector, as atlas-gen does for -packer, in a single thread.
+)";
+
+/// Generates the same rectangles for a given seed on every platform
+static std::vector<Rectangle> generateRectangles(size_t count, unsigned seed)
+{
+  std::mt19937 random(seed);
+  std::vector<Rectangle> rectangles(count);
+  for (Rectangle &rect : rectangles) {
+    rect.x = 0, rect.y = 0;
+    rect.w = 8 + (int)(random() % 41);
+    rect.h = 10 + (int)(random() % 47);
+  }
+  return rectangles;
+}
+
+template<class Packer> static void runBenchmark(const char *name, const std::vector<Rectangle> &input)
+{
+  std::vector<Rectangle> rectangles = input;
+  long long totalArea = 0;
+  for (const Rectangle &rect : rectangles) totalArea += (long long)rect.w * rect.h;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::pair<int, int> dimensions =
+    packRectangles<SquareSizeSelector<>, Packer>(rectangles.data(), (int)rectangles.size());
+  std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+  double efficiency =
+    dimensions.first > 0 ? 100. * (double)totalArea / ((double)dimensions.first * dimensions.second) : 0;
+  printf("%-12s %8.3f s  %5d x %-5d  %5.1f%% used\n",
+    name,
+    time.count(),
+    dimensions.first,
+    dimensions.second,
+    efficiency);
+}
+
+int main(int argc, const char *const *argv)
+{
+  unsigned count = 20000, seed = 1;
+  bool guillotine = true, skyline = true;
+  for (int argPos = 1; argPos < argc; ++argPos) {
+    if (!strcmp(argv[argPos], "-count") && argPos + 1 < argc && sscanf(argv[argPos + 1], "%u", &count) == 1) {
+      ++argPos;
+      continue;
+    }
+    if (!strcmp(argv[argPos], "-seed") && argPos + 1 < argc && sscanf(argv[argPos + 1], "%u", &seed) == 1) {
+      ++argPos;
+      continue;
+    }
+    if (!strcmp(argv[argPos], "-packer") && argPos + 1 < argc) {
+      guillotine = !strcmp(argv[argPos + 1], "guillotine") || !strcmp(argv[argPos + 1], "all");
+      skyline = !strcmp(argv[argPos + 1], "skyline") || !strcmp(argv[argPos + 1], "all");
+      ++argPos;
+      continue;
+    }
+    fputs(helpText, stderr);
+    return 1;
+  }
+
+  std::vector<Rectangle> rectangles = generateRectangles(count, seed);
+  printf("%u rectangles, seed %u\n", count, seed);
+  if (skyline) runBenchmark<SkylinePacker>("skyline", rectangles);
+  if (guillotine) runBenchmark<RectanglePacker>("guillotine", rectangles);
+  return 0;
+}
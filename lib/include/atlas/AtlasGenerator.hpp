@@ -3,6 +3,7 @@
 #include "atlas/GlyphGeometry.hpp"
 #include "atlas/Remap.hpp"
 #include "core/BitmapRef.hpp"
+#include "core/GeneratorContext.hpp"
 #include "core/generator-config.hpp"
 
 namespace msdf_atlas {
@@ -18,10 +19,12 @@ public:
   AtlasGenerator(int width, int height);
   /// Generates bitmap representation for the supplied array of glyphs
   void generate(const GlyphGeometry *glyphs, int count);
-  /// Resizes the atlas and rearranges the generated pixels according to the remapping array
+  /// Resizes the last page of the atlas and rearranges its generated pixels according to the remapping array
   void rearrange(int width, int height, const Remap *remapping, int count);
-  /// Resizes the atlas and keeps the generated pixels in place
+  /// Resizes the last page of the atlas and keeps the generated pixels in place
   void resize(int width, int height);
+  /// Appends a new page of the given dimensions to the atlas, the glyph boxes' page indices refer to these pages
+  void addPage(int width, int height);
 };
 
 }// namespace msdf_atlas
@@ -31,6 +34,8 @@ struct GeneratorAttributes
 {
   msdfgen::MSDFGeneratorConfig config;
   bool scanlinePass = false;
+  /// Optional working memory reused between glyphs. Must not be used by multiple threads at once
+  msdfgen::GeneratorContext *context = nullptr;
 };
 
 /// A function that generates the bitmap for a single glyph
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace msdf_atlas {
+/*
+ * Binary layout file format, written by exportBinaryLayout. All values are little-endian, floating-point values
+ * are IEEE 754 doubles. The file consists of the header, the font records, and for each font its glyph records
+ * sorted by identifier, its kerning records sorted by the pair of identifiers, and its UTF-8 name followed by a null
+ * character. Each of these sections starts at a multiple of 8 bytes.
+ *
+ * Header (96 bytes):
+ *   0  char[8] magic "MSDFBLAY"    8  u32 version          12 u32 flags
+ *   16 u32 image type (ImageType)  20 u32 font count       24 f64 distance range    32 f64 size (em size in pixels)
+ *   40 i32 width                   44 i32 height           48 i32 page count        52 i32 grid cell width
+ *   56 i32 grid cell height        60 i32 grid columns     64 i32 grid rows         68 (reserved)
+ *   72 f64 grid origin X           80 f64 grid origin Y    88 u64 offset of font records
+ * Font record (96 bytes):
+ *   0  f64 em size                 8  f64 line height      16 f64 ascender          24 f64 descender
+ *   32 f64 underline Y             40 f64 underline thickness
+ *   48 u32 identifier type (GlyphIdentifierType)           52 u32 glyph count       56 u64 offset of glyph records
+ *   64 u64 kerning pair count      72 u64 offset of kerning records
+ *   80 u64 offset of name          88 u64 name length (0 if the font has no name)
+ * Glyph record (88 bytes):
+ *   0  u32 identifier (glyph index or Unicode codepoint)   4  i32 atlas page        8  u32 flags
+ *   12 (reserved)                  16 f64 advance
+ *   24 f64[4] plane bounds (left, bottom, right, top)      56 f64[4] atlas bounds (left, bottom, right, top)
+ * Kerning record (16 bytes):
+ *   0  u32 first identifier        4  u32 second identifier                         8  f64 advance adjustment
+ *
+ * As in the JSON output, the vertical metrics and bounds are flipped if the Y-axis points downwards.
+ */
+
+/// Zero-copy reader of the binary layout file format, to be used directly on the (memory-mapped) file contents
+class BinaryLayout
+{
+
+public:
+  static constexpr uint32_t VERSION = 1;
+  static constexpr size_t HEADER_SIZE = 96;
+  static constexpr size_t FONT_RECORD_SIZE = 96;
+  static constexpr size_t GLYPH_RECORD_SIZE = 88;
+  static constexpr size_t KERNING_RECORD_SIZE = 16;
+
+  /// Header flags
+  enum Flags : uint32_t { Y_TOP_DOWN = 0x01, GRID = 0x02, GRID_ORIGIN_X = 0x04, GRID_ORIGIN_Y = 0x08 };
+  /// Glyph flags
+  enum GlyphFlags : uint32_t { GLYPH_ROTATED = 0x01 };
+
+  struct AtlasMetrics
+  {
+    uint32_t flags;
+    uint32_t imageType;
+    double distanceRange;
+    double size;
+    int width, height;
+    int pageCount;
+    int gridCellWidth, gridCellHeight;
+    int gridColumns, gridRows;
+    double gridOriginX, gridOriginY;
+  };
+
+  struct FontMetrics
+  {
+    double emSize;
+    double lineHeight;
+    double ascender, descender;
+    double underlineY, underlineThickness;
+    uint32_t identifierType;
+  };
+
+  struct Glyph
+  {
+    uint32_t identifier;
+    int page;
+    uint32_t flags;
+    double advance;
+    double planeBounds[4];
+    double atlasBounds[4];
+  };
+
+  BinaryLayout() : data(nullptr), size(0) {}
+  /// Validates the file contents and sets up the reader, the data must remain valid while it is in use
+  bool open(const void *fileData, size_t fileSize)
+  {
+    data = reinterpret_cast<const unsigned char *>(fileData);
+    size = fileSize;
+    if (!(size >= HEADER_SIZE && !memcmp(data, "MSDFBLAY", 8) && u32(8) == VERSION && contains(u64(88), 0)
+          && (size - fontsOffset()) / FONT_RECORD_SIZE >= getFontCount())) {
+      data = nullptr, size = 0;
+      return false;
+    }
+    for (uint32_t i = 0; i < getFontCount(); ++i) {
+      size_t font = fontRecord(i);
+      if (!(contains(u64(font + 56), 0) && (size - u64(font + 56)) / GLYPH_RECORD_SIZE >= u32(font + 52)
+            && contains(u64(font + 72), 0) && (size - u64(font + 72)) / KERNING_RECORD_SIZE >= u64(font + 64)
+            && contains(u64(font + 80), 0) && size - u64(font + 80) > u64(font + 88))) {
+        data = nullptr, size = 0;
+        return false;
+      }
+    }
+    return true;
+  }
+  bool isOpen() const { return data != nullptr; }
+
+  AtlasMetrics getAtlasMetrics() const
+  {
+    AtlasMetrics metrics;
+    metrics.flags = u32(12);
+    metrics.imageType = u32(16);
+    metrics.distanceRange = f64(24);
+    metrics.size = f64(32);
+    metrics.width = i32(40), metrics.height = i32(44);
+    metrics.pageCount = i32(48);
+    metrics.gridCellWidth = i32(52), metrics.gridCellHeight = i32(56);
+    metrics.gridColumns = i32(60), metrics.gridRows = i32(64);
+    metrics.gridOriginX = f64(72), metrics.gridOriginY = f64(80);
+    return metrics;
+  }
+  uint32_t getFontCount() const { return u32(20); }
+  FontMetrics getFontMetrics(uint32_t font) const
+  {
+    size_t record = fontRecord(font);
+    FontMetrics metrics;
+    metrics.emSize = f64(record);
+    metrics.lineHeight = f64(record + 8);
+    metrics.ascender = f64(record + 16), metrics.descender = f64(record + 24);
+    metrics.underlineY = f64(record + 32), metrics.underlineThickness = f64(record + 40);
+    metrics.identifierType = u32(record + 48);
+    return metrics;
+  }
+  /// Returns the font's name (null-terminated) and its length, or nullptr if it has no name
+  const char *getFontName(uint32_t font, size_t *length = nullptr) const
+  {
+    size_t record = fontRecord(font);
+    if (length) *length = u64(record + 88);
+    return u64(record + 88) ? reinterpret_cast<const char *>(data + u64(record + 80)) : nullptr;
+  }
+  uint32_t getGlyphCount(uint32_t font) const { return u32(fontRecord(font) + 52); }
+  /// Outputs the glyph at the given position in the sorted glyph records
+  Glyph getGlyph(uint32_t font, uint32_t position) const
+  {
+    size_t record = u64(fontRecord(font) + 56) + GLYPH_RECORD_SIZE * position;
+    Glyph glyph;
+    glyph.identifier = u32(record);
+    glyph.page = i32(record + 4);
+    glyph.flags = u32(record + 8);
+    glyph.advance = f64(record + 16);
+    for (int i = 0; i < 4; ++i) {
+      glyph.planeBounds[i] = f64(record + 24 + 8 * i);
+      glyph.atlasBounds[i] = f64(record + 56 + 8 * i);
+    }
+    return glyph;
+  }
+  /// Finds the glyph with the given identifier by binary search, returns false if not present
+  bool findGlyph(Glyph &output, uint32_t font, uint32_t identifier) const
+  {
+    size_t records = u64(fontRecord(font) + 56);
+    uint32_t low = 0, high = getGlyphCount(font);
+    while (low < high) {
+      uint32_t mid = low + (high - low) / 2;
+      uint32_t midIdentifier = u32(records + GLYPH_RECORD_SIZE * mid);
+      if (midIdentifier < identifier)
+        low = mid + 1;
+      else if (midIdentifier > identifier)
+        high = mid;
+      else {
+        output = getGlyph(font, mid);
+        return true;
+      }
+    }
+    return false;
+  }
+  uint64_t getKerningCount(uint32_t font) const { return u64(fontRecord(font) + 64); }
+  /// Returns the kerning advance adjustment between two glyphs by binary search, or zero if the pair is not present
+  double getKerning(uint32_t font, uint32_t identifier1, uint32_t identifier2) const
+  {
+    size_t records = u64(fontRecord(font) + 72);
+    uint64_t key = (uint64_t)identifier1 << 32 | identifier2;
+    uint64_t low = 0, high = getKerningCount(font);
+    while (low < high) {
+      uint64_t mid = low + (high - low) / 2;
+      size_t record = records + KERNING_RECORD_SIZE * mid;
+      uint64_t midKey = (uint64_t)u32(record) << 32 | u32(record + 4);
+      if (midKey < key)
+        low = mid + 1;
+      else if (midKey > key)
+        high = mid;
+      else
+        return f64(record + 8);
+    }
+    return 0;
+  }
+
+private:
+  const unsigned char *data;
+  size_t size;
+
+  bool contains(uint64_t offset, size_t length) const { return offset <= size && length <= size - offset; }
+  size_t fontsOffset() const { return u64(88); }
+  size_t fontRecord(uint32_t font) const { return fontsOffset() + FONT_RECORD_SIZE * font; }
+  uint32_t u32(size_t offset) const
+  {
+    const unsigned char *p = data + offset;
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+  }
+  int i32(size_t offset) const { return (int32_t)u32(offset); }
+  uint64_t u64(size_t offset) const { return (uint64_t)u32(offset) | (uint64_t)u32(offset + 4) << 32; }
+  double f64(size_t offset) const
+  {
+    uint64_t bits = u64(offset);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+};
+}// namespace msdf_atlas
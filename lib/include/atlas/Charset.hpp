@@ -1,7 +1,8 @@
 #pragma once
 
 #include <cstdlib>
-#include <set>
+#include <iterator>
+#include <vector>
 
 #include "atlas/types.hpp"
 
@@ -14,23 +15,68 @@ namespace msdf_atlas {
 class Charset
 {
 public:
+  /// Inclusive range of codepoints
+  struct Range
+  {
+    unicode_t first, last;
+  };
+
+  /// Iterates over the codepoints in ascending order
+  class const_iterator
+  {
+  public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef unicode_t value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const unicode_t *pointer;
+    typedef const unicode_t &reference;
+
+    const_iterator();
+    const_iterator(const Range *range, const Range *rangesEnd);
+    const unicode_t &operator*() const;
+    const unicode_t *operator->() const;
+    const_iterator &operator++();
+    const_iterator operator++(int);
+    bool operator==(const const_iterator &other) const;
+    bool operator!=(const const_iterator &other) const;
+
+  private:
+    const Range *range, *rangesEnd;
+    unicode_t cp;
+  };
+
   /// The set of the 95 printable ASCII characters
   static MSDLIB_PUBLIC const Charset ASCII;
 
+  Charset();
+
   /// Adds a codepoint
   void add(unicode_t cp);
+  /// Adds all codepoints between first and last (inclusive)
+  void addRange(unicode_t first, unicode_t last);
+  /// Adds all codepoints of another set
+  void add(const Charset &charset);
   /// Removes a codepoint
   void remove(unicode_t cp);
+  /// Removes all codepoints between first and last (inclusive)
+  void removeRange(unicode_t first, unicode_t last);
+  /// Removes all codepoints of another set
+  void remove(const Charset &charset);
+  /// Returns true if the set contains the codepoint
+  bool contains(unicode_t cp) const;
 
   size_t size() const;
   bool empty() const;
-  std::set<unicode_t>::const_iterator begin() const;
-  std::set<unicode_t>::const_iterator end() const;
+  const_iterator begin() const;
+  const_iterator end() const;
+  /// Returns the sorted list of disjoint, non-adjacent ranges that make up the set
+  const std::vector<Range> &getRanges() const;
 
   /// Load character set from a text file with the correct syntax
   bool load(const char *filename, bool disableCharLiterals = false);
 
 private:
-  std::set<unicode_t> codepoints;
+  std::vector<Range> ranges;
+  size_t count;
 };
 }// namespace msdf_atlas
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <vector>
+
+#include "atlas/Rectangle.hpp"
+
+namespace msdf_atlas {
+/// Represents a section of an atlas page whose pixels have changed
+struct DirtyRegion
+{
+  int page;
+  Rectangle rect;
+};
+
+/// Adds a region to the list, coalescing it with regions of the same page whose common bounding box is no larger
+/// than the two regions combined (e.g. contained or adjoining regions)
+void addDirtyRegion(std::vector<DirtyRegion> &regions, const DirtyRegion &region);
+}// namespace msdf_atlas
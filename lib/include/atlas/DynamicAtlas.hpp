@@ -1,13 +1,26 @@
 #pragma once
 
-#include "atlas/DynamicAtlas.hpp"
+#include <algorithm>
+#include <vector>
+
+#include "atlas/DirtyRegion.hpp"
+#include "atlas/GlyphGeometry.hpp"
+#include "atlas/Rectangle.hpp"
+#include "atlas/RectanglePacker.hpp"
+#include "atlas/Remap.hpp"
 
 namespace msdf_atlas {
+/**
+ * This class can be used to produce a dynamic atlas to which more glyphs are added over time.
+ * It takes care of laying out and enlarging the atlas as necessary and delegates the actual work
+ * to the specified AtlasGenerator, which may e.g. do the work asynchronously.
+ * If a maximum side is set, a full page is no longer enlarged and further glyphs are placed in a new page.
+ */
 template<class AtlasGenerator> class DynamicAtlas
 {
 
 public:
-  enum ChangeFlag { NO_CHANGE = 0x00, RESIZED = 0x01, REARRANGED = 0x02 };
+  enum ChangeFlag { NO_CHANGE = 0x00, RESIZED = 0x01, REARRANGED = 0x02, NEW_PAGE = 0x04 };
   typedef int ChangeFlags;
 
   DynamicAtlas();
@@ -17,44 +30,53 @@ public:
   explicit DynamicAtlas(AtlasGenerator &&generator);
   /// Adds a batch of glyphs. Adding more than one glyph at a time may improve packing efficiency
   ChangeFlags add(GlyphGeometry *glyphs, int count, bool allowRearrange = false);
+  /// Adds a batch of glyphs and outputs the coalesced list of atlas regions that have changed and need to be uploaded.
+  /// The generator must support dirty region tracking (see ImmediateAtlasGenerator), its tracking state is restored
+  ChangeFlags add(GlyphGeometry *glyphs, int count, bool allowRearrange, std::vector<DirtyRegion> &dirtyRegions);
+  /// Sets the maximum side of a page. Zero (default) means that the atlas consists of a single unbounded page
+  void setMaximumSide(int maxSide);
+  /// Returns the number of pages
+  int getPageCount() const;
   /// Allows access to generator. Do not add glyphs to the generator directly!
   AtlasGenerator &atlasGenerator();
   const AtlasGenerator &atlasGenerator() const;
 
 private:
   int side;
+  int maxSide;
   int spacing;
   int glyphCount;
   int totalArea;
+  int page;
+  int pageStart;
   RectanglePacker packer;
   AtlasGenerator generator;
   std::vector<Rectangle> rectangles;
   std::vector<Remap> remapBuffer;
+  std::vector<Remap> rearrangeBuffer;
+
+  static int ceilPOT(int x);
+
+  int sortPlaced(int begin);
+  ChangeFlags updatePage(GlyphGeometry *glyphs, int end, ChangeFlags pendingChanges);
 };
-static int ceilPOT(int x)
-{
-  if (x > 0) {
-    int y = 1;
-    while (y < x) y <<= 1;
-    return y;
-  }
-  return 0;
-}
 
 template<class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas() : side(0), spacing(0), glyphCount(0), totalArea(0)
+DynamicAtlas<AtlasGenerator>::DynamicAtlas()
+  : side(0), maxSide(0), spacing(0), glyphCount(0), totalArea(0), page(0), pageStart(0)
 {}
 
 template<class AtlasGenerator>
 template<typename... ARGS>
 DynamicAtlas<AtlasGenerator>::DynamicAtlas(int minSide, ARGS... args)
-  : side(ceilPOT(minSide)), spacing(0), glyphCount(0), totalArea(0), packer(side + spacing, side + spacing),
-    generator(side, side, args...)
+  : side(ceilPOT(minSide)), maxSide(0), spacing(0), glyphCount(0), totalArea(0), page(0), pageStart(0),
+    packer(side + spacing, side + spacing), generator(side, side, args...)
 {}
 
 template<class AtlasGenerator>
 DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator)
-  : side(0), spacing(0), glyphCount(0), totalArea(0), generator((AtlasGenerator &&)generator)
+  : side(0), maxSide(0), spacing(0), glyphCount(0), totalArea(0), page(0), pageStart(0),
+    generator((AtlasGenerator &&)generator)
 {}
 
 template<class AtlasGenerator>
@@ -67,7 +89,7 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags
     if (!glyphs[i].isWhitespace()) {
       int w, h;
       glyphs[i].getBoxSize(w, h);
-      Rectangle rect = { 0, 0, w + spacing, h + spacing };
+      Rectangle rect = { -1, -1, w + spacing, h + spacing };
       rectangles.push_back(rect);
       Remap remapEntry = {};
       remapEntry.index = glyphCount + i;
@@ -78,46 +100,154 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags
     }
   }
   if ((int)rectangles.size() > start) {
+    ChangeFlags pendingChanges = 0;
     int packerStart = start;
-    int remaining;
-    while ((remaining = packer.pack(rectangles.data() + packerStart, rectangles.size() - packerStart)) > 0) {
-      side = (side | !side) << 1;
-      while (side * side < totalArea) side <<= 1;
+    for (;;) {
+      for (int i = packerStart; i < (int)rectangles.size(); ++i) rectangles[i].x = -1;
+      packer.pack(rectangles.data() + packerStart, rectangles.size() - packerStart);
+      int placedEnd = sortPlaced(packerStart);
+      if (placedEnd == (int)rectangles.size()) break;
+      if (maxSide > 0 && side >= maxSide && placedEnd > pageStart) {
+        // The page is full - keep it as it is and continue in a new page
+        if (packerStart < start) {
+          // A rearrangement which could not fit the existing glyphs is dropped along with the new glyphs packed with it
+          for (int i = pageStart; i < (int)rectangles.size(); ++i) {
+            if (remapBuffer[i].index < glyphCount) {
+              rectangles[i].x = remapBuffer[i].target.x;
+              rectangles[i].y = remapBuffer[i].target.y;
+            } else
+              rectangles[i].x = -1;
+          }
+          placedEnd = sortPlaced(pageStart);
+          pendingChanges &= ~REARRANGED;
+        }
+        changeFlags |= updatePage(glyphs, placedEnd, pendingChanges);
+        pendingChanges = 0;
+        ++page;
+        pageStart = placedEnd;
+        totalArea = 0;
+        for (int i = pageStart; i < (int)rectangles.size(); ++i) totalArea += rectangles[i].w * rectangles[i].h;
+        packer = RectanglePacker(side + spacing, side + spacing);
+        generator.addPage(side, side);
+        packerStart = pageStart;
+        changeFlags |= NEW_PAGE;
+        continue;
+      }
+      int newSide = (side | !side) << 1;
+      while (newSide * newSide < totalArea) newSide <<= 1;
+      // The maximum side is only exceeded by a page which is too small for a single glyph
+      if (side < maxSide) newSide = std::min(newSide, maxSide);
+      side = newSide;
       if (allowRearrange) {
         packer = RectanglePacker(side + spacing, side + spacing);
-        packerStart = 0;
+        packerStart = pageStart;
+        pendingChanges |= RESIZED | REARRANGED;
       } else {
         packer.expand(side + spacing, side + spacing);
-        packerStart = rectangles.size() - remaining;
-      }
-      changeFlags |= RESIZED;
-    }
-    if (packerStart < start) {
-      for (int i = packerStart; i < start; ++i) {
-        Remap &remap = remapBuffer[i];
-        remap.source = remap.target;
-        remap.target.x = rectangles[i].x;
-        remap.target.y = rectangles[i].y;
+        packerStart = placedEnd;
+        pendingChanges |= RESIZED;
       }
-      generator.rearrange(side, side, remapBuffer.data(), start);
-      changeFlags |= REARRANGED;
-    } else if (changeFlags & RESIZED)
-      generator.resize(side, side);
-    for (int i = start; i < (int)rectangles.size(); ++i) {
-      remapBuffer[i].target.x = rectangles[i].x;
-      remapBuffer[i].target.y = rectangles[i].y;
-      glyphs[remapBuffer[i].index - glyphCount].placeBox(rectangles[i].x, rectangles[i].y);
     }
+    changeFlags |= updatePage(glyphs, rectangles.size(), pendingChanges);
   }
   generator.generate(glyphs, count);
   glyphCount += count;
   return changeFlags;
 }
 
+template<class AtlasGenerator>
+typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs,
+  int count,
+  bool allowRearrange,
+  std::vector<DirtyRegion> &dirtyRegions)
+{
+  bool wasTracking = generator.isDirtyRegionTracking();
+  generator.setDirtyRegionTracking(true);
+  generator.clearDirtyRegions();
+  ChangeFlags changeFlags = add(glyphs, count, allowRearrange);
+  dirtyRegions = generator.getDirtyRegions();
+  // Otherwise, later changes would keep accumulating in the generator
+  generator.setDirtyRegionTracking(wasTracking);
+  if (!wasTracking) generator.clearDirtyRegions();
+  return changeFlags;
+}
+
+template<class AtlasGenerator> void DynamicAtlas<AtlasGenerator>::setMaximumSide(int maxSide)
+{
+  this->maxSide = maxSide;
+}
+
+template<class AtlasGenerator> int DynamicAtlas<AtlasGenerator>::getPageCount() const { return page + 1; }
+
 template<class AtlasGenerator> AtlasGenerator &DynamicAtlas<AtlasGenerator>::atlasGenerator() { return generator; }
 
 template<class AtlasGenerator> const AtlasGenerator &DynamicAtlas<AtlasGenerator>::atlasGenerator() const
 {
   return generator;
 }
+
+template<class AtlasGenerator> int DynamicAtlas<AtlasGenerator>::ceilPOT(int x)
+{
+  if (x > 0) {
+    int y = 1;
+    while (y < x) y <<= 1;
+    return y;
+  }
+  return 0;
+}
+
+template<class AtlasGenerator> int DynamicAtlas<AtlasGenerator>::sortPlaced(int begin)
+{
+  // Moves the rectangles which have been placed in front of the ones which haven't, along with their remap entries
+  int end = begin;
+  for (int i = begin; i < (int)rectangles.size(); ++i) {
+    if (rectangles[i].x >= 0) {
+      if (i != end) {
+        std::swap(rectangles[i], rectangles[end]);
+        std::swap(remapBuffer[i], remapBuffer[end]);
+      }
+      ++end;
+    }
+  }
+  return end;
+}
+
+template<class AtlasGenerator>
+typename DynamicAtlas<AtlasGenerator>::ChangeFlags
+  DynamicAtlas<AtlasGenerator>::updatePage(GlyphGeometry *glyphs, int end, ChangeFlags pendingChanges)
+{
+  // Applies the changes to the current page and places the new glyphs among its first end rectangles
+  ChangeFlags changeFlags = 0;
+  if (pendingChanges & REARRANGED) {
+    rearrangeBuffer.clear();
+    for (int i = pageStart; i < end; ++i) {
+      Remap &remap = remapBuffer[i];
+      if (remap.index < glyphCount) {
+        remap.source = remap.target;
+        remap.target.x = rectangles[i].x;
+        remap.target.y = rectangles[i].y;
+        rearrangeBuffer.push_back(remap);
+      }
+    }
+    if (!rearrangeBuffer.empty()) {
+      generator.rearrange(side, side, rearrangeBuffer.data(), rearrangeBuffer.size());
+      changeFlags |= RESIZED | REARRANGED;
+      pendingChanges &= ~RESIZED;
+    }
+  }
+  if (pendingChanges & RESIZED) {
+    generator.resize(side, side);
+    changeFlags |= RESIZED;
+  }
+  for (int i = pageStart; i < end; ++i) {
+    if (remapBuffer[i].index >= glyphCount) {
+      GlyphGeometry &glyph = glyphs[remapBuffer[i].index - glyphCount];
+      remapBuffer[i].target.x = rectangles[i].x;
+      remapBuffer[i].target.y = rectangles[i].y;
+      glyph.placeBox(rectangles[i].x, rectangles[i].y);
+      glyph.setBoxPage(page);
+    }
+  }
+  return changeFlags;
+}
 }// namespace msdf_atlas
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <utility>
@@ -56,16 +57,50 @@ public:
     const Charset &charset,
     bool preprocessGeometry = true,
     bool enableKerning = true);
+  /// Parallel versions of the above, which load the font from its file data in memory. Each of the threadCount
+  /// workers opens its own font handle and loads a share of the glyphs, which are then added in the same order
+  int loadGlyphRange(const byte *fontData,
+    int fontDataLength,
+    double fontScale,
+    unsigned rangeStart,
+    unsigned rangeEnd,
+    int threadCount,
+    bool preprocessGeometry = true,
+    bool enableKerning = true);
+  int loadGlyphset(const byte *fontData,
+    int fontDataLength,
+    double fontScale,
+    const Charset &glyphset,
+    int threadCount,
+    bool preprocessGeometry = true,
+    bool enableKerning = true);
+  int loadCharset(const byte *fontData,
+    int fontDataLength,
+    double fontScale,
+    const Charset &charset,
+    int threadCount,
+    bool preprocessGeometry = true,
+    bool enableKerning = true);
 
   /// Only loads font metrics and geometry scale from font
   bool loadMetrics(msdfgen::FontHandle *font, double fontScale);
   /// Adds a loaded glyph
   bool addGlyph(const GlyphGeometry &glyph);
   bool addGlyph(GlyphGeometry &&glyph);
-  /// Loads kerning pairs for all glyphs that are currently present, returns the number of loaded kerning pairs
-  int loadKerning(msdfgen::FontHandle *font);
+  /// Loads kerning pairs for all glyphs that are currently present, returns the number of loaded kerning pairs.
+  /// If gposKerning is true, pairs missing from the 'kern' table are also read from the 'GPOS' table
+  int loadKerning(msdfgen::FontHandle *font, bool gposKerning = false);
+  /// Sets the geometry scale and the processed font metrics, e.g. when restoring them from a serialized representation
+  void setMetrics(double geometryScale, const msdfgen::FontMetrics &metrics);
+  /// Sets the type of identifier that was used to load glyphs
+  void setPreferredIdentifierType(GlyphIdentifierType type);
+  /// Sets the advance adjustment of a kerning pair (by glyph indices)
+  void setKerning(int index1, int index2, double advance);
   /// Sets a name to be associated with the font
   void setName(const char *name);
+  /// Builds flat sorted lookup tables of glyphs and kerning pairs for faster getGlyph and getAdvance once loading is
+  /// complete. Adding glyphs or kerning pairs afterwards discards them until freeze is called again
+  void freeze();
 
   /// Returns the geometry scale to be used when loading glyphs
   double getGeometryScale() const;
@@ -85,6 +120,8 @@ public:
   const std::map<std::pair<int, int>, double> &getKerning() const;
   /// Returns the name associated with the font or null if not set
   const char *getName() const;
+  /// Returns true if the lookup tables built by freeze are in use
+  bool isFrozen() const;
 
 private:
   double geometryScale;
@@ -97,5 +134,24 @@ private:
   std::map<std::pair<int, int>, double> kerning;
   std::vector<GlyphGeometry> ownGlyphs;
   std::string name;
+  bool frozen;
+  std::vector<std::pair<int, size_t>> frozenGlyphsByIndex;
+  std::vector<std::pair<unicode_t, size_t>> frozenGlyphsByCodepoint;
+  /// Kerning pairs as (index1 << 32 | index2) keys, sorted, and their respective advance values
+  std::vector<uint64_t> frozenKerningKeys;
+  std::vector<double> frozenKerningValues;
+
+  void unfreeze();
+  /// Returns the kerning advance adjustment between two glyphs (by glyph indices), zero if not present
+  double getKerningAdvance(int index1, int index2) const;
+
+  int loadGlyphs(const byte *fontData,
+    int fontDataLength,
+    double fontScale,
+    const std::vector<unicode_t> &identifiers,
+    GlyphIdentifierType identifierType,
+    int threadCount,
+    bool preprocessGeometry,
+    bool enableKerning);
 };
 }// namespace msdf_atlas
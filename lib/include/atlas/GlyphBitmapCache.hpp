@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#include "atlas/AtlasGenerator.hpp"
+#include "atlas/GlyphGeometry.hpp"
+#include "core/BitmapRef.hpp"
+
+namespace msdf_atlas {
+/**
+ * A persistent cache of generated glyph bitmaps in a directory, which can be shared between runs and processes.
+ * Each bitmap is stored in its own file named after a key computed from everything that affects its contents -
+ * the colored shape, the box projection and range, the generator and its attributes (see getKey).
+ * Entries are written into a temporary file first and then renamed, so concurrent writers never expose partial files.
+ * Loading and storing is thread-safe.
+ */
+class GlyphBitmapCache
+{
+
+public:
+  struct Stats
+  {
+    unsigned long long hits, misses, stores;
+    unsigned long long bytesRead, bytesWritten;
+  };
+
+  GlyphBitmapCache();
+  /// Sets the cache directory, which is created if it does not exist
+  bool open(const char *directory);
+  /// Returns true if a directory is set
+  bool isOpen() const;
+  /// Computes the key of the glyph's box bitmap generated by the named generator function with the given attributes
+  static unsigned long long getKey(const char *generatorName,
+    const GlyphGeometry &glyph,
+    const GeneratorAttributes &attributes,
+    int channels,
+    int channelSize);
+  /// Fills the bitmap with the cached entry, returns false if there is no entry of the same key and dimensions
+  template<typename T, int N> bool load(unsigned long long key, const msdfgen::BitmapRef<T, N> &bitmap);
+  /// Stores the bitmap under the given key
+  template<typename T, int N> bool store(unsigned long long key, const msdfgen::BitmapConstRef<T, N> &bitmap);
+  /// Returns the statistics of load and store operations
+  Stats getStats() const;
+  void resetStats();
+
+private:
+  std::string directory;
+  unsigned long long tempSeed;
+  std::atomic<unsigned long long> tempCounter;
+  std::atomic<unsigned long long> hits, misses, stores;
+  std::atomic<unsigned long long> bytesRead, bytesWritten;
+
+  std::string entryFilename(unsigned long long key) const;
+  bool load(unsigned long long key, void *data, int width, int height, int channels, int channelSize);
+  bool store(unsigned long long key, const void *data, int width, int height, int channels, int channelSize);
+};
+
+template<typename T, int N>
+bool GlyphBitmapCache::load(unsigned long long key, const msdfgen::BitmapRef<T, N> &bitmap)
+{
+  return load(key, bitmap.pixels, bitmap.width, bitmap.height, N, (int)sizeof(T));
+}
+
+template<typename T, int N>
+bool GlyphBitmapCache::store(unsigned long long key, const msdfgen::BitmapConstRef<T, N> &bitmap)
+{
+  return store(key, bitmap.pixels, bitmap.width, bitmap.height, N, (int)sizeof(T));
+}
+}// namespace msdf_atlas
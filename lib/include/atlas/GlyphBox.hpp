@@ -13,5 +13,7 @@ struct GlyphBox
     double l, b, r, t;
   } bounds;
   Rectangle rect;
+  int page;
+  bool rotated;
 };
 }// namespace msdf_atlas
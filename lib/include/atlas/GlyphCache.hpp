@@ -0,0 +1,304 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <map>
+#include <vector>
+
+#include "atlas/FontGeometry.hpp"
+#include "atlas/GlyphBox.hpp"
+#include "atlas/GlyphGeometry.hpp"
+#include "atlas/Rectangle.hpp"
+#include "atlas/RectanglePacker.hpp"
+
+namespace msdf_atlas {
+/**
+ * A runtime glyph cache in an atlas of fixed dimensions. Glyphs are looked up by font, glyph index and size,
+ * generated on demand when missing, and the least recently used glyphs are evicted to make space for new ones.
+ * Unlike DynamicAtlas, the atlas never grows, so memory usage stays bounded regardless of the requested glyphs.
+ * Besides the AtlasGenerator interface, the generator must provide clearLayout and clearArea (see
+ * ImmediateAtlasGenerator).
+ */
+template<class AtlasGenerator> class GlyphCache
+{
+
+public:
+  struct Stats
+  {
+    unsigned long long hits, misses, evictions;
+  };
+
+  /// Initializes generator with the atlas dimensions and custom arguments for generator
+  template<typename... ARGS> GlyphCache(int width, int height, ARGS... args);
+  /// Finds the glyph of the given size (in pixels per em) and generates it if not present, outputting its box.
+  /// Returns false if the font does not contain the glyph or if it cannot fit into the atlas
+  bool get(GlyphBox &box, const FontGeometry &font, msdfgen::GlyphIndex index, double size);
+  bool get(GlyphBox &box, const FontGeometry &font, unicode_t codepoint, double size);
+  /// Finds a batch of glyphs, generating all missing ones at once. Glyphs of the same batch are never evicted by each
+  /// other. Returns the number of glyphs which could not be provided (their boxes are zeroed)
+  int get(GlyphBox *boxes, const FontGeometry &font, const msdfgen::GlyphIndex *indices, int count, double size);
+  int get(GlyphBox *boxes, const FontGeometry &font, const unicode_t *codepoints, int count, double size);
+  /// Sets the distance range in output pixels. Glyphs are cached separately for each combination of distance range,
+  /// miter limit and origin alignment
+  void setPixelRange(double pxRange);
+  /// Sets the miter limit for bounds computation
+  void setMiterLimit(double miterLimit);
+  /// Sets the spacing between glyph boxes, which prevents bleeding between neighbors when sampled with filtering.
+  /// Only affects glyphs generated afterwards
+  void setSpacing(int spacing);
+  /// Sets whether each glyph's origin point should stay aligned with the pixel grid
+  void setOriginPixelAlignment(bool align);
+  void setOriginPixelAlignment(bool alignX, bool alignY);
+  /// Evicts all glyphs
+  void clear();
+  /// Returns the number of cached glyphs
+  int getGlyphCount() const;
+  /// Returns the lookup statistics
+  Stats getStats() const;
+  void resetStats();
+  /// Allows access to generator. Do not add glyphs to the generator directly!
+  AtlasGenerator &atlasGenerator();
+  const AtlasGenerator &atlasGenerator() const;
+
+private:
+  struct Key
+  {
+    const FontGeometry *font;
+    int index;
+    double size;
+    double pxRange;
+    double miterLimit;
+    bool pxAlignOriginX, pxAlignOriginY;
+
+    bool operator<(const Key &other) const;
+  };
+
+  struct Entry
+  {
+    Key key;
+    GlyphBox box;
+    /// The area occupied in the atlas, which includes the spacing after the box
+    Rectangle allocation;
+    unsigned long long batch;
+  };
+
+  int width, height;
+  int spacing;
+  double pxRange;
+  double miterLimit;
+  bool pxAlignOriginX, pxAlignOriginY;
+  RectanglePacker packer;
+  long long usedArea;
+  AtlasGenerator generator;
+  std::list<Entry> entries;
+  std::map<Key, typename std::list<Entry>::iterator> lookup;
+  std::vector<GlyphGeometry> pendingGlyphs;
+  unsigned long long batch;
+  Stats stats;
+
+  bool find(GlyphBox &box, const FontGeometry &font, const GlyphGeometry *glyph, double size);
+  bool allocate(Rectangle &rect);
+  void rebuildFreeSpace();
+  void evictLeastRecent();
+  void generatePending();
+};
+
+template<class AtlasGenerator>
+bool GlyphCache<AtlasGenerator>::Key::operator<(const Key &other) const
+{
+  if (font != other.font) return std::less<const FontGeometry *>()(font, other.font);
+  if (index != other.index) return index < other.index;
+  if (size != other.size) return size < other.size;
+  if (pxRange != other.pxRange) return pxRange < other.pxRange;
+  if (miterLimit != other.miterLimit) return miterLimit < other.miterLimit;
+  if (pxAlignOriginX != other.pxAlignOriginX) return pxAlignOriginX < other.pxAlignOriginX;
+  return pxAlignOriginY < other.pxAlignOriginY;
+}
+
+template<class AtlasGenerator>
+template<typename... ARGS>
+GlyphCache<AtlasGenerator>::GlyphCache(int width, int height, ARGS... args)
+  : width(width), height(height), spacing(0), pxRange(2), miterLimit(0), pxAlignOriginX(false), pxAlignOriginY(false),
+    packer(width, height), usedArea(0), generator(width, height, args...), batch(0), stats()
+{}
+
+template<class AtlasGenerator>
+bool GlyphCache<AtlasGenerator>::get(GlyphBox &box, const FontGeometry &font, msdfgen::GlyphIndex index, double size)
+{
+  return !get(&box, font, &index, 1, size);
+}
+
+template<class AtlasGenerator>
+bool GlyphCache<AtlasGenerator>::get(GlyphBox &box, const FontGeometry &font, unicode_t codepoint, double size)
+{
+  return !get(&box, font, &codepoint, 1, size);
+}
+
+template<class AtlasGenerator>
+int GlyphCache<AtlasGenerator>::get(GlyphBox *boxes,
+  const FontGeometry &font,
+  const msdfgen::GlyphIndex *indices,
+  int count,
+  double size)
+{
+  int failed = 0;
+  ++batch;
+  for (int i = 0; i < count; ++i) failed += !find(boxes[i], font, font.getGlyph(indices[i]), size);
+  generatePending();
+  return failed;
+}
+
+template<class AtlasGenerator>
+int GlyphCache<AtlasGenerator>::get(GlyphBox *boxes,
+  const FontGeometry &font,
+  const unicode_t *codepoints,
+  int count,
+  double size)
+{
+  int failed = 0;
+  ++batch;
+  for (int i = 0; i < count; ++i) failed += !find(boxes[i], font, font.getGlyph(codepoints[i]), size);
+  generatePending();
+  return failed;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::setPixelRange(double pxRange)
+{
+  this->pxRange = pxRange;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::setMiterLimit(double miterLimit)
+{
+  this->miterLimit = miterLimit;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::setSpacing(int spacing)
+{
+  this->spacing = spacing;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::setOriginPixelAlignment(bool align)
+{
+  pxAlignOriginX = align, pxAlignOriginY = align;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::setOriginPixelAlignment(bool alignX, bool alignY)
+{
+  pxAlignOriginX = alignX, pxAlignOriginY = alignY;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::clear()
+{
+  stats.evictions += entries.size();
+  entries.clear();
+  lookup.clear();
+  packer = RectanglePacker(width, height);
+  usedArea = 0;
+}
+
+template<class AtlasGenerator> int GlyphCache<AtlasGenerator>::getGlyphCount() const { return (int)entries.size(); }
+
+template<class AtlasGenerator> typename GlyphCache<AtlasGenerator>::Stats GlyphCache<AtlasGenerator>::getStats() const
+{
+  return stats;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::resetStats() { stats = Stats(); }
+
+template<class AtlasGenerator> AtlasGenerator &GlyphCache<AtlasGenerator>::atlasGenerator() { return generator; }
+
+template<class AtlasGenerator> const AtlasGenerator &GlyphCache<AtlasGenerator>::atlasGenerator() const
+{
+  return generator;
+}
+
+template<class AtlasGenerator>
+bool GlyphCache<AtlasGenerator>::find(GlyphBox &box, const FontGeometry &font, const GlyphGeometry *glyph, double size)
+{
+  box = GlyphBox();
+  if (!glyph) {
+    ++stats.misses;
+    return false;
+  }
+  Key key = { &font, glyph->getIndex(), size, pxRange, miterLimit, pxAlignOriginX, pxAlignOriginY };
+  typename std::map<Key, typename std::list<Entry>::iterator>::iterator it = lookup.find(key);
+  if (it != lookup.end()) {
+    // Move to the front of the list, which is ordered from the most to the least recently used
+    entries.splice(entries.begin(), entries, it->second);
+    it->second->batch = batch;
+    box = it->second->box;
+    ++stats.hits;
+    return true;
+  }
+  ++stats.misses;
+  GlyphGeometry newGlyph(*glyph);
+  newGlyph.wrapBox(size, pxRange / size, miterLimit, pxAlignOriginX, pxAlignOriginY);
+  Rectangle rect = newGlyph.getBoxRect();
+  Rectangle allocation = {};
+  if (!newGlyph.isWhitespace() && rect.w > 0 && rect.h > 0) {
+    if (rect.w > width || rect.h > height) return false;
+    // No spacing is needed beyond the atlas's edges
+    allocation.w = std::min(rect.w + spacing, width);
+    allocation.h = std::min(rect.h + spacing, height);
+    if (!allocate(allocation)) return false;
+    newGlyph.placeBox(allocation.x, allocation.y);
+    // The box itself is overwritten by the generator, but the spacing may still contain pixels of evicted glyphs
+    generator.clearArea(0, Rectangle{ allocation.x + rect.w, allocation.y, allocation.w - rect.w, allocation.h });
+    generator.clearArea(0, Rectangle{ allocation.x, allocation.y + rect.h, rect.w, allocation.h - rect.h });
+  } else
+    newGlyph.placeBox(0, 0);
+  newGlyph.setBoxPage(0);
+  Entry entry = { key, (GlyphBox)newGlyph, allocation, batch };
+  entries.push_front(entry);
+  lookup[key] = entries.begin();
+  box = entry.box;
+  if (!newGlyph.isWhitespace()) pendingGlyphs.push_back((GlyphGeometry &&)newGlyph);
+  return true;
+}
+
+template<class AtlasGenerator> bool GlyphCache<AtlasGenerator>::allocate(Rectangle &rect)
+{
+  bool rebuilt = false;
+  while (packer.pack(&rect, 1)) {
+    // The free space may be too fragmented even though there is enough of it in total. It is rebuilt at most once,
+    // since evictions merge the released areas with adjacent free space anyway
+    if (!rebuilt && usedArea + rect.w * rect.h <= (long long)width * height) {
+      rebuildFreeSpace();
+      rebuilt = true;
+      continue;
+    }
+    // Glyphs requested in the current batch must stay in place
+    if (entries.empty() || entries.back().batch == batch) return false;
+    evictLeastRecent();
+  }
+  usedArea += rect.w * rect.h;
+  return true;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::rebuildFreeSpace()
+{
+  packer = RectanglePacker(width, height);
+  for (const Entry &entry : entries) packer.occupy(entry.allocation);
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::evictLeastRecent()
+{
+  Entry &entry = entries.back();
+  packer.release(entry.allocation);
+  usedArea -= entry.allocation.w * entry.allocation.h;
+  lookup.erase(entry.key);
+  entries.pop_back();
+  ++stats.evictions;
+}
+
+template<class AtlasGenerator> void GlyphCache<AtlasGenerator>::generatePending()
+{
+  if (!pendingGlyphs.empty()) {
+    generator.generate(pendingGlyphs.data(), pendingGlyphs.size());
+    // The cache keeps track of the layout itself, so the generator's layout must not grow indefinitely
+    generator.clearLayout();
+    pendingGlyphs.clear();
+  }
+}
+}// namespace msdf_atlas
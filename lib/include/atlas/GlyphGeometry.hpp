@@ -15,6 +15,13 @@ public:
   /// Loads glyph geometry from font
   bool load(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry = true);
   bool load(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry = true);
+  /// Sets previously loaded glyph geometry, e.g. when restoring it from a serialized representation
+  void setGeometry(int index,
+    unicode_t codepoint,
+    double geometryScale,
+    msdfgen::Shape &&shape,
+    const msdfgen::Shape::Bounds &bounds,
+    double advance);
   /// Applies edge coloring to glyph shape
   void edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long),
     double angleThreshold,
@@ -22,6 +29,14 @@ public:
   /// Computes the dimensions of the glyph's box as well as the transformation for the generator function
   void wrapBox(double scale, double range, double miterLimit, bool pxAlignOrigin = false);
   void wrapBox(double scale, double range, double miterLimit, bool pxAlignOriginX, bool pxAlignOriginY);
+  /// Outputs the dimensions the glyph's box would have after wrapBox with the same arguments without modifying it
+  void measureBox(int &w,
+    int &h,
+    double scale,
+    double range,
+    double miterLimit,
+    bool pxAlignOriginX,
+    bool pxAlignOriginY) const;
   /// Computes the glyph's transformation and alignment (unless specified) for given dimensions
   void frameBox(double scale,
     double range,
@@ -44,6 +59,12 @@ public:
   void placeBox(int x, int y);
   /// Sets the glyph's box's rectangle in the atlas
   void setBoxRect(const Rectangle &rect);
+  /// Sets the index of the atlas page which contains the glyph's box
+  void setBoxPage(int page);
+  /// Sets whether the glyph's box is rotated by 90 degrees counter-clockwise in the atlas, swapping its dimensions
+  void setBoxRotated(bool rotated);
+  /// Marks the glyph's box as sharing the atlas area of an identical glyph, so that it does not need to be generated
+  void setBoxDuplicate(bool duplicate);
   /// Returns the glyph's index within the font
   int getIndex() const;
   /// Returns the glyph's index as a msdfgen::GlyphIndex
@@ -66,6 +87,16 @@ public:
   void getBoxRect(int &x, int &y, int &w, int &h) const;
   /// Outputs the dimensions of the glyph's box in the atlas
   void getBoxSize(int &w, int &h) const;
+  /// Outputs the dimensions of the glyph's bitmap, which are swapped in the atlas if the box is rotated
+  void getBoxBitmapSize(int &w, int &h) const;
+  /// Returns the index of the atlas page which contains the glyph's box
+  int getBoxPage() const;
+  /// Returns true if the glyph's box is rotated by 90 degrees counter-clockwise in the atlas. In that case,
+  /// the left-bottom corner of the plane bounds corresponds to the right-bottom corner of the atlas bounds,
+  /// right-bottom to right-top, right-top to left-top, and left-top to left-bottom
+  bool isBoxRotated() const;
+  /// Returns true if the glyph's box shares the atlas area of an identical glyph, which generates its contents
+  bool isBoxDuplicate() const;
   /// Returns the range needed to generate the glyph's SDF
   double getBoxRange() const;
   /// Returns the projection needed to generate the glyph's bitmap
@@ -93,9 +124,21 @@ private:
   struct
   {
     Rectangle rect;
+    int page;
+    bool rotated;
+    bool duplicate;
     double range;
     double scale;
     msdfgen::Vector2 translate;
   } box;
+
+  void computeBox(int &w,
+    int &h,
+    msdfgen::Vector2 &translate,
+    double scale,
+    double range,
+    double miterLimit,
+    bool pxAlignOriginX,
+    bool pxAlignOriginY) const;
 };
 }// namespace msdf_atlas
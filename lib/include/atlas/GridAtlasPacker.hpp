@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include "GlyphGeometry.hpp"
 
 namespace msdf_atlas {
@@ -47,6 +49,10 @@ public:
   /// Sets whether each glyph's origin point should stay aligned with the pixel grid
   void setOriginPixelAlignment(bool align);
   void setOriginPixelAlignment(bool alignX, bool alignY);
+  /// Sets whether glyphs with identical geometry should share a single cell (see GlyphGeometry::isBoxDuplicate)
+  void setDeduplication(bool deduplication);
+  /// Sets the number of threads used to compute glyph bounds and evaluate candidate grid layouts
+  void setThreadCount(int threadCount);
 
   /// Outputs the atlas's final dimensions
   void getDimensions(int &width, int &height) const;
@@ -84,23 +90,43 @@ private:
   double scaleMaximizationTolerance;
   double alignedColumnsBias;
   bool cutoff;
+  bool deduplication;
+  int threadCount;
+  /// For each glyph being packed, the index of the first glyph with identical geometry (empty if there are none)
+  std::vector<int> originals;
+
+  /// Scale-invariant data of a non-whitespace glyph needed to compute its bounds at any scale
+  struct GlyphBounds
+  {
+    double geometryScale;
+    const msdfgen::Shape *shape;
+    msdfgen::Shape::Bounds shapeBounds;
+  };
+
+  struct BoundsCache
+  {
+    std::vector<GlyphBounds> glyphs;
+  };
 
   static void lowerToConstraint(int &width, int &height, DimensionsConstraint constraint);
   static void raiseToConstraint(int &width, int &height, DimensionsConstraint constraint);
 
   double dimensionsRating(int width, int height, bool aligned) const;
+  bool isDuplicate(int index) const;
+  void cacheBounds(BoundsCache &cache, const GlyphGeometry *glyphs, int count) const;
   msdfgen::Shape::Bounds getMaxBounds(double &maxWidth,
     double &maxHeight,
-    GlyphGeometry *glyphs,
-    int count,
+    const BoundsCache &cache,
     double scale,
-    double range) const;
-  double scaleToFit(GlyphGeometry *glyphs,
-    int count,
+    double range,
+    int threads) const;
+  double scaleToFit(const BoundsCache &cache,
     int cellWidth,
     int cellHeight,
     msdfgen::Shape::Bounds &maxBounds,
     double &maxWidth,
-    double &maxHeight) const;
+    double &maxHeight,
+    int threads) const;
+  int pack(GlyphGeometry *glyphs, int count, const BoundsCache &cache);
 };
 }// namespace msdf_atlas
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+#include "atlas/types.hpp"
+#include "core/BitmapRef.hpp"
+
+namespace msdf_atlas {
+/**
+ * Writes an atlas image file incrementally, one horizontal band of rows at a time,
+ * so that the whole image never has to be held in memory at once.
+ * The PNG encoder needs all rows before it can compress them,
+ * so in that case only the 8-bit pixel rows are retained until close.
+ */
+template<typename T, int N> class ImageStreamWriter
+{
+
+public:
+  ImageStreamWriter();
+  ~ImageStreamWriter();
+  /// Creates the output file and writes its header. Fails if the format is not available for T, N
+  bool open(const char *filename,
+    ImageFormat format,
+    int width,
+    int height,
+    YDirection outputYDirection = YDirection::BOTTOM_UP);
+  /// Returns the order in which bands must be written - BOTTOM_UP means ascending Y, TOP_DOWN descending Y
+  YDirection getBandOrder() const;
+  /// Writes a band of full-width rows, which must directly follow the previously written band in band order
+  bool writeBand(const msdfgen::BitmapConstRef<T, N> &band);
+  /// Finishes and closes the file, returns true if the whole image has been written successfully
+  bool close();
+
+private:
+  FILE *file;
+  ImageFormat format;
+  YDirection bandOrder;
+  int width, height;
+  int rowsWritten;
+  int paddedWidth;
+  bool success;
+  std::vector<byte> buffer;
+
+  bool writeRow(const T *row);
+};
+}// namespace msdf_atlas
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <algorithm>
+#include <vector>
 
 #include "atlas/AtlasGenerator.hpp"
+#include "atlas/DirtyRegion.hpp"
+#include "atlas/GlyphBitmapCache.hpp"
+#include "atlas/Workload.hpp"
+#include "atlas/bitmap-blit.hpp"
 
 namespace msdf_atlas {
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage> class ImmediateAtlasGenerator
@@ -13,68 +18,122 @@ public:
   ImmediateAtlasGenerator(int width, int height);
   template<typename... ARGS> ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs);
   void generate(const GlyphGeometry *glyphs, int count);
+  /// Rearranges the last page
   void rearrange(int width, int height, const Remap *remapping, int count);
+  /// Resizes the last page
   void resize(int width, int height);
+  /// Appends a new page to the atlas, glyph boxes refer to pages by their index
+  template<typename... ARGS> void addPage(int width, int height, ARGS... storageArgs);
   /// Sets attributes for the generator function
   void setAttributes(const GeneratorAttributes &attributes);
   /// Sets the number of threads to be run by generate
   void setThreadCount(int threadCount);
-  /// Allows access to the underlying AtlasStorage
+  /// Sets a persistent cache from which generate loads glyph bitmaps instead of generating them, and which it stores
+  /// newly generated bitmaps into. The generator name must identify GEN_FN and stay valid. Null disables the cache
+  void setBitmapCache(GlyphBitmapCache *cache, const char *generatorName);
+  /// Allows access to the underlying AtlasStorage (of the first page)
   const AtlasStorage &atlasStorage() const;
+  AtlasStorage &atlasStorage();
+  /// Allows access to the AtlasStorage of the given page
+  const AtlasStorage &atlasStorage(int page) const;
+  AtlasStorage &atlasStorage(int page);
+  /// Returns the number of pages
+  int getPageCount() const;
   /// Returns the layout of the contained glyphs as a list of GlyphBoxes
   const std::vector<GlyphBox> &getLayout() const;
+  /// Forgets the layout of the contained glyphs, the generated pixels are kept
+  void clearLayout();
+  /// Fills an area of the given page with zeros, e.g. to erase the remains of glyphs that are no longer in use
+  void clearArea(int page, const Rectangle &area);
+  /// Enables tracking of the regions modified by generate, rearrange, resize and addPage
+  void setDirtyRegionTracking(bool enabled);
+  bool isDirtyRegionTracking() const;
+  /// Returns the coalesced list of regions modified since the last call to clearDirtyRegions
+  const std::vector<DirtyRegion> &getDirtyRegions() const;
+  void clearDirtyRegions();
 
 private:
-  AtlasStorage storage;
+  std::vector<AtlasStorage> pages;
   std::vector<GlyphBox> layout;
+  bool trackDirtyRegions;
+  std::vector<DirtyRegion> dirtyRegions;
   std::vector<T> glyphBuffer;
   std::vector<byte> errorCorrectionBuffer;
+  std::vector<msdfgen::GeneratorContext> generatorContexts;
   GeneratorAttributes attributes;
   int threadCount;
+  GlyphBitmapCache *bitmapCache;
+  const char *bitmapCacheGenerator;
+
+  void generateGlyph(const msdfgen::BitmapRef<T, N> &bitmap,
+    const GlyphGeometry &glyph,
+    const GeneratorAttributes &attributes);
 };
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1)
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator()
+  : pages(1), trackDirtyRegions(false), threadCount(1), bitmapCache(nullptr), bitmapCacheGenerator(nullptr)
 {}
 
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height)
-  : storage(width, height), threadCount(1)
-{}
+  : trackDirtyRegions(false), threadCount(1), bitmapCache(nullptr), bitmapCacheGenerator(nullptr)
+{
+  pages.emplace_back(width, height);
+}
 
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 template<typename... ARGS>
 ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs)
-  : storage(width, height, storageArgs...), threadCount(1)
-{}
+  : trackDirtyRegions(false), threadCount(1), bitmapCache(nullptr), bitmapCacheGenerator(nullptr)
+{
+  pages.emplace_back(width, height, storageArgs...);
+}
 
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count)
 {
   int maxBoxArea = 0;
+  bool rotation = false;
   for (int i = 0; i < count; ++i) {
     GlyphBox box = glyphs[i];
     maxBoxArea = std::max(maxBoxArea, box.rect.w * box.rect.h);
+    rotation |= box.rotated;
+    if (trackDirtyRegions && !glyphs[i].isWhitespace() && !glyphs[i].isBoxDuplicate())
+      addDirtyRegion(dirtyRegions, DirtyRegion{ box.page, box.rect });
     layout.push_back((GlyphBox &&)box);
   }
-  int threadBufferSize = N * maxBoxArea;
+  // Rotated glyphs need a second buffer to be rotated into
+  int threadBufferSize = (rotation ? 2 : 1) * N * maxBoxArea;
   if (threadCount * threadBufferSize > (int)glyphBuffer.size()) glyphBuffer.resize(threadCount * threadBufferSize);
   if (threadCount * maxBoxArea > (int)errorCorrectionBuffer.size())
     errorCorrectionBuffer.resize(threadCount * maxBoxArea);
+  if (threadCount > (int)generatorContexts.size()) generatorContexts.resize(threadCount);
   std::vector<GeneratorAttributes> threadAttributes(threadCount);
   for (int i = 0; i < threadCount; ++i) {
     threadAttributes[i] = attributes;
     threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data() + i * maxBoxArea;
+    threadAttributes[i].context = &generatorContexts[i];
   }
 
   Workload(
     [this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
       const GlyphGeometry &glyph = glyphs[i];
-      if (!glyph.isWhitespace()) {
+      // Duplicate glyphs share the box of an identical glyph, which is generated instead
+      if (!glyph.isWhitespace() && !glyph.isBoxDuplicate()) {
         int l, b, w, h;
         glyph.getBoxRect(l, b, w, h);
-        msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data() + threadNo * threadBufferSize, w, h);
-        GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
-        storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+        T *buffer = glyphBuffer.data() + threadNo * threadBufferSize;
+        if (glyph.isBoxRotated()) {
+          msdfgen::BitmapRef<T, N> glyphBitmap(buffer, h, w);
+          generateGlyph(glyphBitmap, glyph, threadAttributes[threadNo]);
+          msdfgen::BitmapRef<T, N> rotatedBitmap(buffer + N * w * h, w, h);
+          blitRotated(rotatedBitmap, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+          pages[glyph.getBoxPage()].put(l, b, msdfgen::BitmapConstRef<T, N>(rotatedBitmap));
+        } else {
+          msdfgen::BitmapRef<T, N> glyphBitmap(buffer, w, h);
+          generateGlyph(glyphBitmap, glyph, threadAttributes[threadNo]);
+          pages[glyph.getBoxPage()].put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
+        }
       }
       return true;
     },
@@ -92,15 +151,28 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::rearrange(int width,
     layout[remapping[i].index].rect.x = remapping[i].target.x;
     layout[remapping[i].index].rect.y = remapping[i].target.y;
   }
-  AtlasStorage newStorage((AtlasStorage &&)storage, width, height, remapping, count);
-  storage = (AtlasStorage &&)newStorage;
+  AtlasStorage newStorage((AtlasStorage &&)pages.back(), width, height, remapping, count);
+  pages.back() = (AtlasStorage &&)newStorage;
+  if (trackDirtyRegions)
+    addDirtyRegion(dirtyRegions, DirtyRegion{ (int)pages.size() - 1, Rectangle{ 0, 0, width, height } });
 }
 
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::resize(int width, int height)
 {
-  AtlasStorage newStorage((AtlasStorage &&)storage, width, height);
-  storage = (AtlasStorage &&)newStorage;
+  AtlasStorage newStorage((AtlasStorage &&)pages.back(), width, height);
+  pages.back() = (AtlasStorage &&)newStorage;
+  if (trackDirtyRegions)
+    addDirtyRegion(dirtyRegions, DirtyRegion{ (int)pages.size() - 1, Rectangle{ 0, 0, width, height } });
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+template<typename... ARGS>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::addPage(int width, int height, ARGS... storageArgs)
+{
+  pages.emplace_back(width, height, storageArgs...);
+  if (trackDirtyRegions)
+    addDirtyRegion(dirtyRegions, DirtyRegion{ (int)pages.size() - 1, Rectangle{ 0, 0, width, height } });
 }
 
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -115,10 +187,42 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadCount(int thr
   this->threadCount = threadCount;
 }
 
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setBitmapCache(GlyphBitmapCache *cache,
+  const char *generatorName)
+{
+  bitmapCache = cache;
+  bitmapCacheGenerator = generatorName;
+}
+
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 const AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const
 {
-  return storage;
+  return pages.front();
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage()
+{
+  return pages.front();
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage(int page) const
+{
+  return pages[page];
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage(int page)
+{
+  return pages[page];
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+int ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getPageCount() const
+{
+  return (int)pages.size();
 }
 
 template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -126,4 +230,59 @@ const std::vector<GlyphBox> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>
 {
   return layout;
 }
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::clearLayout()
+{
+  layout.clear();
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::clearArea(int page, const Rectangle &area)
+{
+  if (area.w <= 0 || area.h <= 0) return;
+  if (N * area.w * area.h > (int)glyphBuffer.size()) glyphBuffer.resize(N * area.w * area.h);
+  std::fill(glyphBuffer.begin(), glyphBuffer.begin() + N * area.w * area.h, T());
+  pages[page].put(area.x, area.y, msdfgen::BitmapConstRef<T, N>(glyphBuffer.data(), area.w, area.h));
+  if (trackDirtyRegions) addDirtyRegion(dirtyRegions, DirtyRegion{ page, area });
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setDirtyRegionTracking(bool enabled)
+{
+  trackDirtyRegions = enabled;
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+bool ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::isDirtyRegionTracking() const
+{
+  return trackDirtyRegions;
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const std::vector<DirtyRegion> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getDirtyRegions() const
+{
+  return dirtyRegions;
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::clearDirtyRegions()
+{
+  dirtyRegions.clear();
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generateGlyph(const msdfgen::BitmapRef<T, N> &bitmap,
+  const GlyphGeometry &glyph,
+  const GeneratorAttributes &attributes)
+{
+  if (bitmapCache) {
+    unsigned long long key = GlyphBitmapCache::getKey(bitmapCacheGenerator, glyph, attributes, N, (int)sizeof(T));
+    if (!bitmapCache->load(key, bitmap)) {
+      GEN_FN(bitmap, glyph, attributes);
+      bitmapCache->store(key, msdfgen::BitmapConstRef<T, N>(bitmap));
+    }
+  } else
+    GEN_FN(bitmap, glyph, attributes);
+}
 }// namespace msdf_atlas
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "atlas/MappedFile.hpp"
+#include "atlas/Remap.hpp"
+#include "atlas/bitmap-blit.hpp"
+#include "core/Bitmap.hpp"
+
+namespace msdf_atlas {
+/**
+ * An atlas storage backed by a memory-mapped file, so the atlas does not have to fit into memory.
+ * The file has the same raw layout as written by saveImageBinary (and saveImageBinaryLE / BE in native byte order),
+ * so once the generator is done, flushing the storage is all that is needed to save the atlas.
+ */
+template<typename T, int N> class MappedAtlasStorage
+{
+
+public:
+  MappedAtlasStorage();
+  MappedAtlasStorage(int width, int height, const char *filename, YDirection yDirection = YDirection::BOTTOM_UP);
+  MappedAtlasStorage(MappedAtlasStorage<T, N> &&orig);
+  /// Resizes the file, in place if neither dimension decreases
+  MappedAtlasStorage(MappedAtlasStorage<T, N> &&orig, int width, int height);
+  /// Resizes the file and rearranges the pixels - the remapped sections are temporarily held in memory
+  MappedAtlasStorage(MappedAtlasStorage<T, N> &&orig, int width, int height, const Remap *remapping, int count);
+  MappedAtlasStorage<T, N> &operator=(MappedAtlasStorage<T, N> &&orig);
+  /// Returns false if the file could not be created or mapped
+  bool isOpen() const;
+  template<typename S> void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap);
+  void get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const;
+  /// Writes the atlas into the file
+  bool flush();
+
+private:
+  MappedFile file;
+  YDirection yDirection;
+  int width, height;
+
+  msdfgen::BitmapRef<T, N> row(int y) const;
+  void relayout(int width, int height);
+  void clear();
+};
+
+template<typename T, int N>
+MappedAtlasStorage<T, N>::MappedAtlasStorage() : yDirection(YDirection::BOTTOM_UP), width(0), height(0)
+{}
+
+template<typename T, int N>
+MappedAtlasStorage<T, N>::MappedAtlasStorage(int width, int height, const char *filename, YDirection yDirection)
+  : yDirection(yDirection), width(width), height(height)
+{
+  if (!file.create(filename, sizeof(T) * N * width * height)) file.close();
+}
+
+template<typename T, int N>
+MappedAtlasStorage<T, N>::MappedAtlasStorage(MappedAtlasStorage<T, N> &&orig)
+  : file((MappedFile &&)orig.file), yDirection(orig.yDirection), width(orig.width), height(orig.height)
+{}
+
+template<typename T, int N>
+MappedAtlasStorage<T, N>::MappedAtlasStorage(MappedAtlasStorage<T, N> &&orig, int width, int height)
+  : MappedAtlasStorage((MappedAtlasStorage<T, N> &&)orig)
+{
+  relayout(width, height);
+}
+
+template<typename T, int N>
+MappedAtlasStorage<T, N>::MappedAtlasStorage(MappedAtlasStorage<T, N> &&orig,
+  int width,
+  int height,
+  const Remap *remapping,
+  int count)
+  : MappedAtlasStorage((MappedAtlasStorage<T, N> &&)orig)
+{
+  std::vector<msdfgen::Bitmap<T, N>> sections(count);
+  for (int i = 0; i < count; ++i) {
+    sections[i] = msdfgen::Bitmap<T, N>(remapping[i].width, remapping[i].height);
+    get(remapping[i].source.x, remapping[i].source.y, sections[i]);
+  }
+  if (file.isOpen() && !file.resize(sizeof(T) * N * width * height)) file.close();
+  this->width = width, this->height = height;
+  clear();
+  for (int i = 0; i < count; ++i)
+    put(remapping[i].target.x, remapping[i].target.y, msdfgen::BitmapConstRef<T, N>(sections[i]));
+}
+
+template<typename T, int N>
+MappedAtlasStorage<T, N> &MappedAtlasStorage<T, N>::operator=(MappedAtlasStorage<T, N> &&orig)
+{
+  file = (MappedFile &&)orig.file;
+  yDirection = orig.yDirection;
+  width = orig.width, height = orig.height;
+  return *this;
+}
+
+template<typename T, int N> bool MappedAtlasStorage<T, N>::isOpen() const { return file.isOpen(); }
+
+template<typename T, int N>
+template<typename S>
+void MappedAtlasStorage<T, N>::put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap)
+{
+  if (!file.data()) return;
+  // Only the part of the box that lies within the atlas is written
+  int sx = std::max(-x, 0), w = std::min(subBitmap.width, width - x) - sx;
+  int rowStart = std::max(-y, 0), rowEnd = std::min(subBitmap.height, height - y);
+  if (w <= 0) return;
+  for (int i = rowStart; i < rowEnd; ++i) {
+    msdfgen::BitmapConstRef<S, N> subRow(subBitmap(0, i), subBitmap.width, 1);
+    blit(row(y + i), subRow, x + sx, 0, sx, 0, w, 1);
+  }
+}
+
+template<typename T, int N>
+void MappedAtlasStorage<T, N>::get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const
+{
+  if (!file.data()) return;
+  int dx = std::max(-x, 0), w = std::min(subBitmap.width, width - x) - dx;
+  int rowStart = std::max(-y, 0), rowEnd = std::min(subBitmap.height, height - y);
+  if (w <= 0) return;
+  for (int i = rowStart; i < rowEnd; ++i) {
+    msdfgen::BitmapRef<T, N> subRow(subBitmap(0, i), subBitmap.width, 1);
+    blit(subRow, row(y + i), dx, 0, x + dx, 0, w, 1);
+  }
+}
+
+template<typename T, int N> bool MappedAtlasStorage<T, N>::flush() { return file.isOpen() && file.flush(); }
+
+template<typename T, int N> msdfgen::BitmapRef<T, N> MappedAtlasStorage<T, N>::row(int y) const
+{
+  int storedRow = yDirection == YDirection::TOP_DOWN ? height - y - 1 : y;
+  return msdfgen::BitmapRef<T, N>((T *)file.data() + (size_t)N * width * storedRow, width, 1);
+}
+
+template<typename T, int N> void MappedAtlasStorage<T, N>::relayout(int width, int height)
+{
+  if (!file.isOpen()) {
+    this->width = width, this->height = height;
+    return;
+  }
+  int oldWidth = this->width, oldHeight = this->height;
+  if (width >= oldWidth && height >= oldHeight) {
+    // Each row moves to a position at or after its original one, so rows can be moved in place, last one first
+    if (!file.resize(sizeof(T) * N * width * height)) {
+      file.close();
+      return;
+    }
+    T *pixels = (T *)file.data();
+    for (int i = 0; i < oldHeight; ++i) {
+      int y = yDirection == YDirection::TOP_DOWN ? i : oldHeight - i - 1;
+      int srcRow = yDirection == YDirection::TOP_DOWN ? oldHeight - y - 1 : y;
+      int dstRow = yDirection == YDirection::TOP_DOWN ? height - y - 1 : y;
+      T *dst = pixels + (size_t)N * width * dstRow;
+      memmove(dst, pixels + (size_t)N * oldWidth * srcRow, sizeof(T) * N * oldWidth);
+      memset(dst + N * oldWidth, 0, sizeof(T) * N * (width - oldWidth));
+    }
+    this->width = width, this->height = height;
+    for (int y = oldHeight; y < height; ++y) memset(row(y).pixels, 0, sizeof(T) * N * width);
+  } else {
+    int w = std::min(width, oldWidth), h = std::min(height, oldHeight);
+    msdfgen::Bitmap<T, N> section(w, h);
+    get(0, 0, section);
+    if (!file.resize(sizeof(T) * N * width * height)) {
+      file.close();
+      return;
+    }
+    this->width = width, this->height = height;
+    clear();
+    put(0, 0, msdfgen::BitmapConstRef<T, N>(section));
+  }
+}
+
+template<typename T, int N> void MappedAtlasStorage<T, N>::clear()
+{
+  if (file.data()) memset(file.data(), 0, file.size());
+}
+}// namespace msdf_atlas
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+
+#include "atlas/types.hpp"
+
+namespace msdf_atlas {
+/// A file whose contents are mapped into memory for reading and writing, or only for reading if opened with open
+class MappedFile
+{
+
+public:
+  MappedFile();
+  MappedFile(MappedFile &&orig);
+  ~MappedFile();
+  MappedFile &operator=(MappedFile &&orig);
+  /// Creates the file (or truncates an existing one) with the given size in bytes and maps it. New contents are zero
+  bool create(const char *filename, size_t size);
+  /// Opens an existing file and maps its contents for reading only. The contents must not be modified
+  bool open(const char *filename);
+  /// Changes the size of the file in bytes and remaps it, the data pointer may change
+  bool resize(size_t size);
+  /// Writes the modified contents back to the file
+  bool flush();
+  /// Unmaps and closes the file
+  void close();
+  /// Returns true if a file is open
+  bool isOpen() const;
+  /// Returns the mapped contents of the file
+  byte *data() const;
+  /// Returns the size of the file in bytes
+  size_t size() const;
+
+private:
+#ifdef _WIN32
+  void *file;
+  void *mapping;
+#else
+  int file;
+#endif
+  byte *pointer;
+  size_t length;
+  bool writable;
+
+  bool map();
+  void unmap();
+};
+}// namespace msdf_atlas
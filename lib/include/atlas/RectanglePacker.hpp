@@ -17,8 +17,13 @@ public:
   /// Packs the rectangle array, returns how many didn't fit (0 on success)
   int pack(Rectangle *rectangles, int count);
   int pack(OrientedRectangle *rectangles, int count);
+  /// Returns the area of a previously packed rectangle to the free space, merging it with adjacent free spaces
+  void release(const Rectangle &rectangle);
+  /// Removes the area of an already placed rectangle from the free space, so that nothing is packed over it
+  void occupy(const Rectangle &rectangle);
 
 private:
+  int width, height;
   std::vector<Rectangle> spaces;
 
   static int rateFit(int w, int h, int sw, int sh);
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+
+#include "atlas/Rectangle.hpp"
+
+namespace msdf_atlas {
+/**
+ * Skyline 2D single bin packer. Rectangles are placed in order of decreasing height at the lowest position
+ * of the skyline (the upper contour of the packed rectangles), so the cost of placing a rectangle only depends
+ * on the number of skyline segments rather than on the number of remaining rectangles and free spaces.
+ * Much faster than RectanglePacker for large rectangle sets at the expense of a slightly lower packing efficiency.
+ */
+class SkylinePacker
+{
+
+public:
+  SkylinePacker();
+  SkylinePacker(int width, int height);
+  /// Expands the packing area - both width and height must be greater or equal to the previous value
+  void expand(int width, int height);
+  /// Packs the rectangle array, returns how many didn't fit (0 on success)
+  int pack(Rectangle *rectangles, int count);
+  int pack(OrientedRectangle *rectangles, int count);
+
+private:
+  struct Segment
+  {
+    int x, y, w;
+  };
+
+  struct Position
+  {
+    int segment;
+    int x, y;
+  };
+
+  int width, height;
+  std::vector<Segment> skyline;
+
+  bool findPosition(Position &position, int w, int h) const;
+  void place(const Position &position, int w, int h);
+};
+}// namespace msdf_atlas
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "atlas/AtlasGenerator.hpp"
+#include "atlas/ImageStreamWriter.hpp"
+#include "atlas/Workload.hpp"
+#include "atlas/bitmap-blit.hpp"
+#include "core/Bitmap.hpp"
+
+namespace msdf_atlas {
+/**
+ * An atlas generator which never holds the complete atlas bitmap in memory.
+ * The atlas is finished in horizontal bands of rows in the order requested by the output,
+ * and each band is passed on as soon as all glyphs that intersect it have been generated.
+ * Only the current band and the glyphs that extend past it are kept in memory.
+ */
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN> class StreamingAtlasGenerator
+{
+
+public:
+  StreamingAtlasGenerator();
+  StreamingAtlasGenerator(int width, int height);
+  /// Generates the atlas from the supplied array of glyphs, which must already be laid out, and writes it into output.
+  /// Only glyphs placed in the specified page are included
+  template<typename S>
+  bool generate(const GlyphGeometry *glyphs, int count, ImageStreamWriter<S, N> &output, int page = 0);
+  /// Sets attributes for the generator function
+  void setAttributes(const GeneratorAttributes &attributes);
+  /// Sets the number of threads to be run by generate
+  void setThreadCount(int threadCount);
+  /// Sets the height of a band in rows. If zero (default), the height of the tallest glyph box is used
+  void setBandHeight(int bandHeight);
+
+private:
+  template<typename S> struct Tile
+  {
+    int index;
+    int l, b, w, h;
+    msdfgen::Bitmap<S, N> bitmap;
+  };
+
+  int width, height;
+  int bandHeight;
+  std::vector<T> glyphBuffer;
+  std::vector<byte> errorCorrectionBuffer;
+  std::vector<msdfgen::GeneratorContext> generatorContexts;
+  GeneratorAttributes attributes;
+  int threadCount;
+};
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN>
+StreamingAtlasGenerator<T, N, GEN_FN>::StreamingAtlasGenerator() : width(0), height(0), bandHeight(0), threadCount(1)
+{}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN>
+StreamingAtlasGenerator<T, N, GEN_FN>::StreamingAtlasGenerator(int width, int height)
+  : width(width), height(height), bandHeight(0), threadCount(1)
+{}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN>
+template<typename S>
+bool StreamingAtlasGenerator<T, N, GEN_FN>::generate(const GlyphGeometry *glyphs,
+  int count,
+  ImageStreamWriter<S, N> &output,
+  int page)
+{
+  bool bottomUp = output.getBandOrder() == YDirection::BOTTOM_UP;
+  std::vector<int> order;
+  order.reserve(count);
+  int maxBoxArea = 0, maxBoxHeight = 1;
+  bool rotation = false;
+  for (int i = 0; i < count; ++i) {
+    if (!glyphs[i].isWhitespace() && !glyphs[i].isBoxDuplicate() && glyphs[i].getBoxPage() == page) {
+      int l, b, w, h;
+      glyphs[i].getBoxRect(l, b, w, h);
+      if (w > 0 && h > 0) {
+        order.push_back(i);
+        maxBoxArea = std::max(maxBoxArea, w * h);
+        maxBoxHeight = std::max(maxBoxHeight, h);
+        rotation |= glyphs[i].isBoxRotated();
+      }
+    }
+  }
+  // Glyphs are generated when the band containing their first row in band order is reached
+  std::stable_sort(order.begin(), order.end(), [glyphs, bottomUp](int a, int b) -> bool {
+    int al, ab, aw, ah, bl, bb, bw, bh;
+    glyphs[a].getBoxRect(al, ab, aw, ah);
+    glyphs[b].getBoxRect(bl, bb, bw, bh);
+    return bottomUp ? ab < bb : ab + ah > bb + bh;
+  });
+
+  // Rotated glyphs need a second buffer to be rotated into
+  int threadBufferSize = (rotation ? 2 : 1) * N * maxBoxArea;
+  if (threadCount * threadBufferSize > (int)glyphBuffer.size()) glyphBuffer.resize(threadCount * threadBufferSize);
+  if (threadCount * maxBoxArea > (int)errorCorrectionBuffer.size())
+    errorCorrectionBuffer.resize(threadCount * maxBoxArea);
+  if (threadCount > (int)generatorContexts.size()) generatorContexts.resize(threadCount);
+  std::vector<GeneratorAttributes> threadAttributes(threadCount);
+  for (int i = 0; i < threadCount; ++i) {
+    threadAttributes[i] = attributes;
+    threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data() + i * maxBoxArea;
+    threadAttributes[i].context = &generatorContexts[i];
+  }
+
+  int rows = bandHeight > 0 ? bandHeight : maxBoxHeight;
+  msdfgen::Bitmap<S, N> band(width, std::min(rows, height));
+  std::vector<Tile<S>> pending, started;
+  size_t next = 0;
+  for (int done = 0; done < height;) {
+    int bandRows = std::min(rows, height - done);
+    int y0 = bottomUp ? done : height - done - bandRows;
+    int y1 = y0 + bandRows;
+
+    // Generate glyphs that start within this band
+    size_t first = next;
+    while (next < order.size()) {
+      int l, b, w, h;
+      glyphs[order[next]].getBoxRect(l, b, w, h);
+      if (bottomUp ? b >= y1 : b + h <= y0) break;
+      ++next;
+    }
+    started.resize(next - first);
+    if (!Workload(
+          [this, glyphs, &order, &started, &threadAttributes, first, threadBufferSize](int i, int threadNo) -> bool {
+            const GlyphGeometry &glyph = glyphs[order[first + i]];
+            Tile<S> &tile = started[i];
+            tile.index = order[first + i];
+            glyph.getBoxRect(tile.l, tile.b, tile.w, tile.h);
+            T *buffer = glyphBuffer.data() + threadNo * threadBufferSize;
+            msdfgen::BitmapRef<T, N> glyphBitmap(buffer, tile.w, tile.h);
+            if (glyph.isBoxRotated()) {
+              msdfgen::BitmapRef<T, N> unrotatedBitmap(buffer + N * tile.w * tile.h, tile.h, tile.w);
+              GEN_FN(unrotatedBitmap, glyph, threadAttributes[threadNo]);
+              blitRotated(glyphBitmap, msdfgen::BitmapConstRef<T, N>(unrotatedBitmap));
+            } else
+              GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
+            tile.bitmap = msdfgen::Bitmap<S, N>(tile.w, tile.h);
+            blit(tile.bitmap, glyphBitmap, 0, 0, 0, 0, tile.w, tile.h);
+            return true;
+          },
+          (int)started.size())
+           .finish(threadCount))
+      return false;
+    for (Tile<S> &tile : started) pending.push_back((Tile<S> &&)tile);
+    // Where glyph boxes overlap, later glyphs are drawn over earlier ones as in ImmediateAtlasGenerator
+    std::sort(pending.begin(), pending.end(), [](const Tile<S> &a, const Tile<S> &b) -> bool {
+      return a.index < b.index;
+    });
+
+    // Compose the band and drop glyphs which have been fully written
+    msdfgen::BitmapRef<S, N> bandBitmap((S *)band, width, bandRows);
+    memset(bandBitmap.pixels, 0, sizeof(S) * N * width * bandRows);
+    size_t kept = 0;
+    for (size_t i = 0; i < pending.size(); ++i) {
+      Tile<S> &tile = pending[i];
+      int from = std::max(tile.b, y0), to = std::min(tile.b + tile.h, y1);
+      if (from < to) blit(bandBitmap, tile.bitmap, tile.l, from - y0, 0, from - tile.b, tile.w, to - from);
+      if (bottomUp ? tile.b + tile.h > y1 : tile.b < y0) {
+        if (kept != i) pending[kept] = (Tile<S> &&)tile;
+        ++kept;
+      }
+    }
+    pending.resize(kept);
+
+    if (!output.writeBand(bandBitmap)) return false;
+    done += bandRows;
+  }
+  return true;
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN>
+void StreamingAtlasGenerator<T, N, GEN_FN>::setAttributes(const GeneratorAttributes &attributes)
+{
+  this->attributes = attributes;
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN>
+void StreamingAtlasGenerator<T, N, GEN_FN>::setThreadCount(int threadCount)
+{
+  this->threadCount = threadCount;
+}
+
+template<typename T, int N, GeneratorFunction<T, N> GEN_FN>
+void StreamingAtlasGenerator<T, N, GEN_FN>::setBandHeight(int bandHeight)
+{
+  this->bandHeight = bandHeight;
+}
+}// namespace msdf_atlas
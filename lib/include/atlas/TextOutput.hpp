@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+namespace msdf_atlas {
+/**
+ * Buffered text writer with locale-independent number formatting.
+ * Without a file, all text is kept in memory. With a file, the buffer is written into it in large blocks.
+ */
+class TextOutput
+{
+
+public:
+  /// Writes into memory only
+  TextOutput();
+  /// Writes into an open file, which must be finished by calling flush
+  explicit TextOutput(FILE *file);
+  void write(char c);
+  void write(const char *str);
+  void write(const char *str, size_t length);
+  void write(const std::string &str);
+  /// Appends the buffered text of another output
+  void write(const TextOutput &output);
+  void writeInt(int value);
+  void writeUnsigned(unsigned value);
+  /// Writes the shortest decimal representation of the value that reads back exactly
+  void writeDouble(double value);
+  /// Writes the buffered text into the file, returns false if any write has failed
+  bool flush();
+  /// Returns the buffered text (all of it in memory mode)
+  const std::string &getBuffer() const;
+  /// Moves the buffered text into output
+  void takeBuffer(std::string &output);
+
+private:
+  FILE *file;
+  std::string buffer;
+  bool failed;
+
+  void flushIfFull();
+};
+}// namespace msdf_atlas
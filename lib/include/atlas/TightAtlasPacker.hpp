@@ -1,6 +1,9 @@
 #pragma once
 
+#include <vector>
+
 #include "atlas/GlyphGeometry.hpp"
+#include "atlas/Rectangle.hpp"
 #include "atlas/types.hpp"
 
 namespace msdf_atlas {
@@ -20,8 +23,17 @@ public:
   void setDimensions(int width, int height);
   /// Sets the atlas's dimensions to be determined during pack
   void unsetDimensions();
+  /// Sets the maximum dimensions of a page - glyphs that do not fit into a single page spill into additional pages
+  void setMaximumPageDimensions(int width, int height);
   /// Sets the constraint to be used when determining dimensions
   void setDimensionsConstraint(DimensionsConstraint dimensionsConstraint);
+  /// Sets the rectangle packing algorithm
+  void setPackingAlgorithm(PackingAlgorithm packingAlgorithm);
+  /// Sets whether glyph boxes may be rotated by 90 degrees in the atlas to pack them more densely.
+  /// Rotated glyphs are reported by GlyphGeometry::isBoxRotated and must be accounted for when rendering
+  void setRotationAllowed(bool allowRotation);
+  /// Sets whether glyphs with identical geometry should share a single box (see GlyphGeometry::isBoxDuplicate)
+  void setDeduplication(bool deduplication);
   /// Sets the spacing between glyph boxes
   void setSpacing(int spacing);
   /// Sets fixed glyph scale
@@ -37,9 +49,13 @@ public:
   /// Sets whether each glyph's origin point should stay aligned with the pixel grid
   void setOriginPixelAlignment(bool align);
   void setOriginPixelAlignment(bool alignX, bool alignY);
+  /// Sets the number of threads used to evaluate multiple scales concurrently while maximizing the scale
+  void setThreadCount(int threadCount);
 
   /// Outputs the atlas's final dimensions
   void getDimensions(int &width, int &height) const;
+  /// Returns the number of pages of the final atlas, each having the final dimensions
+  int getPageCount() const;
   /// Returns the final glyph scale
   double getScale() const;
   /// Returns the final combined pixel range (including converted unit range)
@@ -47,8 +63,13 @@ public:
 
 private:
   int width, height;
+  int maxPageWidth, maxPageHeight;
+  int pageCount;
   int spacing;
   DimensionsConstraint dimensionsConstraint;
+  PackingAlgorithm packingAlgorithm;
+  bool rotationAllowed;
+  bool deduplication;
   double scale;
   double minScale;
   double unitRange;
@@ -56,13 +77,41 @@ private:
   double miterLimit;
   bool pxAlignOriginX, pxAlignOriginY;
   double scaleMaximizationTolerance;
+  int threadCount;
+  /// For each glyph being packed, the index of the first glyph with identical geometry (empty if there are none)
+  std::vector<int> originals;
 
+  bool isDuplicate(int index) const;
+  template<class Packer, typename RectangleType> int packGlyphs(GlyphGeometry *glyphs, int count);
+  template<class Packer, typename RectangleType>
   int tryPack(GlyphGeometry *glyphs,
     int count,
     DimensionsConstraint dimensionsConstraint,
     int &width,
     int &height,
-    double scale) const;
-  double packAndScale(GlyphGeometry *glyphs, int count) const;
+    double scale,
+    int &pageCount,
+    int maxPages) const;
+  template<class Packer, typename RectangleType>
+  int packBoxes(RectangleType *rectangles,
+    int *pages,
+    int count,
+    long long totalArea,
+    DimensionsConstraint dimensionsConstraint,
+    int &width,
+    int &height,
+    int &pageCount,
+    int maxPages) const;
+  template<class Packer, typename RectangleType>
+  bool tryScale(const GlyphGeometry *glyphs,
+    int count,
+    int width,
+    int height,
+    double scale,
+    int maxPages,
+    std::vector<RectangleType> &rectangles,
+    std::vector<int> &pages) const;
+  template<class Packer, typename RectangleType>
+  double packAndScale(GlyphGeometry *glyphs, int count, int &pageCount) const;
 };
 }// namespace msdf_atlas
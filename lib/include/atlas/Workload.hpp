@@ -8,7 +8,10 @@ namespace msdf_atlas {
  * The worker function:
  *     bool FN(int chunk, int threadNo);
  * should process the given chunk (out of chunks) and return true.
- * If false is returned, the process is interrupted.
+ * If false is returned, the process is interrupted. The same happens if it throws an exception,
+ * which is then rethrown by finish in the calling thread once no other thread is running the workload anymore.
+ * The calling thread processes chunks as well, helped by the threads of a pool that is shared by all workloads
+ * of the process, so the threads are reused instead of being started for each workload.
  */
 class Workload
 {
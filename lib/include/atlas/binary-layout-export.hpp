@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+
+#include "atlas/FontGeometry.hpp"
+#include "atlas/json-export.hpp"
+#include "atlas/types.hpp"
+
+namespace msdf_atlas {
+/**
+ * Writes the same font and glyph metrics and atlas layout data as exportJSON into a compact binary file,
+ * which can be read without parsing by BinaryLayout (see BinaryLayout.hpp for the format)
+ */
+bool exportBinaryLayout(const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  const char *filename,
+  bool kerning);
+/// Writes the same binary layout data as above into output
+void exportBinaryLayout(std::vector<byte> &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  bool kerning);
+}// namespace msdf_atlas
@@ -84,4 +84,21 @@ void blit(const msdfgen::BitmapRef<byte, 4> &dst,
   int sy,
   int w,
   int h);
+
+/*
+ * Copies the source bitmap into the destination bitmap rotated by 90 degrees counter-clockwise,
+ * i.e. source pixel (x, y) is moved to (src.height-1-y, x). Destination must have transposed dimensions!
+ */
+
+template<typename T, int N>
+void blitRotated(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<T, N> &src)
+{
+  for (int y = 0; y < src.height; ++y) {
+    for (int x = 0; x < src.width; ++x) {
+      const T *srcPixel = src(x, y);
+      T *dstPixel = dst(src.height - 1 - y, x);
+      for (int i = 0; i < N; ++i) dstPixel[i] = srcPixel[i];
+    }
+  }
+}
 }// namespace msdf_atlas
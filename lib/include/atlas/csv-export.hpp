@@ -1,17 +1,34 @@
 #pragma once
 
+#include <string>
+
 #include "atlas/FontGeometry.hpp"
 
 namespace msdf_atlas {
 /**
  * Writes the positioning data and atlas layout of the glyphs into a CSV file
  * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance,
- * plane bounds (l, b, r, t), atlas bounds (l, b, r, t)
+ * plane bounds (l, b, r, t), atlas page index (if pageCount > 1), atlas bounds (l, b, r, t),
+ * rotated flag - 1 if the glyph's box is rotated in the atlas, otherwise 0 (if rotation is enabled)
+ * With multiple fonts, their rows can be formatted by multiple threads
  */
 bool exportCSV(const FontGeometry *fonts,
   int fontCount,
   int atlasWidth,
   int atlasHeight,
   YDirection yDirection,
-  const char *filename);
+  const char *filename,
+  int pageCount = 1,
+  bool rotation = false,
+  int threadCount = 1);
+/// Writes the same CSV as above into the output string
+void exportCSV(std::string &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  int atlasWidth,
+  int atlasHeight,
+  YDirection yDirection,
+  int pageCount = 1,
+  bool rotation = false,
+  int threadCount = 1);
 }// namespace msdf_atlas
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+#include "atlas/FontGeometry.hpp"
+
+namespace msdf_atlas {
+/**
+ * Saves the loaded geometry of the fonts - glyph shapes including their edge colors, glyph and font metrics,
+ * kerning pairs and font names - into a compact binary file in native byte order, which can be memory-mapped by
+ * loadGeometry to skip font loading, shape preprocessing and, if colored is true, edge coloring.
+ * Glyph boxes are not saved.
+ */
+bool saveGeometry(const FontGeometry *fonts, int fontCount, bool colored, const char *filename);
+/**
+ * Loads the fonts saved by saveGeometry and appends them to the fonts vector, their glyphs are appended to
+ * glyphStorage. Outputs whether the glyph shapes have been edge colored. On failure, nothing is appended.
+ */
+bool loadGeometry(std::vector<FontGeometry> &fonts,
+  std::vector<GlyphGeometry> &glyphStorage,
+  bool &colored,
+  const char *filename);
+}// namespace msdf_atlas
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <vector>
+
+#include "atlas/GlyphGeometry.hpp"
+
+namespace msdf_atlas {
+/// Finds non-whitespace glyphs with the same geometry scale and shape geometry, whose boxes therefore have identical
+/// dimensions and contents when wrapped with the same parameters. For each glyph, outputs the index of the first such
+/// glyph (its own index if there is none before it). Returns the number of duplicate glyphs
+int findDuplicateGlyphs(std::vector<int> &originals, const GlyphGeometry *glyphs, int count);
+}// namespace msdf_atlas
@@ -1,13 +1,17 @@
 #pragma once
 
+#include <cstdio>
+#include <cstring>
 #include <vector>
 
 #include "atlas/types.hpp"
 #include "core/BitmapRef.hpp"
 #include "core/base.hpp"
+#include "core/save-bmp.hpp"
+#include "core/save-tiff.hpp"
 
 namespace msdf_atlas {
-// Functions to encode an image as a sequence of bytes in memory
+// Functions to encode an image as a sequence of bytes in memory, the encoded image is appended to output
 
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap);
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap);
@@ -15,4 +19,185 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen:
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap);
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap);
 bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap);
+
+/// Encodes the image in the same format as saveImage would write into a file
+template<typename T, int N>
+bool encodeImage(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<T, N> &bitmap,
+  ImageFormat format,
+  YDirection outputYDirection = YDirection::BOTTOM_UP);
+template<int N>
+bool encodeImageBinary(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<byte, N> &bitmap,
+  YDirection outputYDirection);
+template<int N>
+bool encodeImageBinaryLE(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<float, N> &bitmap,
+  YDirection outputYDirection);
+template<int N>
+bool encodeImageBinaryBE(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<float, N> &bitmap,
+  YDirection outputYDirection);
+
+template<int N>
+bool encodeImageText(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<byte, N> &bitmap,
+  YDirection outputYDirection);
+template<int N>
+bool encodeImageText(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<float, N> &bitmap,
+  YDirection outputYDirection);
+
+template<int N>
+bool encodeImage(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<byte, N> &bitmap,
+  ImageFormat format,
+  YDirection outputYDirection)
+{
+  switch (format) {
+  case ImageFormat::PNG:
+    return encodePng(output, bitmap);
+  case ImageFormat::BMP:
+    return msdfgen::encodeBmp(output, bitmap);
+  case ImageFormat::TIFF:
+    return false;
+  case ImageFormat::TEXT:
+    return encodeImageText(output, bitmap, outputYDirection);
+  case ImageFormat::TEXT_FLOAT:
+    return false;
+  case ImageFormat::BINARY:
+    return encodeImageBinary(output, bitmap, outputYDirection);
+  case ImageFormat::BINARY_FLOAT:
+  case ImageFormat::BINARY_FLOAT_BE:
+    return false;
+  default:;
+  }
+  return false;
+}
+
+template<int N>
+bool encodeImage(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<float, N> &bitmap,
+  ImageFormat format,
+  YDirection outputYDirection)
+{
+  switch (format) {
+  case ImageFormat::PNG:
+    return encodePng(output, bitmap);
+  case ImageFormat::BMP:
+    return msdfgen::encodeBmp(output, bitmap);
+  case ImageFormat::TIFF:
+    return msdfgen::encodeTiff(output, bitmap);
+  case ImageFormat::TEXT:
+    return false;
+  case ImageFormat::TEXT_FLOAT:
+    return encodeImageText(output, bitmap, outputYDirection);
+  case ImageFormat::BINARY:
+    return false;
+  case ImageFormat::BINARY_FLOAT:
+    return encodeImageBinaryLE(output, bitmap, outputYDirection);
+  case ImageFormat::BINARY_FLOAT_BE:
+    return encodeImageBinaryBE(output, bitmap, outputYDirection);
+  default:;
+  }
+  return false;
+}
+
+template<int N>
+bool encodeImageBinary(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<byte, N> &bitmap,
+  YDirection outputYDirection)
+{
+  size_t rowSize = (size_t)N * bitmap.width;
+  output.reserve(output.size() + rowSize * bitmap.height);
+  for (int y = 0; y < bitmap.height; ++y) {
+    const byte *row =
+      bitmap.pixels + rowSize * (outputYDirection == YDirection::TOP_DOWN ? bitmap.height - y - 1 : y);
+    output.insert(output.end(), row, row + rowSize);
+  }
+  return true;
+}
+
+template <int N>
+bool
+#ifdef __BIG_ENDIAN__
+        encodeImageBinaryBE
+#else
+        encodeImageBinaryLE
+#endif
+        (std::vector<byte> &output, const msdfgen::BitmapConstRef<float, N> &bitmap, YDirection outputYDirection)
+{
+  size_t rowSize = sizeof(float) * N * bitmap.width;
+  output.reserve(output.size() + rowSize * bitmap.height);
+  for (int y = 0; y < bitmap.height; ++y) {
+    const float *p =
+      bitmap.pixels
+      + (size_t)N * bitmap.width * (outputYDirection == YDirection::TOP_DOWN ? bitmap.height - y - 1 : y);
+    const byte *row = reinterpret_cast<const byte *>(p);
+    output.insert(output.end(), row, row + rowSize);
+  }
+  return true;
+}
+
+template <int N>
+bool
+#ifdef __BIG_ENDIAN__
+        encodeImageBinaryLE
+#else
+        encodeImageBinaryBE
+#endif
+        (std::vector<byte> &output, const msdfgen::BitmapConstRef<float, N> &bitmap, YDirection outputYDirection)
+{
+  output.reserve(output.size() + sizeof(float) * N * bitmap.width * bitmap.height);
+  for (int y = 0; y < bitmap.height; ++y) {
+    const float *p =
+      bitmap.pixels
+      + (size_t)N * bitmap.width * (outputYDirection == YDirection::TOP_DOWN ? bitmap.height - y - 1 : y);
+    for (int x = 0; x < N * bitmap.width; ++x) {
+      const byte *b = reinterpret_cast<const byte *>(p++);
+      for (int i = sizeof(float) - 1; i >= 0; --i) output.push_back(b[i]);
+    }
+  }
+  return true;
+}
+
+template<int N>
+bool encodeImageText(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<byte, N> &bitmap,
+  YDirection outputYDirection)
+{
+  static const char hexDigits[] = "0123456789ABCDEF";
+  for (int y = 0; y < bitmap.height; ++y) {
+    const byte *p =
+      bitmap.pixels
+      + (size_t)N * bitmap.width * (outputYDirection == YDirection::TOP_DOWN ? bitmap.height - y - 1 : y);
+    for (int x = 0; x < N * bitmap.width; ++x, ++p) {
+      if (x) output.push_back(' ');
+      output.push_back(hexDigits[*p >> 4]);
+      output.push_back(hexDigits[*p & 0x0f]);
+    }
+    output.push_back('\n');
+  }
+  return true;
+}
+
+template<int N>
+bool encodeImageText(std::vector<byte> &output,
+  const msdfgen::BitmapConstRef<float, N> &bitmap,
+  YDirection outputYDirection)
+{
+  char str[32];
+  for (int y = 0; y < bitmap.height; ++y) {
+    const float *p =
+      bitmap.pixels
+      + (size_t)N * bitmap.width * (outputYDirection == YDirection::TOP_DOWN ? bitmap.height - y - 1 : y);
+    for (int x = 0; x < N * bitmap.width; ++x) {
+      int length = snprintf(str, sizeof(str), x ? " %g" : "%g", *p++);
+      if (length <= 0) return false;
+      output.insert(output.end(), str, str + length);
+    }
+    output.push_back('\n');
+  }
+  return true;
+}
 }// namespace msdf_atlas
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "atlas/FontGeometry.hpp"
 #include "atlas/types.hpp"
 
@@ -16,15 +18,26 @@ struct JsonAtlasMetrics
   double distanceRange;
   double size;
   int width, height;
+  int pageCount;
   YDirection yDirection;
   const GridMetrics *grid;
 };
 
 /// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file
+/// With multiple fonts, their data can be formatted by multiple threads
 bool exportJSON(const FontGeometry *fonts,
   int fontCount,
   ImageType imageType,
   const JsonAtlasMetrics &metrics,
   const char *filename,
-  bool kerning);
+  bool kerning,
+  int threadCount = 1);
+/// Writes the same JSON as above into the output string
+void exportJSON(std::string &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  bool kerning,
+  int threadCount = 1);
 }// namespace msdf_atlas
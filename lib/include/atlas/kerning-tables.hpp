@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "atlas/types.hpp"
+
+namespace msdf_atlas {
+/**
+ * Reads the kerning pairs (by glyph indices) of a raw 'kern' table in the same way as FreeType's FT_Get_Kerning,
+ * i.e. only the horizontal format 0 subtables are used and their values are added or override each other.
+ * Only pairs whose glyphs are both flagged in glyphMask are output. The values are in font units and may be zero.
+ * Returns false if the table is malformed.
+ */
+bool readKernTable(std::map<std::pair<int, int>, int> &pairs,
+  const byte *data,
+  size_t length,
+  const std::vector<bool> &glyphMask);
+/**
+ * Reads the horizontal advance adjustments of the pair adjustment lookups (formats 1 and 2, also wrapped in extension
+ * lookups) of the 'kern' feature of a raw 'GPOS' table. Within a lookup, the first subtable covering a pair takes
+ * precedence and the values of separate lookups are added, regardless of script and language.
+ * Only pairs whose glyphs are both flagged in glyphMask are output. The values are in font units and may be zero.
+ * Returns false if the table is malformed or of an unsupported version.
+ */
+bool readGposKerning(std::map<std::pair<int, int>, int> &pairs,
+  const byte *data,
+  size_t length,
+  const std::vector<bool> &glyphMask);
+}// namespace msdf_atlas
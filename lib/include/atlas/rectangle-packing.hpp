@@ -1,18 +1,34 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 
 #include "atlas/RectanglePacker.hpp"
+#include "atlas/SkylinePacker.hpp"
 
 namespace msdf_atlas {
-template<typename RectangleType>
+// The Packer template argument selects the packing algorithm - RectanglePacker or SkylinePacker
+
+template<class Packer = RectanglePacker, typename RectangleType>
 int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing = 0);
 
 /// Packs the rectangle array into an atlas of unknown size, returns the minimum required dimensions constrained by
 /// SizeSelector
-template<class SizeSelector, typename RectangleType>
+template<class SizeSelector, class Packer = RectanglePacker, typename RectangleType>
 std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing = 0);
 
+/// Packs the rectangle array into as many pages of fixed dimensions as needed (at most maxPages if positive),
+/// outputs the page index of each rectangle and the number of pages used, returns how many didn't fit (0 on success)
+template<class Packer = RectanglePacker, typename RectangleType>
+int packRectanglePages(RectangleType *rectangles,
+  int *pages,
+  int count,
+  int width,
+  int height,
+  int &pageCount,
+  int spacing = 0,
+  int maxPages = 0);
+
 static void copyRectanglePlacement(Rectangle &dst, const Rectangle &src)
 {
   dst.x = src.x;
@@ -26,7 +42,21 @@ static void copyRectanglePlacement(OrientedRectangle &dst, const OrientedRectang
   dst.rotated = src.rotated;
 }
 
-template<typename RectangleType>
+static void boundRectangleDimensions(int &minWidth, int &minHeight, const Rectangle &rect)
+{
+  minWidth = std::max(minWidth, rect.w);
+  minHeight = std::max(minHeight, rect.h);
+}
+
+static void boundRectangleDimensions(int &minWidth, int &minHeight, const OrientedRectangle &rect)
+{
+  // The rectangle may be rotated, so only its shorter side constrains both dimensions
+  int minSide = std::min(rect.w, rect.h);
+  minWidth = std::max(minWidth, minSide);
+  minHeight = std::max(minHeight, minSide);
+}
+
+template<class Packer, typename RectangleType>
 int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing)
 {
   if (spacing)
@@ -34,7 +64,7 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
       rectangles[i].w += spacing;
       rectangles[i].h += spacing;
     }
-  int result = RectanglePacker(width + spacing, height + spacing).pack(rectangles, count);
+  int result = Packer(width + spacing, height + spacing).pack(rectangles, count);
   if (spacing)
     for (int i = 0; i < count; ++i) {
       rectangles[i].w -= spacing;
@@ -43,21 +73,27 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
   return result;
 }
 
-template<class SizeSelector, typename RectangleType>
+template<class SizeSelector, class Packer, typename RectangleType>
 std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing)
 {
   std::vector<RectangleType> rectanglesCopy(count);
   int totalArea = 0;
+  long long spacedArea = 0;
+  int minWidth = 0, minHeight = 0;
   for (int i = 0; i < count; ++i) {
     rectanglesCopy[i].w = rectangles[i].w + spacing;
     rectanglesCopy[i].h = rectangles[i].h + spacing;
     totalArea += rectangles[i].w * rectangles[i].h;
+    spacedArea += (long long)rectanglesCopy[i].w * rectanglesCopy[i].h;
+    boundRectangleDimensions(minWidth, minHeight, rectangles[i]);
   }
   std::pair<int, int> dimensions;
-  SizeSelector sizeSelector(totalArea);
+  SizeSelector sizeSelector(totalArea, minWidth, minHeight);
   int width, height;
   while (sizeSelector(width, height)) {
-    if (!RectanglePacker(width + spacing, height + spacing).pack(rectanglesCopy.data(), count)) {
+    // Dimensions too small for the total area (including spacing) are rejected without packing
+    if ((long long)(width + spacing) * (height + spacing) >= spacedArea
+        && !Packer(width + spacing, height + spacing).pack(rectanglesCopy.data(), count)) {
       dimensions.first = width;
       dimensions.second = height;
       for (int i = 0; i < count; ++i) copyRectanglePlacement(rectangles[i], rectanglesCopy[i]);
@@ -67,4 +103,46 @@ std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spa
   }
   return dimensions;
 }
+
+template<class Packer, typename RectangleType>
+int packRectanglePages(RectangleType *rectangles,
+  int *pages,
+  int count,
+  int width,
+  int height,
+  int &pageCount,
+  int spacing,
+  int maxPages)
+{
+  std::vector<int> remaining(count);
+  for (int i = 0; i < count; ++i) {
+    remaining[i] = i;
+    pages[i] = -1;
+  }
+  std::vector<RectangleType> pageRectangles;
+  pageCount = 0;
+  while (!remaining.empty() && (maxPages <= 0 || pageCount < maxPages)) {
+    pageRectangles.resize(remaining.size());
+    for (size_t i = 0; i < remaining.size(); ++i) {
+      pageRectangles[i] = rectangles[remaining[i]];
+      pageRectangles[i].x = -1;
+      pageRectangles[i].w += spacing;
+      pageRectangles[i].h += spacing;
+    }
+    Packer(width + spacing, height + spacing).pack(pageRectangles.data(), (int)pageRectangles.size());
+    size_t kept = 0;
+    for (size_t i = 0; i < remaining.size(); ++i) {
+      if (pageRectangles[i].x >= 0) {
+        copyRectanglePlacement(rectangles[remaining[i]], pageRectangles[i]);
+        pages[remaining[i]] = pageCount;
+      } else
+        remaining[kept++] = remaining[i];
+    }
+    // Stop if not even an empty page could take any of the remaining rectangles
+    if (kept == remaining.size()) break;
+    remaining.resize(kept);
+    ++pageCount;
+  }
+  return (int)remaining.size();
+}
 }// namespace msdf_atlas
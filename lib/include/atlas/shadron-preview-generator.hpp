@@ -1,5 +1,7 @@
 #pragma once
 
+#include <string>
+
 #include "atlas/FontGeometry.hpp"
 #include "atlas/types.hpp"
 
@@ -15,4 +17,15 @@ bool generateShadronPreview(const FontGeometry *fonts,
   const char *imageFilename,
   bool fullRange,
   const char *outputFilename);
+/// Generates the same Shadron script into output, imagePath is referenced as is (relative to the script's location)
+bool generateShadronPreview(std::string &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  ImageType atlasType,
+  int atlasWidth,
+  int atlasHeight,
+  double pxRange,
+  const unicode_t *text,
+  const char *imagePath,
+  bool fullRange);
 }// namespace msdf_atlas
@@ -2,12 +2,14 @@
 
 namespace msdf_atlas {
 // The size selector classes are used to select the minimum dimensions of the atlas fitting a given constraint.
+// The search starts from the minimum area and the minimum dimensions (e.g. of the largest box), since anything smaller
+// cannot possibly fit.
 
 /// Selects square dimensions which are also a multiple of MULTIPLE
 template<int MULTIPLE = 1> class SquareSizeSelector
 {
 public:
-  explicit SquareSizeSelector(int minArea = 0);
+  explicit SquareSizeSelector(int minArea = 0, int minWidth = 0, int minHeight = 0);
   bool operator()(int &width, int &height) const;
   SquareSizeSelector<MULTIPLE> &operator++();
   SquareSizeSelector<MULTIPLE> &operator--();
@@ -23,7 +25,7 @@ private:
 class SquarePowerOfTwoSizeSelector
 {
 public:
-  explicit SquarePowerOfTwoSizeSelector(int minArea = 0);
+  explicit SquarePowerOfTwoSizeSelector(int minArea = 0, int minWidth = 0, int minHeight = 0);
   bool operator()(int &width, int &height) const;
   SquarePowerOfTwoSizeSelector &operator++();
   SquarePowerOfTwoSizeSelector &operator--();
@@ -36,7 +38,7 @@ private:
 class PowerOfTwoSizeSelector
 {
 public:
-  explicit PowerOfTwoSizeSelector(int minArea = 0);
+  explicit PowerOfTwoSizeSelector(int minArea = 0, int minWidth = 0, int minHeight = 0);
   bool operator()(int &width, int &height) const;
   PowerOfTwoSizeSelector &operator++();
   PowerOfTwoSizeSelector &operator--();
@@ -34,6 +34,14 @@ enum class YDirection { BOTTOM_UP, TOP_DOWN };
 /// The method of computing the layout of the atlas
 enum class PackingStyle { TIGHT, GRID };
 
+/// The rectangle packing algorithm of the tight layout
+enum class PackingAlgorithm {
+  /// Guillotine packer (RectanglePacker) - best packing efficiency, slow for large numbers of glyphs
+  GUILLOTINE,
+  /// Skyline packer (SkylinePacker) - much faster for large numbers of glyphs
+  SKYLINE
+};
+
 /// Constraints for the atlas's dimensions - see size selectors for more info
 enum class DimensionsConstraint {
   NONE,
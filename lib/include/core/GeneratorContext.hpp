@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include "core/BitmapRef.hpp"
+#include "core/Projection.hpp"
+#include "core/Scanline.hpp"
+#include "core/Shape.hpp"
+#include "core/ShapeDistanceFinder.hpp"
+#include "core/contour-combiners.hpp"
+#include "core/edge-selectors.hpp"
+#include "core/generator-config.hpp"
+
+namespace msdfgen {
+/// Owns the working memory needed to generate distance fields of one shape at a time. The memory only ever grows,
+/// so once it has reached the size of the largest shape and bitmap, generation does not allocate any more.
+/// The free functions in msdfgen.hpp, msdf-error-correction.hpp and rasterization.hpp use a temporary context.
+/// Not thread-safe, each thread needs its own context.
+class GeneratorContext
+{
+
+public:
+  GeneratorContext();
+
+  /// Generates a conventional single-channel signed distance field.
+  void generateSDF(const BitmapRef<float, 1> &output,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const GeneratorConfig &config = GeneratorConfig());
+  /// Generates a single-channel signed perpendicular distance field.
+  void generatePSDF(const BitmapRef<float, 1> &output,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const GeneratorConfig &config = GeneratorConfig());
+  /// Generates a multi-channel signed distance field. Edge colors must be assigned first!
+  void generateMSDF(const BitmapRef<float, 3> &output,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+  /// Generates a multi-channel signed distance field with true distance in the alpha channel.
+  void generateMTSDF(const BitmapRef<float, 4> &output,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+
+  /// Performs the MSDF error correction, using the context's stencil unless config.errorCorrection.buffer is set.
+  void msdfErrorCorrection(const BitmapRef<float, 3> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+  void msdfErrorCorrection(const BitmapRef<float, 4> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const MSDFGeneratorConfig &config = MSDFGeneratorConfig());
+
+  /// Rasterizes the shape into a monochrome bitmap.
+  void rasterize(const BitmapRef<float, 1> &output,
+    const Shape &shape,
+    const Projection &projection,
+    FillRule fillRule = FILL_NONZERO);
+  /// Fixes the sign of the input signed distance field, so that it matches the shape's rasterized fill.
+  void distanceSignCorrection(const BitmapRef<float, 1> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    FillRule fillRule = FILL_NONZERO);
+  void distanceSignCorrection(const BitmapRef<float, 3> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    FillRule fillRule = FILL_NONZERO);
+  void distanceSignCorrection(const BitmapRef<float, 4> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    FillRule fillRule = FILL_NONZERO);
+
+private:
+  template<template<typename> class ContourCombiner> struct DistanceFinders
+  {
+    ShapeDistanceFinder<ContourCombiner<TrueDistanceSelector>> trueDistance;
+    ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> perpendicularDistance;
+    ShapeDistanceFinder<ContourCombiner<MultiDistanceSelector>> multiDistance;
+    ShapeDistanceFinder<ContourCombiner<MultiAndTrueDistanceSelector>> multiAndTrueDistance;
+  };
+
+  DistanceFinders<SimpleContourCombiner> simpleFinders;
+  DistanceFinders<OverlappingContourCombiner> overlappingFinders;
+  std::vector<byte> stencil;
+  Scanline scanline;
+  std::vector<Scanline::Intersection> intersections;
+  std::vector<char> signMatches;
+
+  template<int N>
+  void msdfErrorCorrectionInner(const BitmapRef<float, N> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    double range,
+    const MSDFGeneratorConfig &config);
+  template<int N>
+  void multiDistanceSignCorrection(const BitmapRef<float, N> &sdf,
+    const Shape &shape,
+    const Projection &projection,
+    FillRule fillRule);
+};
+}// namespace msdfgen
@@ -3,6 +3,7 @@
 #include "core/BitmapRef.hpp"
 #include "core/Projection.hpp"
 #include "core/Shape.hpp"
+#include "core/ShapeDistanceFinder.hpp"
 #include "core/base.hpp"
 
 namespace msdfgen {
@@ -37,6 +38,11 @@ public:
   /// the exact shape distance.
   template<template<typename> class ContourCombiner, int N>
   void findErrors(const BitmapConstRef<float, N> &sdf, const Shape &shape);
+  /// Same as above, but evaluates the shape distance with distanceFinder, which must be set to the same shape.
+  template<template<typename> class ContourCombiner, int N>
+  void findErrors(const BitmapConstRef<float, N> &sdf,
+    const Shape &shape,
+    ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> &distanceFinder);
   /// Modifies the MSDF so that all texels with the error flag are converted to single-channel.
   template<int N> void apply(const BitmapRef<float, N> &sdf) const;
   /// Returns the stencil in its current state (see Flags).
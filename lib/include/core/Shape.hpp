@@ -43,6 +43,8 @@ public:
   Bounds getBounds(double border = 0, double miterLimit = 0, int polarity = 0) const;
   /// Outputs the scanline that intersects the shape at y.
   void scanline(Scanline &line, double y) const;
+  /// Outputs the scanline that intersects the shape at y, collecting the intersections in a reusable buffer.
+  void scanline(Scanline &line, double y, std::vector<Scanline::Intersection> &intersections) const;
   /// Returns the total number of edge segments
   int edgeCount() const;
   /// Assumes its contours are unoriented (even-odd fill rule). Attempts to orient them to conform to the non-zero
@@ -12,8 +12,11 @@ template<class ContourCombiner> class ShapeDistanceFinder
 public:
   typedef typename ContourCombiner::DistanceType DistanceType;
 
+  ShapeDistanceFinder();
   // Passed shape object must persist until the distance finder is destroyed!
   explicit ShapeDistanceFinder(const Shape &shape);
+  /// Switches to another shape, reusing the memory allocated for the previous one if it suffices
+  void setShape(const Shape &shape);
   /// Finds the distance from origin. Not thread-safe! Is fastest when subsequent queries are close together.
   DistanceType distance(const Point2 &origin);
 
@@ -22,18 +25,27 @@ public:
   static DistanceType oneShotDistance(const Shape &shape, const Point2 &origin);
 
 private:
-  const Shape &shape;
+  const Shape *shape;
   ContourCombiner contourCombiner;
   std::vector<typename ContourCombiner::EdgeSelectorType::EdgeCache> shapeEdgeCache;
 };
 
 typedef ShapeDistanceFinder<SimpleContourCombiner<TrueDistanceSelector>> SimpleTrueShapeDistanceFinder;
 
+template<class ContourCombiner> ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder() : shape(nullptr) {}
+
 template<class ContourCombiner>
 ShapeDistanceFinder<ContourCombiner>::ShapeDistanceFinder(const Shape &shape)
-  : shape(shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount())
+  : shape(&shape), contourCombiner(shape), shapeEdgeCache(shape.edgeCount())
 {}
 
+template<class ContourCombiner> void ShapeDistanceFinder<ContourCombiner>::setShape(const Shape &shape)
+{
+  this->shape = &shape;
+  contourCombiner.setShape(shape);
+  shapeEdgeCache.assign(shape.edgeCount(), typename ContourCombiner::EdgeSelectorType::EdgeCache());
+}
+
 template<class ContourCombiner>
 typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<ContourCombiner>::distance(
   const Point2 &origin)
@@ -41,11 +53,11 @@ typename ShapeDistanceFinder<ContourCombiner>::DistanceType ShapeDistanceFinder<
   contourCombiner.reset(origin);
   typename ContourCombiner::EdgeSelectorType::EdgeCache *edgeCache = shapeEdgeCache.data();
 
-  for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end();
+  for (std::vector<Contour>::const_iterator contour = shape->contours.begin(); contour != shape->contours.end();
        ++contour) {
     if (!contour->edges.empty()) {
       typename ContourCombiner::EdgeSelectorType &edgeSelector =
-        contourCombiner.edgeSelector(int(contour - shape.contours.begin()));
+        contourCombiner.edgeSelector(int(contour - shape->contours.begin()));
 
       const EdgeSegment *prevEdge = contour->edges.size() >= 2 ? *(contour->edges.end() - 2) : *contour->edges.begin();
       const EdgeSegment *curEdge = contour->edges.back();
@@ -11,7 +11,9 @@ public:
   typedef EdgeSelector EdgeSelectorType;
   typedef typename EdgeSelector::DistanceType DistanceType;
 
+  SimpleContourCombiner();
   explicit SimpleContourCombiner(const Shape &shape);
+  void setShape(const Shape &shape);
   void reset(const Point2 &p);
   EdgeSelector &edgeSelector(int i);
   DistanceType distance() const;
@@ -28,7 +30,10 @@ public:
   typedef EdgeSelector EdgeSelectorType;
   typedef typename EdgeSelector::DistanceType DistanceType;
 
+  OverlappingContourCombiner();
   explicit OverlappingContourCombiner(const Shape &shape);
+  /// Switches to another shape, reusing the allocated memory if it suffices
+  void setShape(const Shape &shape);
   void reset(const Point2 &p);
   EdgeSelector &edgeSelector(int i);
   DistanceType distance() const;
@@ -3,6 +3,9 @@
 #include "core/Shape.hpp"
 
 #define MSDLIB_EDGE_LENGTH_PRECISION 4
+/// Linear congruential generator, which derives the coloring seeds of individual glyphs from a common seed
+#define MSDFLIB_LCG_MULTIPLIER 6364136223846793005ull
+#define MSDFLIB_LCG_INCREMENT 1442695040888963407ull
 
 namespace msdfgen {
 /** Assigns colors to edges of the shape in accordance to the multi-channel distance field technique.
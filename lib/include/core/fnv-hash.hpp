@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+
+#define MSDFGEN_FNV_OFFSET_BASIS 0xcbf29ce484222325ull
+#define MSDFGEN_FNV_PRIME 0x100000001b3ull
+
+namespace msdfgen {
+// Incremental 64-bit FNV-1a hashing, used internally by the shape and glyph bitmap hashes
+
+inline void fnvHashBytes(unsigned long long &hash, const void *data, size_t size)
+{
+  const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < size; ++i) hash = (hash ^ bytes[i]) * MSDFGEN_FNV_PRIME;
+}
+
+inline void fnvHashValue(unsigned long long &hash, double value)
+{
+  // Adding zero turns negative zero into positive zero, which compares equal
+  value += 0.0;
+  fnvHashBytes(hash, &value, sizeof(value));
+}
+
+inline void fnvHashValue(unsigned long long &hash, int value) { fnvHashBytes(hash, &value, sizeof(value)); }
+}// namespace msdfgen
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+
+#include "core/base.hpp"
+
+namespace msdfgen {
+/// Reads the entire contents of a file into data.
+bool loadFile(std::vector<byte> &data, const char *filename);
+}// namespace msdfgen
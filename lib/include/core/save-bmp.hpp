@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdio>
+#include <vector>
+
 #include "core/BitmapRef.hpp"
 #include "core/base.hpp"
 
@@ -11,4 +14,15 @@ bool saveBmp(const BitmapConstRef<byte, 4> &bitmap, const char *filename);
 bool saveBmp(const BitmapConstRef<float, 1> &bitmap, const char *filename);
 bool saveBmp(const BitmapConstRef<float, 3> &bitmap, const char *filename);
 bool saveBmp(const BitmapConstRef<float, 4> &bitmap, const char *filename);
+/// Encodes the bitmap as a BMP file and appends it to output.
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<byte, 1> &bitmap);
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<byte, 3> &bitmap);
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<byte, 4> &bitmap);
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<float, 1> &bitmap);
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<float, 3> &bitmap);
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<float, 4> &bitmap);
+/// Writes the header of a 24-bit BMP file. It must be followed by the BGR pixel rows, bottom row first, each padded to
+/// paddedWidth bytes.
+bool writeBmpHeader(FILE *file, int width, int height, int &paddedWidth);
+void writeBmpHeader(std::vector<byte> &output, int width, int height, int &paddedWidth);
 }// namespace msdfgen
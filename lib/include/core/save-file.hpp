@@ -0,0 +1,10 @@
+#pragma once
+
+#include <vector>
+
+#include "core/base.hpp"
+
+namespace msdfgen {
+/// Writes the encoded contents of a file (such as the output of encodeBmp) to the given path.
+bool saveFile(const std::vector<byte> &data, const char *filename);
+}// namespace msdfgen
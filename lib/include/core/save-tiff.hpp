@@ -1,10 +1,21 @@
 #pragma once
 
+#include <cstdio>
+#include <vector>
+
 #include "core/BitmapRef.hpp"
+#include "core/base.hpp"
 
 namespace msdfgen {
 /// Saves the bitmap as an uncompressed floating-point TIFF file.
 bool saveTiff(const BitmapConstRef<float, 1> &bitmap, const char *filename);
 bool saveTiff(const BitmapConstRef<float, 3> &bitmap, const char *filename);
 bool saveTiff(const BitmapConstRef<float, 4> &bitmap, const char *filename);
+/// Encodes the bitmap as an uncompressed floating-point TIFF file and appends it to output.
+bool encodeTiff(std::vector<byte> &output, const BitmapConstRef<float, 1> &bitmap);
+bool encodeTiff(std::vector<byte> &output, const BitmapConstRef<float, 3> &bitmap);
+bool encodeTiff(std::vector<byte> &output, const BitmapConstRef<float, 4> &bitmap);
+/// Writes the header of an uncompressed floating-point TIFF file. It must be followed by the pixel rows, top row first.
+bool writeTiffHeader(FILE *file, int width, int height, int channels);
+void writeTiffHeader(std::vector<byte> &output, int width, int height, int channels);
 }// namespace msdfgen
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "core/Shape.hpp"
+
+namespace msdfgen {
+/// Computes a hash of the shape's geometry (Y-axis orientation, contours, edge types and control points).
+/// Edge colors are not included. Shapes with equal geometry (see shapeGeometryEquals) have equal hashes.
+unsigned long long shapeHash(const Shape &shape);
+/// Computes a hash of the shape's geometry including the edge colors, e.g. to identify its multi-channel distance field.
+unsigned long long coloredShapeHash(const Shape &shape);
+/// Returns true if the two shapes consist of exactly the same edges in the same order, regardless of edge colors.
+bool shapeGeometryEquals(const Shape &a, const Shape &b);
+}// namespace msdfgen
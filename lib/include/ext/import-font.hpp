@@ -79,6 +79,9 @@ bool loadGlyph(Shape &output, FontHandle *font, unicode_t unicode, double *advan
 /// Outputs the kerning distance adjustment between two specific glyphs.
 bool getKerning(double &output, FontHandle *font, GlyphIndex glyphIndex0, GlyphIndex glyphIndex1);
 bool getKerning(double &output, FontHandle *font, unicode_t unicode0, unicode_t unicode1);
+/// Outputs the raw contents of the font's table with the given four-character tag (e.g. "kern"). Returns false if the
+/// font is not an SFNT (TrueType / OpenType) font. If the font does not contain the table, the output is empty.
+bool getFontTable(std::vector<byte> &output, FontHandle *font, const char *tag);
 
 bool setFontVariationAxis(FreetypeHandle *library, FontHandle *font, const char *name, double coordinate);
 bool listFontVariationAxes(std::vector<FontVariationAxis> &axes, FreetypeHandle *library, FontHandle *font);
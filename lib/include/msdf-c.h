@@ -0,0 +1,189 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C interface of the library, meant to be bound from other languages. All objects are opaque handles created and
+ * destroyed by the functions below, so their layout may change without breaking the ABI. Pixels are always written
+ * into buffers provided by the caller, tightly packed with interleaved channels, in rows from bottom to top.
+ * A handle must not be used by multiple threads at once, but different handles may be used concurrently.
+ * Functions never let errors escape in any other way than their return values - creating functions return null.
+ * Metrics and plane bounds are in ems with the y axis pointing up, atlas bounds are in pixels.
+ */
+
+#ifndef MSDF_API
+#if defined(_WIN32) && defined(MSDF_EXPORTS)
+#define MSDF_API __declspec(dllexport)
+#elif defined(_WIN32) && defined(MSDF_SHARED)
+#define MSDF_API __declspec(dllimport)
+#elif defined(__GNUC__)
+#define MSDF_API __attribute__((visibility("default")))
+#else
+#define MSDF_API
+#endif
+#endif
+
+/* Incremented whenever the interface changes in a way that is not backwards compatible */
+#define MSDF_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum msdf_status {
+  MSDF_OK = 0,
+  MSDF_INVALID_ARGUMENT = 1,
+  MSDF_LOAD_FAILED = 2,
+  MSDF_PACKING_FAILED = 3,
+  MSDF_BUFFER_TOO_SMALL = 4,
+  MSDF_OUT_OF_MEMORY = 5,
+  /* An unexpected error occurred inside the library */
+  MSDF_INTERNAL_ERROR = 6
+} msdf_status;
+
+/* A soft mask is a distance field with a range of 1 pixel. Glyph sets generated as hard or soft masks must therefore be
+   packed or wrapped with px_range set to 1, otherwise the soft mask comes out identical to MSDF_IMAGE_SDF */
+typedef enum msdf_image_type {
+  MSDF_IMAGE_HARD_MASK = 0,
+  MSDF_IMAGE_SOFT_MASK = 1,
+  MSDF_IMAGE_SDF = 2,
+  MSDF_IMAGE_PSDF = 3,
+  MSDF_IMAGE_MSDF = 4,
+  MSDF_IMAGE_MTSDF = 5
+} msdf_image_type;
+
+typedef enum msdf_edge_coloring {
+  MSDF_COLORING_SIMPLE = 0,
+  MSDF_COLORING_INKTRAP = 1,
+  MSDF_COLORING_DISTANCE = 2
+} msdf_edge_coloring;
+
+typedef enum msdf_dimensions_constraint {
+  MSDF_DIMENSIONS_NONE = 0,
+  MSDF_DIMENSIONS_SQUARE = 1,
+  MSDF_DIMENSIONS_EVEN_SQUARE = 2,
+  MSDF_DIMENSIONS_MULTIPLE_OF_FOUR_SQUARE = 3,
+  MSDF_DIMENSIONS_POWER_OF_TWO_RECTANGLE = 4,
+  MSDF_DIMENSIONS_POWER_OF_TWO_SQUARE = 5
+} msdf_dimensions_constraint;
+
+/* A loaded font file */
+typedef struct msdf_font msdf_font;
+/* A list of glyph shapes, which can be edge-colored, laid out and generated into an atlas */
+typedef struct msdf_glyph_set msdf_glyph_set;
+/* Working memory for generating single glyphs, which is reused between calls */
+typedef struct msdf_context msdf_context;
+
+typedef struct msdf_font_metrics {
+  double line_height;
+  double ascender;
+  double descender;
+  double underline_y;
+  double underline_thickness;
+} msdf_font_metrics;
+
+typedef struct msdf_glyph_info {
+  uint32_t codepoint;
+  uint32_t glyph_index;
+  double advance;
+  /* Size of the glyph's bitmap in pixels, zero until the glyph set has been laid out, and for whitespace */
+  int width, height;
+  /* Quad of the glyph relative to the origin, and its location in the atlas (only after msdf_glyph_set_pack) */
+  double plane_left, plane_bottom, plane_right, plane_top;
+  double atlas_left, atlas_bottom, atlas_right, atlas_top;
+} msdf_glyph_info;
+
+typedef struct msdf_pack_settings {
+  /* Fixed atlas dimensions, or zero to find the smallest dimensions that satisfy dimensions_constraint */
+  int width, height;
+  msdf_dimensions_constraint dimensions_constraint;
+  /* Fixed glyph size in pixels per em, or zero to find the largest size (but at least min_em_size) that fits */
+  double em_size;
+  double min_em_size;
+  /* Distance range in pixels, must be 1 for hard and soft masks */
+  double px_range;
+  double miter_limit;
+  /* Spacing between glyph boxes in pixels */
+  int spacing;
+  int thread_count;
+} msdf_pack_settings;
+
+typedef struct msdf_layout {
+  int width, height;
+  double em_size;
+  double px_range;
+} msdf_layout;
+
+/* Returns MSDF_API_VERSION of the library */
+MSDF_API int msdf_get_api_version(void);
+/* Returns the number of channels of the image type */
+MSDF_API int msdf_image_type_channels(msdf_image_type image_type);
+
+/* Loads a font file, returns null on failure */
+MSDF_API msdf_font *msdf_font_load(const char *filename);
+/* Loads a font from memory, which is copied, returns null on failure */
+MSDF_API msdf_font *msdf_font_load_data(const unsigned char *data, size_t size);
+MSDF_API void msdf_font_destroy(msdf_font *font);
+MSDF_API msdf_status msdf_font_get_metrics(const msdf_font *font, msdf_font_metrics *metrics);
+
+MSDF_API msdf_glyph_set *msdf_glyph_set_create(void);
+MSDF_API void msdf_glyph_set_destroy(msdf_glyph_set *glyphs);
+/* Appends the glyphs of the font with the given Unicode codepoints, or glyph indices if glyph_indices is nonzero.
+   Glyphs missing in the font are skipped, the number of added glyphs is written into added (which may be null) */
+MSDF_API msdf_status msdf_glyph_set_add(msdf_glyph_set *glyphs,
+  msdf_font *font,
+  const uint32_t *identifiers,
+  size_t count,
+  int glyph_indices,
+  size_t *added);
+MSDF_API size_t msdf_glyph_set_get_count(const msdf_glyph_set *glyphs);
+MSDF_API msdf_status msdf_glyph_set_get_glyph(const msdf_glyph_set *glyphs, size_t glyph, msdf_glyph_info *info);
+/* Assigns edge colors to all glyphs, which is required for MSDF and MTSDF images */
+MSDF_API msdf_status msdf_glyph_set_color_edges(msdf_glyph_set *glyphs,
+  msdf_edge_coloring coloring,
+  double angle_threshold,
+  unsigned long long seed);
+
+/* Fills settings with the defaults - automatic dimensions and glyph size */
+MSDF_API void msdf_pack_settings_init(msdf_pack_settings *settings);
+/* Lays out the glyphs in a single atlas. If the glyphs do not fit, MSDF_PACKING_FAILED is returned */
+MSDF_API msdf_status msdf_glyph_set_pack(msdf_glyph_set *glyphs,
+  const msdf_pack_settings *settings,
+  msdf_layout *layout);
+/* Computes the bitmap size of each glyph for standalone generation, without laying out an atlas. As with
+   msdf_glyph_set_pack, px_range must be 1 for hard and soft masks */
+MSDF_API msdf_status msdf_glyph_set_wrap(msdf_glyph_set *glyphs, double em_size, double px_range, double miter_limit);
+
+/* Generates the atlas laid out by msdf_glyph_set_pack. The buffer must hold width * height * channels values */
+MSDF_API msdf_status msdf_glyph_set_generate_atlas(const msdf_glyph_set *glyphs,
+  msdf_image_type image_type,
+  float *pixels,
+  size_t size,
+  int thread_count);
+MSDF_API msdf_status msdf_glyph_set_generate_atlas_8bit(const msdf_glyph_set *glyphs,
+  msdf_image_type image_type,
+  unsigned char *pixels,
+  size_t size,
+  int thread_count);
+
+MSDF_API msdf_context *msdf_context_create(void);
+MSDF_API void msdf_context_destroy(msdf_context *context);
+/* Generates a single glyph of a laid out glyph set. The buffer must hold width * height * channels values of the
+   glyph's msdf_glyph_info. Once the context's memory has grown to the largest glyph, this does not allocate */
+MSDF_API msdf_status msdf_generate_glyph(msdf_context *context,
+  const msdf_glyph_set *glyphs,
+  size_t glyph,
+  msdf_image_type image_type,
+  float *pixels,
+  size_t size);
+MSDF_API msdf_status msdf_generate_glyph_8bit(msdf_context *context,
+  const msdf_glyph_set *glyphs,
+  size_t glyph,
+  msdf_image_type image_type,
+  unsigned char *pixels,
+  size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,24 +1,181 @@
+#include <algorithm>
+
 #include "atlas/Charset.hpp"
 
 namespace msdf_atlas {
+static size_t rangeSize(const Charset::Range &range) { return (size_t)(range.last - range.first) + 1; }
+
 static Charset createAsciiCharset()
 {
   Charset ascii;
-  for (unicode_t cp = 0x20; cp < 0x7f; ++cp) ascii.add(cp);
+  ascii.addRange(0x20, 0x7e);
   return ascii;
 }
 
 const Charset Charset::ASCII = createAsciiCharset();
 
-void Charset::add(unicode_t cp) { codepoints.insert(cp); }
+Charset::const_iterator::const_iterator() : range(), rangesEnd(), cp() {}
+
+Charset::const_iterator::const_iterator(const Range *range, const Range *rangesEnd)
+  : range(range), rangesEnd(rangesEnd), cp(range != rangesEnd ? range->first : 0)
+{}
 
-void Charset::remove(unicode_t cp) { codepoints.erase(cp); }
+const unicode_t &Charset::const_iterator::operator*() const { return cp; }
 
-size_t Charset::size() const { return codepoints.size(); }
+const unicode_t *Charset::const_iterator::operator->() const { return &cp; }
+
+Charset::const_iterator &Charset::const_iterator::operator++()
+{
+  if (cp == range->last) {
+    ++range;
+    cp = range != rangesEnd ? range->first : 0;
+  } else
+    ++cp;
+  return *this;
+}
 
-bool Charset::empty() const { return codepoints.empty(); }
+Charset::const_iterator Charset::const_iterator::operator++(int)
+{
+  const_iterator prev = *this;
+  ++*this;
+  return prev;
+}
 
-std::set<unicode_t>::const_iterator Charset::begin() const { return codepoints.begin(); }
+bool Charset::const_iterator::operator==(const const_iterator &other) const
+{
+  return range == other.range && cp == other.cp;
+}
+
+bool Charset::const_iterator::operator!=(const const_iterator &other) const { return !(*this == other); }
+
+Charset::Charset() : count(0) {}
+
+void Charset::add(unicode_t cp) { addRange(cp, cp); }
+
+void Charset::addRange(unicode_t first, unicode_t last)
+{
+  if (first > last) return;
+  // Find the first range that overlaps or touches the new one, without overflow at the ends of the codepoint space
+  std::vector<Range>::iterator it = std::lower_bound(ranges.begin(),
+    ranges.end(),
+    first,
+    [](const Range &range, unicode_t cp) { return range.last < cp && range.last + 1 < cp; });
+  if (it != ranges.end() && it->first <= first && it->last >= last) return;
+  Range merged = { first, last };
+  std::vector<Range>::iterator end = it;
+  for (; end != ranges.end() && (end->first <= last || end->first - 1 <= last); ++end) {
+    count -= rangeSize(*end);
+    merged.first = std::min(merged.first, end->first);
+    merged.last = std::max(merged.last, end->last);
+  }
+  count += rangeSize(merged);
+  if (it == end)
+    ranges.insert(it, merged);
+  else {
+    *it = merged;
+    ranges.erase(it + 1, end);
+  }
+}
+
+void Charset::add(const Charset &charset)
+{
+  if (charset.ranges.empty()) return;
+  if (ranges.empty()) {
+    ranges = charset.ranges;
+    count = charset.count;
+    return;
+  }
+  // Merge both sorted lists of ranges
+  std::vector<Range> result;
+  result.reserve(ranges.size() + charset.ranges.size());
+  count = 0;
+  std::vector<Range>::const_iterator a = ranges.begin(), b = charset.ranges.begin();
+  while (a != ranges.end() || b != charset.ranges.end()) {
+    const Range &next = b == charset.ranges.end() || (a != ranges.end() && a->first < b->first) ? *a++ : *b++;
+    if (!result.empty() && (next.first <= result.back().last || next.first - 1 <= result.back().last)) {
+      if (next.last > result.back().last) {
+        count += next.last - result.back().last;
+        result.back().last = next.last;
+      }
+    } else {
+      result.push_back(next);
+      count += rangeSize(next);
+    }
+  }
+  ranges = (std::vector<Range> &&)result;
+}
+
+void Charset::remove(unicode_t cp) { removeRange(cp, cp); }
+
+void Charset::removeRange(unicode_t first, unicode_t last)
+{
+  if (first > last) return;
+  std::vector<Range>::iterator it = std::lower_bound(
+    ranges.begin(), ranges.end(), first, [](const Range &range, unicode_t cp) { return range.last < cp; });
+  // Parts of the affected ranges that lie before first and after last remain
+  Range remaining[2];
+  int remainingCount = 0;
+  std::vector<Range>::iterator end = it;
+  for (; end != ranges.end() && end->first <= last; ++end) {
+    count -= rangeSize(*end);
+    if (end->first < first) remaining[remainingCount++] = Range{ end->first, first - 1 };
+    if (end->last > last) remaining[remainingCount++] = Range{ last + 1, end->last };
+  }
+  for (int i = 0; i < remainingCount; ++i) count += rangeSize(remaining[i]);
+  it = ranges.erase(it, end);
+  ranges.insert(it, remaining, remaining + remainingCount);
+}
+
+void Charset::remove(const Charset &charset)
+{
+  if (ranges.empty() || charset.ranges.empty()) return;
+  std::vector<Range> result;
+  result.reserve(ranges.size() + charset.ranges.size());
+  count = 0;
+  std::vector<Range>::const_iterator b = charset.ranges.begin();
+  for (const Range &range : ranges) {
+    while (b != charset.ranges.end() && b->last < range.first) ++b;
+    unicode_t first = range.first;
+    bool consumed = false;
+    for (std::vector<Range>::const_iterator c = b; c != charset.ranges.end() && c->first <= range.last; ++c) {
+      if (c->first > first) {
+        result.push_back(Range{ first, c->first - 1 });
+        count += rangeSize(result.back());
+      }
+      if (c->last >= range.last) {
+        consumed = true;
+        break;
+      }
+      first = c->last + 1;
+    }
+    if (!consumed) {
+      result.push_back(Range{ first, range.last });
+      count += rangeSize(result.back());
+    }
+  }
+  ranges = (std::vector<Range> &&)result;
+}
+
+bool Charset::contains(unicode_t cp) const
+{
+  std::vector<Range>::const_iterator it = std::lower_bound(
+    ranges.begin(), ranges.end(), cp, [](const Range &range, unicode_t cp) { return range.last < cp; });
+  return it != ranges.end() && it->first <= cp;
+}
+
+size_t Charset::size() const { return count; }
+
+bool Charset::empty() const { return ranges.empty(); }
+
+Charset::const_iterator Charset::begin() const
+{
+  return const_iterator(ranges.data(), ranges.data() + ranges.size());
+}
+
+Charset::const_iterator Charset::end() const
+{
+  return const_iterator(ranges.data() + ranges.size(), ranges.data() + ranges.size());
+}
 
-std::set<unicode_t>::const_iterator Charset::end() const { return codepoints.end(); }
+const std::vector<Charset::Range> &Charset::getRanges() const { return ranges; }
 }// namespace msdf_atlas
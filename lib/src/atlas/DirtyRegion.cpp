@@ -0,0 +1,35 @@
+#include <algorithm>
+
+#include "atlas/DirtyRegion.hpp"
+
+namespace msdf_atlas {
+
+static long long area(const Rectangle &rect) { return (long long)rect.w * rect.h; }
+
+void addDirtyRegion(std::vector<DirtyRegion> &regions, const DirtyRegion &region)
+{
+  if (!(region.rect.w > 0 && region.rect.h > 0)) return;
+  DirtyRegion merged = region;
+  // Single pass which compacts the list in place, so adding a region is linear in the number of regions
+  size_t kept = 0;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    const DirtyRegion &other = regions[i];
+    if (other.page == merged.page) {
+      Rectangle bounds;
+      bounds.x = std::min(merged.rect.x, other.rect.x);
+      bounds.y = std::min(merged.rect.y, other.rect.y);
+      bounds.w = std::max(merged.rect.x + merged.rect.w, other.rect.x + other.rect.w) - bounds.x;
+      bounds.h = std::max(merged.rect.y + merged.rect.h, other.rect.y + other.rect.h) - bounds.y;
+      // Only merge if the bounding rectangle is not larger than the two regions combined
+      if (area(bounds) <= area(merged.rect) + area(other.rect)) {
+        merged.rect = bounds;
+        continue;
+      }
+    }
+    if (kept != i) regions[kept] = other;
+    ++kept;
+  }
+  regions.resize(kept);
+  regions.push_back(merged);
+}
+}// namespace msdf_atlas
@@ -1,15 +1,32 @@
+#include <algorithm>
+
 #include "atlas/FontGeometry.hpp"
+#include "atlas/Workload.hpp"
+#include "atlas/kerning-tables.hpp"
 
 namespace msdf_atlas {
+static uint64_t kerningKey(int index1, int index2) { return (uint64_t)(uint32_t)index1 << 32 | (uint32_t)index2; }
+
+template<typename T>
+static const size_t *findGlyphPosition(const std::vector<std::pair<T, size_t>> &entries, T identifier)
+{
+  typename std::vector<std::pair<T, size_t>>::const_iterator it = std::lower_bound(entries.begin(),
+    entries.end(),
+    identifier,
+    [](const std::pair<T, size_t> &entry, T identifier) { return entry.first < identifier; });
+  if (it != entries.end() && it->first == identifier) return &it->second;
+  return nullptr;
+}
+
 FontGeometry::GlyphRange::GlyphRange() : glyphs(), rangeStart(), rangeEnd() {}
 
 FontGeometry::GlyphRange::GlyphRange(const std::vector<GlyphGeometry> *glyphs, size_t rangeStart, size_t rangeEnd)
   : glyphs(glyphs), rangeStart(rangeStart), rangeEnd(rangeEnd)
 {}
 
-size_t FontGeometry::GlyphRange::size() const { return glyphs->size(); }
+size_t FontGeometry::GlyphRange::size() const { return rangeEnd - rangeStart; }
 
-bool FontGeometry::GlyphRange::empty() const { return glyphs->empty(); }
+bool FontGeometry::GlyphRange::empty() const { return rangeEnd == rangeStart; }
 
 const GlyphGeometry *FontGeometry::GlyphRange::begin() const { return glyphs->data() + rangeStart; }
 
@@ -17,12 +34,12 @@ const GlyphGeometry *FontGeometry::GlyphRange::end() const { return glyphs->data
 
 FontGeometry::FontGeometry()
   : geometryScale(1), metrics(), preferredIdentifierType(GlyphIdentifierType::UNICODE_CODEPOINT), glyphs(&ownGlyphs),
-    rangeStart(glyphs->size()), rangeEnd(glyphs->size())
+    rangeStart(glyphs->size()), rangeEnd(glyphs->size()), frozen(false)
 {}
 
 FontGeometry::FontGeometry(std::vector<GlyphGeometry> *glyphStorage)
   : geometryScale(1), metrics(), preferredIdentifierType(GlyphIdentifierType::UNICODE_CODEPOINT), glyphs(glyphStorage),
-    rangeStart(glyphs->size()), rangeEnd(glyphs->size())
+    rangeStart(glyphs->size()), rangeEnd(glyphs->size()), frozen(false)
 {}
 
 int FontGeometry::loadGlyphRange(msdfgen::FontHandle *font,
@@ -89,6 +106,64 @@ int FontGeometry::loadCharset(msdfgen::FontHandle *font,
   return loaded;
 }
 
+int FontGeometry::loadGlyphRange(const byte *fontData,
+  int fontDataLength,
+  double fontScale,
+  unsigned rangeStart,
+  unsigned rangeEnd,
+  int threadCount,
+  bool preprocessGeometry,
+  bool enableKerning)
+{
+  std::vector<unicode_t> indices;
+  indices.reserve(rangeEnd > rangeStart ? rangeEnd - rangeStart : 0);
+  for (unsigned index = rangeStart; index < rangeEnd; ++index) indices.push_back(index);
+  return loadGlyphs(fontData,
+    fontDataLength,
+    fontScale,
+    indices,
+    GlyphIdentifierType::GLYPH_INDEX,
+    threadCount,
+    preprocessGeometry,
+    enableKerning);
+}
+
+int FontGeometry::loadGlyphset(const byte *fontData,
+  int fontDataLength,
+  double fontScale,
+  const Charset &glyphset,
+  int threadCount,
+  bool preprocessGeometry,
+  bool enableKerning)
+{
+  return loadGlyphs(fontData,
+    fontDataLength,
+    fontScale,
+    std::vector<unicode_t>(glyphset.begin(), glyphset.end()),
+    GlyphIdentifierType::GLYPH_INDEX,
+    threadCount,
+    preprocessGeometry,
+    enableKerning);
+}
+
+int FontGeometry::loadCharset(const byte *fontData,
+  int fontDataLength,
+  double fontScale,
+  const Charset &charset,
+  int threadCount,
+  bool preprocessGeometry,
+  bool enableKerning)
+{
+  return loadGlyphs(fontData,
+    fontDataLength,
+    fontScale,
+    std::vector<unicode_t>(charset.begin(), charset.end()),
+    GlyphIdentifierType::UNICODE_CODEPOINT,
+    threadCount,
+    preprocessGeometry,
+    enableKerning);
+}
+
 bool FontGeometry::loadMetrics(msdfgen::FontHandle *font, double fontScale)
 {
   if (!msdfgen::getFontMetrics(metrics, font)) return false;
@@ -106,6 +181,7 @@ bool FontGeometry::loadMetrics(msdfgen::FontHandle *font, double fontScale)
 bool FontGeometry::addGlyph(const GlyphGeometry &glyph)
 {
   if (glyphs->size() != rangeEnd) return false;
+  unfreeze();
   glyphsByIndex.insert(std::make_pair(glyph.getIndex(), rangeEnd));
   if (glyph.getCodepoint()) glyphsByCodepoint.insert(std::make_pair(glyph.getCodepoint(), rangeEnd));
   glyphs->push_back(glyph);
@@ -116,6 +192,7 @@ bool FontGeometry::addGlyph(const GlyphGeometry &glyph)
 bool FontGeometry::addGlyph(GlyphGeometry &&glyph)
 {
   if (glyphs->size() != rangeEnd) return false;
+  unfreeze();
   glyphsByIndex.insert(std::make_pair(glyph.getIndex(), rangeEnd));
   if (glyph.getCodepoint()) glyphsByCodepoint.insert(std::make_pair(glyph.getCodepoint(), rangeEnd));
   glyphs->push_back((GlyphGeometry &&)glyph);
@@ -123,20 +200,64 @@ bool FontGeometry::addGlyph(GlyphGeometry &&glyph)
   return true;
 }
 
-int FontGeometry::loadKerning(msdfgen::FontHandle *font)
+int FontGeometry::loadKerning(msdfgen::FontHandle *font, bool gposKerning)
 {
-  int loaded = 0;
-  for (size_t i = rangeStart; i < rangeEnd; ++i)
-    for (size_t j = rangeStart; j < rangeEnd; ++j) {
-      double advance;
-      if (msdfgen::getKerning(advance, font, (*glyphs)[i].getGlyphIndex(), (*glyphs)[j].getGlyphIndex()) && advance) {
-        kerning[std::make_pair<int, int>((*glyphs)[i].getIndex(), (*glyphs)[j].getIndex())] = geometryScale * advance;
-        ++loaded;
+  unfreeze();
+  std::vector<byte> table;
+  if (!msdfgen::getFontTable(table, font, "kern")) {
+    // Not an SFNT font - probe all pairs of glyphs
+    int loaded = 0;
+    for (size_t i = rangeStart; i < rangeEnd; ++i)
+      for (size_t j = rangeStart; j < rangeEnd; ++j) {
+        double advance;
+        if (msdfgen::getKerning(advance, font, (*glyphs)[i].getGlyphIndex(), (*glyphs)[j].getGlyphIndex())
+            && advance) {
+          kerning[std::make_pair<int, int>((*glyphs)[i].getIndex(), (*glyphs)[j].getIndex())] = geometryScale * advance;
+          ++loaded;
+        }
       }
+    return loaded;
+  }
+  std::vector<bool> glyphMask;
+  for (size_t i = rangeStart; i < rangeEnd; ++i) {
+    size_t index = (size_t)(*glyphs)[i].getIndex();
+    if (index >= glyphMask.size()) glyphMask.resize(index + 1);
+    glyphMask[index] = true;
+  }
+  std::map<std::pair<int, int>, int> pairs;
+  if (!table.empty()) readKernTable(pairs, table.data(), table.size(), glyphMask);
+  if (gposKerning && msdfgen::getFontTable(table, font, "GPOS") && !table.empty()) {
+    // The 'kern' table takes precedence for pairs it contains
+    std::map<std::pair<int, int>, int> gposPairs;
+    readGposKerning(gposPairs, table.data(), table.size(), glyphMask);
+    pairs.insert(gposPairs.begin(), gposPairs.end());
+  }
+  int loaded = 0;
+  for (const std::pair<const std::pair<int, int>, int> &pair : pairs) {
+    if (pair.second) {
+      // Same conversion from 26.6 fixed point as in msdfgen::getKerning
+      kerning[pair.first] = geometryScale * (1 / 64. * double(pair.second));
+      ++loaded;
     }
+  }
   return loaded;
 }
 
+void FontGeometry::setMetrics(double geometryScale, const msdfgen::FontMetrics &metrics)
+{
+  this->geometryScale = geometryScale;
+  this->metrics = metrics;
+}
+
+void FontGeometry::setPreferredIdentifierType(GlyphIdentifierType type) { preferredIdentifierType = type; }
+
+void FontGeometry::setKerning(int index1, int index2, double advance)
+{
+  unfreeze();
+  // Pairs are usually set in ascending order, in which case the hint makes the insertion constant time
+  kerning.insert_or_assign(kerning.end(), std::make_pair(index1, index2), advance);
+}
+
 void FontGeometry::setName(const char *name)
 {
   if (name)
@@ -145,6 +266,25 @@ void FontGeometry::setName(const char *name)
     this->name.clear();
 }
 
+void FontGeometry::freeze()
+{
+  frozenGlyphsByIndex.assign(glyphsByIndex.begin(), glyphsByIndex.end());
+  frozenGlyphsByCodepoint.assign(glyphsByCodepoint.begin(), glyphsByCodepoint.end());
+  std::vector<std::pair<uint64_t, double>> kerningPairs;
+  kerningPairs.reserve(kerning.size());
+  for (const std::pair<const std::pair<int, int>, double> &kernPair : kerning)
+    kerningPairs.push_back(std::make_pair(kerningKey(kernPair.first.first, kernPair.first.second), kernPair.second));
+  // Only differs from the map's order if there are negative indices
+  std::sort(kerningPairs.begin(), kerningPairs.end());
+  frozenKerningKeys.resize(kerningPairs.size());
+  frozenKerningValues.resize(kerningPairs.size());
+  for (size_t i = 0; i < kerningPairs.size(); ++i) {
+    frozenKerningKeys[i] = kerningPairs[i].first;
+    frozenKerningValues[i] = kerningPairs[i].second;
+  }
+  frozen = true;
+}
+
 double FontGeometry::getGeometryScale() const { return geometryScale; }
 
 const msdfgen::FontMetrics &FontGeometry::getMetrics() const { return metrics; }
@@ -155,6 +295,10 @@ FontGeometry::GlyphRange FontGeometry::getGlyphs() const { return GlyphRange(gly
 
 const GlyphGeometry *FontGeometry::getGlyph(msdfgen::GlyphIndex index) const
 {
+  if (frozen) {
+    const size_t *position = findGlyphPosition(frozenGlyphsByIndex, (int)index.getIndex());
+    return position ? &(*glyphs)[*position] : nullptr;
+  }
   std::map<int, size_t>::const_iterator it = glyphsByIndex.find(index.getIndex());
   if (it != glyphsByIndex.end()) return &(*glyphs)[it->second];
   return nullptr;
@@ -162,6 +306,10 @@ const GlyphGeometry *FontGeometry::getGlyph(msdfgen::GlyphIndex index) const
 
 const GlyphGeometry *FontGeometry::getGlyph(unicode_t codepoint) const
 {
+  if (frozen) {
+    const size_t *position = findGlyphPosition(frozenGlyphsByCodepoint, codepoint);
+    return position ? &(*glyphs)[*position] : nullptr;
+  }
   std::map<unicode_t, size_t>::const_iterator it = glyphsByCodepoint.find(codepoint);
   if (it != glyphsByCodepoint.end()) return &(*glyphs)[it->second];
   return nullptr;
@@ -171,10 +319,7 @@ bool FontGeometry::getAdvance(double &advance, msdfgen::GlyphIndex index1, msdfg
 {
   const GlyphGeometry *glyph1 = getGlyph(index1);
   if (!glyph1) return false;
-  advance = glyph1->getAdvance();
-  std::map<std::pair<int, int>, double>::const_iterator it =
-    kerning.find(std::make_pair<int, int>(index1.getIndex(), index2.getIndex()));
-  if (it != kerning.end()) advance += it->second;
+  advance = glyph1->getAdvance() + getKerningAdvance(index1.getIndex(), index2.getIndex());
   return true;
 }
 
@@ -182,10 +327,7 @@ bool FontGeometry::getAdvance(double &advance, unicode_t codepoint1, unicode_t c
 {
   const GlyphGeometry *glyph1, *glyph2;
   if (!((glyph1 = getGlyph(codepoint1)) && (glyph2 = getGlyph(codepoint2)))) return false;
-  advance = glyph1->getAdvance();
-  std::map<std::pair<int, int>, double>::const_iterator it =
-    kerning.find(std::make_pair<int, int>(glyph1->getIndex(), glyph2->getIndex()));
-  if (it != kerning.end()) advance += it->second;
+  advance = glyph1->getAdvance() + getKerningAdvance(glyph1->getIndex(), glyph2->getIndex());
   return true;
 }
 
@@ -196,4 +338,94 @@ const char *FontGeometry::getName() const
   if (name.empty()) return nullptr;
   return name.c_str();
 }
+
+bool FontGeometry::isFrozen() const { return frozen; }
+
+void FontGeometry::unfreeze()
+{
+  if (frozen) {
+    frozenGlyphsByIndex = std::vector<std::pair<int, size_t>>();
+    frozenGlyphsByCodepoint = std::vector<std::pair<unicode_t, size_t>>();
+    frozenKerningKeys = std::vector<uint64_t>();
+    frozenKerningValues = std::vector<double>();
+    frozen = false;
+  }
+}
+
+double FontGeometry::getKerningAdvance(int index1, int index2) const
+{
+  if (frozen) {
+    uint64_t key = kerningKey(index1, index2);
+    std::vector<uint64_t>::const_iterator it =
+      std::lower_bound(frozenKerningKeys.begin(), frozenKerningKeys.end(), key);
+    if (it != frozenKerningKeys.end() && *it == key) return frozenKerningValues[it - frozenKerningKeys.begin()];
+    return 0;
+  }
+  std::map<std::pair<int, int>, double>::const_iterator it = kerning.find(std::make_pair(index1, index2));
+  if (it != kerning.end()) return it->second;
+  return 0;
+}
+
+int FontGeometry::loadGlyphs(const byte *fontData,
+  int fontDataLength,
+  double fontScale,
+  const std::vector<unicode_t> &identifiers,
+  GlyphIdentifierType identifierType,
+  int threadCount,
+  bool preprocessGeometry,
+  bool enableKerning)
+{
+  msdfgen::FreetypeHandle *ft = msdfgen::initializeFreetype();
+  if (!ft) return -1;
+  msdfgen::FontHandle *font = msdfgen::loadFontData(ft, fontData, fontDataLength);
+  int loaded = -1;
+  if (font && glyphs->size() == rangeEnd && loadMetrics(font, fontScale)) {
+    // FreeType faces and libraries must not be used by multiple threads at once, so each thread gets its own.
+    // The first thread can use the main font handle because the calling thread waits in the meantime
+    threadCount = std::max(std::min(threadCount, (int)identifiers.size()), 1);
+    std::vector<msdfgen::FreetypeHandle *> threadLibraries(threadCount);
+    std::vector<msdfgen::FontHandle *> threadFonts(threadCount);
+    threadFonts[0] = font;
+    std::vector<GlyphGeometry> threadGlyphs(identifiers.size());
+    std::vector<byte> glyphLoaded(identifiers.size());
+    double geometryScale = this->geometryScale;
+    Workload workload(
+      [&](int i, int threadNo) -> bool {
+        if (!threadFonts[threadNo]) {
+          if (!(threadLibraries[threadNo] = msdfgen::initializeFreetype())) return false;
+          threadFonts[threadNo] = msdfgen::loadFontData(threadLibraries[threadNo], fontData, fontDataLength);
+          if (!threadFonts[threadNo]) return false;
+        }
+        msdfgen::FontHandle *threadFont = threadFonts[threadNo];
+        if (identifierType == GlyphIdentifierType::UNICODE_CODEPOINT)
+          glyphLoaded[i] = threadGlyphs[i].load(threadFont, geometryScale, identifiers[i], preprocessGeometry);
+        else
+          glyphLoaded[i] =
+            threadGlyphs[i].load(threadFont, geometryScale, msdfgen::GlyphIndex(identifiers[i]), preprocessGeometry);
+        return true;
+      },
+      (int)identifiers.size());
+    bool success = workload.finish(threadCount);
+    for (int i = 1; i < threadCount; ++i) {
+      if (threadFonts[i]) msdfgen::destroyFont(threadFonts[i]);
+      if (threadLibraries[i]) msdfgen::deinitializeFreetype(threadLibraries[i]);
+    }
+    if (success) {
+      // Merge in the original order so that the result is the same as with sequential loading
+      glyphs->reserve(glyphs->size() + identifiers.size());
+      loaded = 0;
+      for (size_t i = 0; i < identifiers.size(); ++i) {
+        if (glyphLoaded[i]) {
+          addGlyph((GlyphGeometry &&)threadGlyphs[i]);
+          ++loaded;
+        }
+      }
+      if (enableKerning) loadKerning(font);
+      preferredIdentifierType = identifierType;
+    }
+  }
+  if (font) msdfgen::destroyFont(font);
+  msdfgen::deinitializeFreetype(ft);
+  return loaded;
+}
 }// namespace msdf_atlas
@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <system_error>
+
+#include "atlas/GlyphBitmapCache.hpp"
+#include "core/fnv-hash.hpp"
+#include "core/shape-hash.hpp"
+
+namespace msdf_atlas {
+#define CACHE_ENTRY_MAGIC 0x4347534dU// "MSGC"
+#define CACHE_ENTRY_VERSION 1U
+
+struct CacheEntryHeader
+{
+  unsigned int magic;
+  unsigned int version;
+  unsigned long long key;
+  int width, height;
+  int channels, channelSize;
+};
+
+GlyphBitmapCache::GlyphBitmapCache()
+  : tempSeed(0), tempCounter(0), hits(0), misses(0), stores(0), bytesRead(0), bytesWritten(0)
+{}
+
+bool GlyphBitmapCache::open(const char *directory)
+{
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (!std::filesystem::is_directory(directory, error)) return false;
+  this->directory = directory;
+  // Temporary files of concurrent processes must not collide
+  std::random_device random;
+  tempSeed = (unsigned long long)random() << 32 | random();
+  return true;
+}
+
+bool GlyphBitmapCache::isOpen() const { return !directory.empty(); }
+
+unsigned long long GlyphBitmapCache::getKey(const char *generatorName,
+  const GlyphGeometry &glyph,
+  const GeneratorAttributes &attributes,
+  int channels,
+  int channelSize)
+{
+  unsigned long long hash = msdfgen::coloredShapeHash(glyph.getShape());
+  msdfgen::fnvHashValue(hash, (int)CACHE_ENTRY_VERSION);
+  msdfgen::fnvHashBytes(hash, generatorName, strlen(generatorName));
+  msdfgen::fnvHashValue(hash, channels);
+  msdfgen::fnvHashValue(hash, channelSize);
+  int w, h;
+  glyph.getBoxBitmapSize(w, h);
+  msdfgen::fnvHashValue(hash, w);
+  msdfgen::fnvHashValue(hash, h);
+  msdfgen::Vector2 translate = glyph.getBoxTranslate();
+  msdfgen::fnvHashValue(hash, glyph.getBoxScale());
+  msdfgen::fnvHashValue(hash, translate.x);
+  msdfgen::fnvHashValue(hash, translate.y);
+  msdfgen::fnvHashValue(hash, glyph.getBoxRange());
+  // The error correction buffer only avoids allocation and does not affect the result
+  const msdfgen::ErrorCorrectionConfig &errorCorrection = attributes.config.errorCorrection;
+  msdfgen::fnvHashValue(hash, (int)attributes.config.overlapSupport);
+  msdfgen::fnvHashValue(hash, (int)errorCorrection.mode);
+  msdfgen::fnvHashValue(hash, (int)errorCorrection.distanceCheckMode);
+  msdfgen::fnvHashValue(hash, errorCorrection.minDeviationRatio);
+  msdfgen::fnvHashValue(hash, errorCorrection.minImproveRatio);
+  msdfgen::fnvHashValue(hash, (int)attributes.scanlinePass);
+  return hash;
+}
+
+GlyphBitmapCache::Stats GlyphBitmapCache::getStats() const
+{
+  Stats stats;
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.stores = stores;
+  stats.bytesRead = bytesRead;
+  stats.bytesWritten = bytesWritten;
+  return stats;
+}
+
+void GlyphBitmapCache::resetStats()
+{
+  hits = 0;
+  misses = 0;
+  stores = 0;
+  bytesRead = 0;
+  bytesWritten = 0;
+}
+
+std::string GlyphBitmapCache::entryFilename(unsigned long long key) const
+{
+  char name[24];
+  snprintf(name, sizeof(name), "%016llx.tile", key);
+  return directory + '/' + name;
+}
+
+bool GlyphBitmapCache::load(unsigned long long key, void *data, int width, int height, int channels, int channelSize)
+{
+  if (directory.empty()) return false;
+  FILE *f = nullptr;
+  errno_t err = fopen_s(&f, entryFilename(key).c_str(), "rb");
+  if (err != 0) {
+    ++misses;
+    return false;
+  }
+  size_t size = (size_t)width * height * channels * channelSize;
+  CacheEntryHeader header;
+  bool success = fread(&header, sizeof(header), 1, f) == 1 && header.magic == CACHE_ENTRY_MAGIC
+                 && header.version == CACHE_ENTRY_VERSION && header.key == key && header.width == width
+                 && header.height == height && header.channels == channels && header.channelSize == channelSize
+                 && fread(data, 1, size, f) == size;
+  fclose(f);
+  if (success) {
+    ++hits;
+    bytesRead += sizeof(header) + size;
+  } else
+    ++misses;
+  return success;
+}
+
+bool GlyphBitmapCache::store(unsigned long long key,
+  const void *data,
+  int width,
+  int height,
+  int channels,
+  int channelSize)
+{
+  if (directory.empty()) return false;
+  std::string filename = entryFilename(key);
+  char suffix[24];
+  snprintf(suffix, sizeof(suffix), ".%016llx", tempSeed + tempCounter++);
+  std::string tempFilename = filename + suffix;
+  FILE *f = nullptr;
+  errno_t err = fopen_s(&f, tempFilename.c_str(), "wb");
+  if (err != 0) return false;
+  size_t size = (size_t)width * height * channels * channelSize;
+  CacheEntryHeader header = { CACHE_ENTRY_MAGIC, CACHE_ENTRY_VERSION, key, width, height, channels, channelSize };
+  bool success = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(data, 1, size, f) == size;
+  success &= fclose(f) == 0;
+  // Renaming fails on some platforms if the entry already exists, in which case it has been stored by another writer
+  if (!(success && std::rename(tempFilename.c_str(), filename.c_str()) == 0)) {
+    std::remove(tempFilename.c_str());
+    return false;
+  }
+  ++stores;
+  bytesWritten += sizeof(header) + size;
+  return true;
+}
+}// namespace msdf_atlas
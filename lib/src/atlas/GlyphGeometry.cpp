@@ -42,6 +42,21 @@ bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, unicod
   return false;
 }
 
+void GlyphGeometry::setGeometry(int index,
+  unicode_t codepoint,
+  double geometryScale,
+  msdfgen::Shape &&shape,
+  const msdfgen::Shape::Bounds &bounds,
+  double advance)
+{
+  this->index = index;
+  this->codepoint = codepoint;
+  this->geometryScale = geometryScale;
+  this->shape = (msdfgen::Shape &&)shape;
+  this->bounds = bounds;
+  this->advance = advance;
+}
+
 void GlyphGeometry::edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long),
   double angleThreshold,
   unsigned long long seed)
@@ -60,6 +75,32 @@ void GlyphGeometry::wrapBox(double scale, double range, double miterLimit, bool
   range /= geometryScale;
   box.range = range;
   box.scale = scale;
+  box.rotated = false;
+  box.duplicate = false;
+  computeBox(box.rect.w, box.rect.h, box.translate, scale, range, miterLimit, pxAlignOriginX, pxAlignOriginY);
+}
+
+void GlyphGeometry::measureBox(int &w,
+  int &h,
+  double scale,
+  double range,
+  double miterLimit,
+  bool pxAlignOriginX,
+  bool pxAlignOriginY) const
+{
+  msdfgen::Vector2 translate;
+  computeBox(w, h, translate, scale * geometryScale, range / geometryScale, miterLimit, pxAlignOriginX, pxAlignOriginY);
+}
+
+void GlyphGeometry::computeBox(int &w,
+  int &h,
+  msdfgen::Vector2 &translate,
+  double scale,
+  double range,
+  double miterLimit,
+  bool pxAlignOriginX,
+  bool pxAlignOriginY) const
+{
   if (bounds.l < bounds.r && bounds.b < bounds.t) {
     double l = bounds.l, b = bounds.b, r = bounds.r, t = bounds.t;
     l -= .5 * range, b -= .5 * range;
@@ -68,26 +109,26 @@ void GlyphGeometry::wrapBox(double scale, double range, double miterLimit, bool
     if (pxAlignOriginX) {
       int sl = (int)floor(scale * l - .5);
       int sr = (int)ceil(scale * r + .5);
-      box.rect.w = sr - sl;
-      box.translate.x = -sl / scale;
+      w = sr - sl;
+      translate.x = -sl / scale;
     } else {
-      double w = scale * (r - l);
-      box.rect.w = (int)ceil(w) + 1;
-      box.translate.x = -l + .5 * (box.rect.w - w) / scale;
+      double sw = scale * (r - l);
+      w = (int)ceil(sw) + 1;
+      translate.x = -l + .5 * (w - sw) / scale;
     }
     if (pxAlignOriginY) {
       int sb = (int)floor(scale * b - .5);
       int st = (int)ceil(scale * t + .5);
-      box.rect.h = st - sb;
-      box.translate.y = -sb / scale;
+      h = st - sb;
+      translate.y = -sb / scale;
     } else {
-      double h = scale * (t - b);
-      box.rect.h = (int)ceil(h) + 1;
-      box.translate.y = -b + .5 * (box.rect.h - h) / scale;
+      double sh = scale * (t - b);
+      h = (int)ceil(sh) + 1;
+      translate.y = -b + .5 * (h - sh) / scale;
     }
   } else {
-    box.rect.w = 0, box.rect.h = 0;
-    box.translate = msdfgen::Vector2();
+    w = 0, h = 0;
+    translate = msdfgen::Vector2();
   }
 }
 
@@ -117,6 +158,8 @@ void GlyphGeometry::frameBox(double scale,
   range /= geometryScale;
   box.range = range;
   box.scale = scale;
+  box.rotated = false;
+  box.duplicate = false;
   box.rect.w = width;
   box.rect.h = height;
   if (fixedX && fixedY) {
@@ -154,6 +197,18 @@ void GlyphGeometry::placeBox(int x, int y) { box.rect.x = x, box.rect.y = y; }
 
 void GlyphGeometry::setBoxRect(const Rectangle &rect) { box.rect = rect; }
 
+void GlyphGeometry::setBoxPage(int page) { box.page = page; }
+
+void GlyphGeometry::setBoxRotated(bool rotated)
+{
+  if (rotated != box.rotated) {
+    std::swap(box.rect.w, box.rect.h);
+    box.rotated = rotated;
+  }
+}
+
+void GlyphGeometry::setBoxDuplicate(bool duplicate) { box.duplicate = duplicate; }
+
 int GlyphGeometry::getIndex() const { return index; }
 
 msdfgen::GlyphIndex GlyphGeometry::getGlyphIndex() const { return msdfgen::GlyphIndex(index); }
@@ -189,6 +244,20 @@ void GlyphGeometry::getBoxRect(int &x, int &y, int &w, int &h) const
 
 void GlyphGeometry::getBoxSize(int &w, int &h) const { w = box.rect.w, h = box.rect.h; }
 
+void GlyphGeometry::getBoxBitmapSize(int &w, int &h) const
+{
+  if (box.rotated)
+    w = box.rect.h, h = box.rect.w;
+  else
+    w = box.rect.w, h = box.rect.h;
+}
+
+int GlyphGeometry::getBoxPage() const { return box.page; }
+
+bool GlyphGeometry::isBoxRotated() const { return box.rotated; }
+
+bool GlyphGeometry::isBoxDuplicate() const { return box.duplicate; }
+
 double GlyphGeometry::getBoxRange() const { return box.range; }
 
 msdfgen::Projection GlyphGeometry::getBoxProjection() const
@@ -202,12 +271,14 @@ msdfgen::Vector2 GlyphGeometry::getBoxTranslate() const { return box.translate;
 
 void GlyphGeometry::getQuadPlaneBounds(double &l, double &b, double &r, double &t) const
 {
-  if (box.rect.w > 0 && box.rect.h > 0) {
+  int w, h;
+  getBoxBitmapSize(w, h);
+  if (w > 0 && h > 0) {
     double invBoxScale = 1 / box.scale;
     l = geometryScale * (-box.translate.x + .5 * invBoxScale);
     b = geometryScale * (-box.translate.y + .5 * invBoxScale);
-    r = geometryScale * (-box.translate.x + (box.rect.w - .5) * invBoxScale);
-    t = geometryScale * (-box.translate.y + (box.rect.h - .5) * invBoxScale);
+    r = geometryScale * (-box.translate.x + (w - .5) * invBoxScale);
+    t = geometryScale * (-box.translate.y + (h - .5) * invBoxScale);
   } else
     l = 0, b = 0, r = 0, t = 0;
 }
@@ -233,6 +304,8 @@ GlyphGeometry::operator GlyphBox() const
   getQuadPlaneBounds(box.bounds.l, box.bounds.b, box.bounds.r, box.bounds.t);
   box.rect.x = this->box.rect.x, box.rect.y = this->box.rect.y, box.rect.w = this->box.rect.w,
   box.rect.h = this->box.rect.h;
+  box.page = this->box.page;
+  box.rotated = this->box.rotated;
   return box;
 }
 
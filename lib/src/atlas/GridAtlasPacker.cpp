@@ -1,6 +1,9 @@
 #include <algorithm>
+#include <vector>
 
 #include "atlas/GridAtlasPacker.hpp"
+#include "atlas/Workload.hpp"
+#include "atlas/glyph-deduplication.hpp"
 
 namespace msdf_atlas {
 static int floorPOT(int x)
@@ -17,6 +20,13 @@ static int ceilPOT(int x)
   return y;
 }
 
+// Outputs the i-th of the given number of nearly equal consecutive chunks of the range [0, count)
+static void chunkRange(int &begin, int &end, int i, int chunks, int count)
+{
+  begin = (int)((long long)count * i / chunks);
+  end = (int)((long long)count * (i + 1) / chunks);
+}
+
 static bool squareConstraint(DimensionsConstraint constraint)
 {
   switch (constraint) {
@@ -78,6 +88,8 @@ void GridAtlasPacker::raiseToConstraint(int &width, int &height, DimensionsConst
   }
 }
 
+bool GridAtlasPacker::isDuplicate(int index) const { return !originals.empty() && originals[index] != index; }
+
 double GridAtlasPacker::dimensionsRating(int width, int height, bool aligned) const
 {
   return ((double)width * width + (double)height * height) * (aligned ? 1 - alignedColumnsBias : 1);
@@ -88,37 +100,73 @@ GridAtlasPacker::GridAtlasPacker()
     dimensionsConstraint(DimensionsConstraint::NONE), cellDimensionsConstraint(DimensionsConstraint::NONE),
     hFixed(false), vFixed(false), scale(-1), minScale(1), fixedX(0), fixedY(0), unitRange(0), pxRange(0), miterLimit(0),
     pxAlignOriginX(false), pxAlignOriginY(false), scaleMaximizationTolerance(.001), alignedColumnsBias(.125),
-    cutoff(false)
+    cutoff(false), deduplication(false), threadCount(1)
 {}
 
+void GridAtlasPacker::cacheBounds(BoundsCache &cache, const GlyphGeometry *glyphs, int count) const
+{
+  cache.glyphs.clear();
+  for (const GlyphGeometry *glyph = glyphs, *end = glyphs + count; glyph < end; ++glyph) {
+    if (!glyph->isWhitespace() && !isDuplicate((int)(glyph - glyphs))) {
+      GlyphBounds glyphBounds = { glyph->getGeometryScale(), &glyph->getShape(), glyph->getShapeBounds() };
+      cache.glyphs.push_back(glyphBounds);
+    }
+  }
+}
+
 msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth,
   double &maxHeight,
-  GlyphGeometry *glyphs,
-  int count,
+  const BoundsCache &cache,
   double scale,
-  double range) const
+  double range,
+  int threads) const
 {
   static const double LARGE_VALUE = 1e240;
-  msdfgen::Shape::Bounds maxBounds = { +LARGE_VALUE, +LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE };
-  for (GlyphGeometry *glyph = glyphs, *end = glyphs + count; glyph < end; ++glyph) {
-    if (!glyph->isWhitespace()) {
-      double geometryScale = glyph->getGeometryScale();
-      double shapeRange = range / geometryScale;
-      geometryScale *= scale;
-      const msdfgen::Shape::Bounds &shapeBounds = glyph->getShapeBounds();
-      double l = shapeBounds.l, b = shapeBounds.b, r = shapeBounds.r, t = shapeBounds.t;
-      l -= .5 * shapeRange, b -= .5 * shapeRange;
-      r += .5 * shapeRange, t += .5 * shapeRange;
-      if (miterLimit > 0) glyph->getShape().boundMiters(l, b, r, t, .5 * shapeRange, miterLimit, 1);
-      l *= geometryScale, b *= geometryScale;
-      r *= geometryScale, t *= geometryScale;
-      maxBounds.l = std::min(maxBounds.l, l);
-      maxBounds.b = std::min(maxBounds.b, b);
-      maxBounds.r = std::max(maxBounds.r, r);
-      maxBounds.t = std::max(maxBounds.t, t);
-      maxWidth = std::max(maxWidth, r - l);
-      maxHeight = std::max(maxHeight, t - b);
-    }
+  struct ChunkBounds
+  {
+    msdfgen::Shape::Bounds maxBounds;
+    double maxWidth, maxHeight;
+  };
+  // Minima and maxima do not depend on the order of evaluation, so the chunks' results can be simply combined
+  int chunks = std::max(std::min(threads, (int)cache.glyphs.size()), 1);
+  ChunkBounds initialBounds = { { +LARGE_VALUE, +LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE }, maxWidth, maxHeight };
+  std::vector<ChunkBounds> chunkBounds(chunks, initialBounds);
+  Workload(
+    [this, &cache, &chunkBounds, scale, range, chunks](int i, int) -> bool {
+      ChunkBounds &result = chunkBounds[i];
+      int begin, end;
+      chunkRange(begin, end, i, chunks, (int)cache.glyphs.size());
+      for (int j = begin; j < end; ++j) {
+        const GlyphBounds &glyphBounds = cache.glyphs[j];
+        double geometryScale = glyphBounds.geometryScale;
+        double shapeRange = range / geometryScale;
+        geometryScale *= scale;
+        double l = glyphBounds.shapeBounds.l, b = glyphBounds.shapeBounds.b;
+        double r = glyphBounds.shapeBounds.r, t = glyphBounds.shapeBounds.t;
+        l -= .5 * shapeRange, b -= .5 * shapeRange;
+        r += .5 * shapeRange, t += .5 * shapeRange;
+        if (miterLimit > 0) glyphBounds.shape->boundMiters(l, b, r, t, .5 * shapeRange, miterLimit, 1);
+        l *= geometryScale, b *= geometryScale;
+        r *= geometryScale, t *= geometryScale;
+        result.maxBounds.l = std::min(result.maxBounds.l, l);
+        result.maxBounds.b = std::min(result.maxBounds.b, b);
+        result.maxBounds.r = std::max(result.maxBounds.r, r);
+        result.maxBounds.t = std::max(result.maxBounds.t, t);
+        result.maxWidth = std::max(result.maxWidth, r - l);
+        result.maxHeight = std::max(result.maxHeight, t - b);
+      }
+      return true;
+    },
+    chunks)
+    .finish(chunks);
+  msdfgen::Shape::Bounds maxBounds = initialBounds.maxBounds;
+  for (const ChunkBounds &result : chunkBounds) {
+    maxBounds.l = std::min(maxBounds.l, result.maxBounds.l);
+    maxBounds.b = std::min(maxBounds.b, result.maxBounds.b);
+    maxBounds.r = std::max(maxBounds.r, result.maxBounds.r);
+    maxBounds.t = std::max(maxBounds.t, result.maxBounds.t);
+    maxWidth = std::max(maxWidth, result.maxWidth);
+    maxHeight = std::max(maxHeight, result.maxHeight);
   }
   if (maxBounds.l >= maxBounds.r || maxBounds.b >= maxBounds.t) maxBounds = msdfgen::Shape::Bounds();
   // If origin is pixel-aligned but not fixed, one pixel has to be added to max dimensions to allow for aligning the
@@ -134,13 +182,13 @@ msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth,
   return maxBounds;
 }
 
-double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs,
-  int count,
+double GridAtlasPacker::scaleToFit(const BoundsCache &cache,
   int cellWidth,
   int cellHeight,
   msdfgen::Shape::Bounds &maxBounds,
   double &maxWidth,
-  double &maxHeight) const
+  double &maxHeight,
+  int threads) const
 {
   static const int BIG_VALUE = 1 << 28;
   if (cellWidth <= 0) cellWidth = BIG_VALUE;
@@ -149,10 +197,10 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs,
                             // beyond outermost pixel centers
   cellWidth -= spacing, cellHeight -= spacing;
   bool lastResult = false;
-#define TRY_FIT(scale)                                                                                    \
-  (maxWidth = 0,                                                                                          \
-    maxHeight = 0,                                                                                        \
-    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, (scale), unitRange + pxRange / (scale)), \
+#define TRY_FIT(scale)                                                                                     \
+  (maxWidth = 0,                                                                                           \
+    maxHeight = 0,                                                                                         \
+    maxBounds = getMaxBounds(maxWidth, maxHeight, cache, (scale), unitRange + pxRange / (scale), threads), \
     lastResult = maxWidth <= cellWidth && maxHeight <= cellHeight)
   double minScale = 1, maxScale = 1;
   if (TRY_FIT(1)) {
@@ -178,6 +226,16 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs,
 int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
 {
   if (!count) return 0;
+  originals.clear();
+  if (deduplication && !findDuplicateGlyphs(originals, glyphs, count)) originals.clear();
+  // Glyph bounds are needed for many scales while searching for the layout, so the scale-invariant part is cached
+  BoundsCache cache;
+  cacheBounds(cache, glyphs, count);
+  return pack(glyphs, count, cache);
+}
+
+int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count, const BoundsCache &cache)
+{
   GridAtlasPacker initial(*this);
   int cellCount = 0;
   if (columns > 0 && rows > 0)
@@ -185,7 +243,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
   else {
     // Count non-whitespace glyphs only
     for (const GlyphGeometry *glyph = glyphs, *end = glyphs + count; glyph < end; ++glyph) {
-      if (!glyph->isWhitespace()) ++cellCount;
+      if (!glyph->isWhitespace() && !isDuplicate((int)(glyph - glyphs))) ++cellCount;
     }
     if (columns > 0)
       rows = (cellCount + columns - 1) / columns;
@@ -222,49 +280,51 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
     if (pxRange && miterLimit > 0) {
 
       if (cellWidth > 0 || cellHeight > 0) {
-        scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+        scale = scaleToFit(cache, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight, threadCount);
         if (scale < minScale) {
           scale = minScale;
           cutoff = true;
-          maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale, unitRange + pxRange / scale);
+          maxBounds = getMaxBounds(maxWidth, maxHeight, cache, scale, unitRange + pxRange / scale, threadCount);
         }
       }
 
       else if (width > 0 && height > 0) {
+        // Candidate column counts are rated concurrently, then the best one is picked in the original order
+        struct Candidate
+        {
+          int cols, width, height;
+          double scale;
+        };
+        std::vector<Candidate> candidates;
+        for (int q = (int)sqrt(cellCount) + 1; q > 0; --q) {
+          for (int cols : { q, (cellCount + q - 1) / q }) {
+            int rows = (cellCount + cols - 1) / cols;
+            Candidate candidate = { cols, (width + spacing) / cols, (height + spacing) / rows, 0 };
+            lowerToConstraint(candidate.width, candidate.height, cellDimensionsConstraint);
+            if (candidate.width > 0 && candidate.height > 0) candidates.push_back(candidate);
+          }
+        }
+        Workload(
+          [this, &cache, &candidates](int i, int) -> bool {
+            msdfgen::Shape::Bounds candidateBounds;
+            double candidateWidth, candidateHeight;
+            Candidate &candidate = candidates[i];
+            candidate.scale = scaleToFit(
+              cache, candidate.width, candidate.height, candidateBounds, candidateWidth, candidateHeight, 1);
+            return true;
+          },
+          (int)candidates.size())
+          .finish(std::max(threadCount, 1));
         double bestAlignedScale = 0;
         int bestCols = 0, bestAlignedCols = 0;
-        for (int q = (int)sqrt(cellCount) + 1; q > 0; --q) {
-          int cols = q;
-          int rows = (cellCount + cols - 1) / cols;
-          int tWidth = (width + spacing) / cols;
-          int tHeight = (height + spacing) / rows;
-          lowerToConstraint(tWidth, tHeight, cellDimensionsConstraint);
-          if (tWidth > 0 && tHeight > 0) {
-            double curScale = scaleToFit(glyphs, count, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
-            if (curScale > scale) {
-              scale = curScale;
-              bestCols = cols;
-            }
-            if (cols * tWidth == width && curScale > bestAlignedScale) {
-              bestAlignedScale = curScale;
-              bestAlignedCols = cols;
-            }
+        for (const Candidate &candidate : candidates) {
+          if (candidate.scale > scale) {
+            scale = candidate.scale;
+            bestCols = candidate.cols;
           }
-          cols = (cellCount + q - 1) / q;
-          rows = (cellCount + cols - 1) / cols;
-          tWidth = (width + spacing) / cols;
-          tHeight = (height + spacing) / rows;
-          lowerToConstraint(tWidth, tHeight, cellDimensionsConstraint);
-          if (tWidth > 0 && tHeight > 0) {
-            double curScale = scaleToFit(glyphs, count, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
-            if (curScale > scale) {
-              scale = curScale;
-              bestCols = cols;
-            }
-            if (cols * tWidth == width && curScale > bestAlignedScale) {
-              bestAlignedScale = curScale;
-              bestAlignedCols = cols;
-            }
+          if (candidate.cols * candidate.width == width && candidate.scale > bestAlignedScale) {
+            bestAlignedScale = candidate.scale;
+            bestAlignedCols = candidate.cols;
           }
         }
         if (!bestCols) return -1;
@@ -280,19 +340,20 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
         cellWidth = (width + spacing) / columns;
         cellHeight = (height + spacing) / rows;
         lowerToConstraint(cellWidth, cellHeight, cellDimensionsConstraint);
-        scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+        scale = scaleToFit(cache, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight, threadCount);
         if (scale < minScale) scale = -1;
       }
 
       if (scale <= 0) {
-        maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, minScale, unitRange + pxRange / minScale);
+        maxBounds =
+          getMaxBounds(maxWidth, maxHeight, cache, minScale, unitRange + pxRange / minScale, threadCount);
         cellWidth = (int)ceil(maxWidth) + spacing + 1;
         cellHeight = (int)ceil(maxHeight) + spacing + 1;
         raiseToConstraint(cellWidth, cellHeight, cellDimensionsConstraint);
-        scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+        scale = scaleToFit(cache, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight, threadCount);
         if (scale < minScale)
-          maxBounds =
-            getMaxBounds(maxWidth, maxHeight, glyphs, count, scale = minScale, unitRange + pxRange / minScale);
+          maxBounds = getMaxBounds(
+            maxWidth, maxHeight, cache, scale = minScale, unitRange + pxRange / minScale, threadCount);
       }
 
       if (initial.rows < 0 && initial.cellHeight < 0) {
@@ -306,7 +367,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
 
     } else {
 
-      maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, 1, unitRange);
+      maxBounds = getMaxBounds(maxWidth, maxHeight, cache, 1, unitRange, threadCount);
       int hSlack = 0, vSlack = 0;
       if (pxAlignOriginX && !hFixed) {
         maxWidth -= 1;// Added by getMaxBounds
@@ -395,7 +456,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
     }
 
   } else {
-    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale, unitRange + pxRange / scale);
+    maxBounds = getMaxBounds(maxWidth, maxHeight, cache, scale, unitRange + pxRange / scale, threadCount);
     int optimalCellWidth = (int)ceil(maxWidth) + spacing + 1;
     int optimalCellHeight = (int)ceil(maxHeight) + spacing + 1;
     if (cellWidth < 0 || cellHeight < 0) {
@@ -458,7 +519,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
       columns = initial.columns;
       rows = initial.rows;
       scale = initial.scale;
-      return pack(glyphs, count);
+      return pack(glyphs, count, cache);
     }
   }
 
@@ -480,6 +541,13 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count)
         vFixed ? &fixedY : nullptr,
         pxAlignOriginX,
         pxAlignOriginY);
+      // Duplicate glyphs share the cell of the first identical glyph
+      if (isDuplicate((int)(glyph - glyphs))) {
+        Rectangle rect = glyphs[originals[glyph - glyphs]].getBoxRect();
+        glyph->placeBox(rect.x, rect.y);
+        glyph->setBoxDuplicate(true);
+        continue;
+      }
       glyph->placeBox(col * cellWidth, height - (row + 1) * cellHeight);
       if (++col >= columns) {
         if (++row >= rows) { return end - glyph - 1; }
@@ -538,6 +606,10 @@ void GridAtlasPacker::setOriginPixelAlignment(bool alignX, bool alignY)
   pxAlignOriginX = alignX, pxAlignOriginY = alignY;
 }
 
+void GridAtlasPacker::setDeduplication(bool deduplication) { this->deduplication = deduplication; }
+
+void GridAtlasPacker::setThreadCount(int threadCount) { this->threadCount = threadCount; }
+
 void GridAtlasPacker::getDimensions(int &width, int &height) const { width = this->width, height = this->height; }
 
 void GridAtlasPacker::getCellDimensions(int &width, int &height) const { width = cellWidth, height = cellHeight; }
@@ -0,0 +1,188 @@
+#include <lodepng.h>
+
+#include "atlas/ImageStreamWriter.hpp"
+#include "core/pixel-conversion.hpp"
+#include "core/save-bmp.hpp"
+#include "core/save-tiff.hpp"
+
+namespace msdf_atlas {
+
+static bool isFormatAvailable(ImageFormat format, byte, int channels)
+{
+  switch (format) {
+  case ImageFormat::PNG:
+  case ImageFormat::TEXT:
+  case ImageFormat::BINARY:
+    return true;
+  case ImageFormat::BMP:
+    return channels != 4;
+  default:;
+  }
+  return false;
+}
+
+static bool isFormatAvailable(ImageFormat format, float, int channels)
+{
+  switch (format) {
+  case ImageFormat::PNG:
+  case ImageFormat::TIFF:
+  case ImageFormat::TEXT_FLOAT:
+  case ImageFormat::BINARY_FLOAT:
+  case ImageFormat::BINARY_FLOAT_BE:
+    return true;
+  case ImageFormat::BMP:
+    return channels != 4;
+  default:;
+  }
+  return false;
+}
+
+static byte pixelToByte(byte x) { return x; }
+
+static byte pixelToByte(float x) { return msdfgen::pixelFloatToByte(x); }
+
+static bool writeTextValue(FILE *file, byte value, bool first)
+{
+  return fprintf(file, first ? "%02X" : " %02X", (unsigned)value) > 0;
+}
+
+static bool writeTextValue(FILE *file, float value, bool first) { return fprintf(file, first ? "%g" : " %g", value) > 0; }
+
+template<typename T> static bool writeReversed(FILE *file, std::vector<byte> &buffer, const T *values, int count)
+{
+  byte *dst = buffer.data();
+  for (int i = 0; i < count; ++i) {
+    const byte *b = reinterpret_cast<const byte *>(values + i);
+    for (int j = sizeof(T) - 1; j >= 0; --j) *dst++ = b[j];
+  }
+  return fwrite(buffer.data(), sizeof(T), count, file) == (size_t)count;
+}
+
+template<typename T, int N>
+ImageStreamWriter<T, N>::ImageStreamWriter()
+  : file(nullptr), format(ImageFormat::UNSPECIFIED), bandOrder(YDirection::BOTTOM_UP), width(0), height(0),
+    rowsWritten(0), paddedWidth(0), success(false)
+{}
+
+template<typename T, int N> ImageStreamWriter<T, N>::~ImageStreamWriter()
+{
+  if (file) fclose(file);
+}
+
+template<typename T, int N>
+bool ImageStreamWriter<T, N>::open(const char *filename,
+  ImageFormat format,
+  int width,
+  int height,
+  YDirection outputYDirection)
+{
+  if (file || !isFormatAvailable(format, T(), N)) return false;
+  errno_t err = fopen_s(&file, filename, "wb");
+  if (err != 0) {
+    file = nullptr;
+    return false;
+  }
+  this->format = format;
+  this->width = width, this->height = height;
+  rowsWritten = 0;
+  success = true;
+  switch (format) {
+  case ImageFormat::PNG:
+    bandOrder = YDirection::TOP_DOWN;
+    buffer.resize((size_t)N * width * height);
+    break;
+  case ImageFormat::BMP:
+    bandOrder = YDirection::BOTTOM_UP;
+    success = msdfgen::writeBmpHeader(file, width, height, paddedWidth);
+    buffer.assign(paddedWidth, 0);
+    break;
+  case ImageFormat::TIFF:
+    bandOrder = YDirection::TOP_DOWN;
+    success = msdfgen::writeTiffHeader(file, width, height, N);
+    break;
+  case ImageFormat::BINARY_FLOAT:
+  case ImageFormat::BINARY_FLOAT_BE:
+    bandOrder = outputYDirection;
+    buffer.resize(sizeof(T) * N * width);
+    break;
+  default:
+    bandOrder = outputYDirection;
+  }
+  return success;
+}
+
+template<typename T, int N> YDirection ImageStreamWriter<T, N>::getBandOrder() const { return bandOrder; }
+
+template<typename T, int N> bool ImageStreamWriter<T, N>::writeBand(const msdfgen::BitmapConstRef<T, N> &band)
+{
+  if (!file || band.width != width || rowsWritten + band.height > height) return success = false;
+  for (int i = 0; i < band.height && success; ++i) {
+    success = writeRow(band(0, bandOrder == YDirection::TOP_DOWN ? band.height - i - 1 : i));
+    ++rowsWritten;
+  }
+  return success;
+}
+
+template<typename T, int N> bool ImageStreamWriter<T, N>::writeRow(const T *row)
+{
+  switch (format) {
+  case ImageFormat::PNG: {
+    byte *dst = buffer.data() + (size_t)N * width * rowsWritten;
+    for (int i = 0; i < N * width; ++i) dst[i] = pixelToByte(row[i]);
+    return true;
+  }
+  case ImageFormat::BMP: {
+    byte *dst = buffer.data();
+    for (int x = 0; x < width; ++x, row += N) {
+      if (N == 1) {
+        byte px = pixelToByte(*row);
+        *dst++ = px, *dst++ = px, *dst++ = px;
+      } else {
+        *dst++ = pixelToByte(row[2]);
+        *dst++ = pixelToByte(row[1]);
+        *dst++ = pixelToByte(row[0]);
+      }
+    }
+    return fwrite(buffer.data(), 1, paddedWidth, file) == (size_t)paddedWidth;
+  }
+  case ImageFormat::TEXT:
+  case ImageFormat::TEXT_FLOAT: {
+    bool ok = true;
+    for (int i = 0; i < N * width; ++i) ok &= writeTextValue(file, row[i], !i);
+    return ok && fputc('\n', file) != EOF;
+  }
+#ifdef __BIG_ENDIAN__
+  case ImageFormat::BINARY_FLOAT:
+    return writeReversed(file, buffer, row, N * width);
+#else
+  case ImageFormat::BINARY_FLOAT_BE:
+    return writeReversed(file, buffer, row, N * width);
+#endif
+  default:
+    return fwrite(row, sizeof(T), N * width, file) == (size_t)N * width;
+  }
+}
+
+template<typename T, int N> bool ImageStreamWriter<T, N>::close()
+{
+  if (!file) return false;
+  bool result = success && rowsWritten == height;
+  if (result && format == ImageFormat::PNG) {
+    std::vector<byte> png;
+    LodePNGColorType colorType = N == 1 ? LCT_GREY : N == 3 ? LCT_RGB : LCT_RGBA;
+    result = !lodepng::encode(png, buffer, width, height, colorType)
+             && fwrite(png.data(), 1, png.size(), file) == png.size();
+  }
+  result &= !fclose(file);
+  file = nullptr;
+  buffer = std::vector<byte>();
+  return result;
+}
+
+template class ImageStreamWriter<byte, 1>;
+template class ImageStreamWriter<byte, 3>;
+template class ImageStreamWriter<byte, 4>;
+template class ImageStreamWriter<float, 1>;
+template class ImageStreamWriter<float, 3>;
+template class ImageStreamWriter<float, 4>;
+}// namespace msdf_atlas
@@ -0,0 +1,226 @@
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "atlas/MappedFile.hpp"
+
+namespace msdf_atlas {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : file(INVALID_HANDLE_VALUE), mapping(nullptr), pointer(nullptr), length(0), writable(false)
+{}
+
+MappedFile::MappedFile(MappedFile &&orig)
+  : file(orig.file), mapping(orig.mapping), pointer(orig.pointer), length(orig.length), writable(orig.writable)
+{
+  orig.file = INVALID_HANDLE_VALUE;
+  orig.mapping = nullptr;
+  orig.pointer = nullptr;
+  orig.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&orig)
+{
+  if (this != &orig) {
+    close();
+    file = orig.file, mapping = orig.mapping, pointer = orig.pointer, length = orig.length, writable = orig.writable;
+    orig.file = INVALID_HANDLE_VALUE;
+    orig.mapping = nullptr;
+    orig.pointer = nullptr;
+    orig.length = 0;
+  }
+  return *this;
+}
+
+bool MappedFile::create(const char *filename, size_t size)
+{
+  close();
+  file = CreateFileA(
+    filename, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  writable = true;
+  return resize(size);
+}
+
+bool MappedFile::open(const char *filename)
+{
+  close();
+  file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    close();
+    return false;
+  }
+  writable = false;
+  length = (size_t)fileSize.QuadPart;
+  if (!map()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool MappedFile::resize(size_t size)
+{
+  if (file == INVALID_HANDLE_VALUE || !writable) return false;
+  unmap();
+  LARGE_INTEGER position;
+  position.QuadPart = (LONGLONG)size;
+  if (!(SetFilePointerEx(file, position, nullptr, FILE_BEGIN) && SetEndOfFile(file))) return false;
+  length = size;
+  return map();
+}
+
+bool MappedFile::flush()
+{
+  if (!(pointer && writable)) return file != INVALID_HANDLE_VALUE;
+  return FlushViewOfFile(pointer, length) && FlushFileBuffers(file);
+}
+
+void MappedFile::close()
+{
+  unmap();
+  if (file != INVALID_HANDLE_VALUE) {
+    CloseHandle(file);
+    file = INVALID_HANDLE_VALUE;
+  }
+  length = 0;
+}
+
+bool MappedFile::isOpen() const { return file != INVALID_HANDLE_VALUE; }
+
+bool MappedFile::map()
+{
+  if (!length) return true;
+  if (!(mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY, 0, 0, nullptr)))
+    return false;
+  pointer = (byte *)MapViewOfFile(mapping, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, length);
+  return pointer != nullptr;
+}
+
+void MappedFile::unmap()
+{
+  if (pointer) {
+    UnmapViewOfFile(pointer);
+    pointer = nullptr;
+  }
+  if (mapping) {
+    CloseHandle(mapping);
+    mapping = nullptr;
+  }
+}
+
+#else
+
+MappedFile::MappedFile() : file(-1), pointer(nullptr), length(0), writable(false) {}
+
+MappedFile::MappedFile(MappedFile &&orig)
+  : file(orig.file), pointer(orig.pointer), length(orig.length), writable(orig.writable)
+{
+  orig.file = -1;
+  orig.pointer = nullptr;
+  orig.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&orig)
+{
+  if (this != &orig) {
+    close();
+    file = orig.file, pointer = orig.pointer, length = orig.length, writable = orig.writable;
+    orig.file = -1;
+    orig.pointer = nullptr;
+    orig.length = 0;
+  }
+  return *this;
+}
+
+bool MappedFile::create(const char *filename, size_t size)
+{
+  close();
+  file = ::open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (file < 0) return false;
+  writable = true;
+  return resize(size);
+}
+
+bool MappedFile::open(const char *filename)
+{
+  close();
+  file = ::open(filename, O_RDONLY);
+  if (file < 0) return false;
+  struct stat status;
+  if (fstat(file, &status)) {
+    close();
+    return false;
+  }
+  writable = false;
+  length = (size_t)status.st_size;
+  if (!map()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+bool MappedFile::resize(size_t size)
+{
+  if (file < 0 || !writable) return false;
+  unmap();
+  if (ftruncate(file, (off_t)size)) return false;
+  length = size;
+  return map();
+}
+
+bool MappedFile::flush()
+{
+  if (!(pointer && writable)) return file >= 0;
+  return !msync(pointer, length, MS_SYNC);
+}
+
+void MappedFile::close()
+{
+  unmap();
+  if (file >= 0) {
+    ::close(file);
+    file = -1;
+  }
+  length = 0;
+}
+
+bool MappedFile::isOpen() const { return file >= 0; }
+
+bool MappedFile::map()
+{
+  if (!length) return true;
+  void *address = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+  if (address == MAP_FAILED) return false;
+  pointer = (byte *)address;
+  return true;
+}
+
+void MappedFile::unmap()
+{
+  if (pointer) {
+    munmap(pointer, length);
+    pointer = nullptr;
+  }
+}
+
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+byte *MappedFile::data() const { return pointer; }
+
+size_t MappedFile::size() const { return length; }
+}// namespace msdf_atlas
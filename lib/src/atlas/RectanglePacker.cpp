@@ -15,21 +15,18 @@ int RectanglePacker::rateFit(int w, int h, int sw, int sh) { return std::min(sw
 
 RectanglePacker::RectanglePacker() : RectanglePacker(0, 0) {}
 
-RectanglePacker::RectanglePacker(int width, int height)
+RectanglePacker::RectanglePacker(int width, int height) : width(std::max(width, 0)), height(std::max(height, 0))
 {
   if (width > 0 && height > 0) spaces.push_back(Rectangle{ 0, 0, width, height });
 }
 
 void RectanglePacker::expand(int width, int height)
 {
+  // The previous area is taken from the stored dimensions, since it may be completely occupied, leaving no spaces
   if (width > 0 && height > 0) {
-    int oldWidth = 0, oldHeight = 0;
-    for (const Rectangle &space : spaces) {
-      if (space.x + space.w > oldWidth) oldWidth = space.x + space.w;
-      if (space.y + space.h > oldHeight) oldHeight = space.y + space.h;
-    }
     spaces.push_back(Rectangle{ 0, 0, width, height });
-    splitSpace(int(spaces.size() - 1), oldWidth, oldHeight);
+    splitSpace(int(spaces.size() - 1), this->width, this->height);
+    this->width = width, this->height = height;
   }
 }
 
@@ -144,4 +141,56 @@ int RectanglePacker::pack(OrientedRectangle *rectangles, int count)
   }
   return (int)remainingRects.size();
 }
+
+void RectanglePacker::release(const Rectangle &rectangle)
+{
+  if (!(rectangle.w > 0 && rectangle.h > 0)) return;
+  Rectangle space = rectangle;
+  for (size_t i = 0; i < spaces.size();) {
+    const Rectangle &other = spaces[i];
+    if (other.x == space.x && other.w == space.w && (other.y + other.h == space.y || space.y + space.h == other.y)) {
+      space.y = std::min(space.y, other.y);
+      space.h += other.h;
+    } else if (other.y == space.y && other.h == space.h
+               && (other.x + other.w == space.x || space.x + space.w == other.x)) {
+      space.x = std::min(space.x, other.x);
+      space.w += other.w;
+    } else {
+      ++i;
+      continue;
+    }
+    // The grown space may now be adjacent to spaces which have already been checked
+    removeFromUnorderedVector(spaces, i);
+    i = 0;
+  }
+  spaces.push_back(space);
+}
+
+void RectanglePacker::occupy(const Rectangle &rectangle)
+{
+  for (size_t i = 0; i < spaces.size();) {
+    Rectangle space = spaces[i];
+    int l = std::max(space.x, rectangle.x), r = std::min(space.x + space.w, rectangle.x + rectangle.w);
+    int b = std::max(space.y, rectangle.y), t = std::min(space.y + space.h, rectangle.y + rectangle.h);
+    if (!(l < r && b < t)) {
+      ++i;
+      continue;
+    }
+    removeFromUnorderedVector(spaces, i);
+    // Split the remainder of the space into up to four pieces, keeping either the side or the top and bottom pieces
+    // whole, whichever leaves the larger piece
+    Rectangle left = { space.x, space.y, l - space.x, space.h };
+    Rectangle right = { r, space.y, space.x + space.w - r, space.h };
+    Rectangle bottom = { l, space.y, r - l, b - space.y };
+    Rectangle top = { l, t, r - l, space.y + space.h - t };
+    if (std::max(left.w, right.w) * space.h < std::max(bottom.h, top.h) * space.w) {
+      left.y = b, left.h = t - b;
+      right.y = b, right.h = t - b;
+      bottom.x = space.x, bottom.w = space.w;
+      top.x = space.x, top.w = space.w;
+    }
+    for (const Rectangle &piece : { left, right, bottom, top })
+      if (piece.w > 0 && piece.h > 0) spaces.push_back(piece);
+  }
+}
 }// namespace msdf_atlas
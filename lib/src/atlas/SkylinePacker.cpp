@@ -0,0 +1,127 @@
+#include <algorithm>
+
+#include "atlas/SkylinePacker.hpp"
+
+namespace msdf_atlas {
+
+SkylinePacker::SkylinePacker() : SkylinePacker(0, 0) {}
+
+SkylinePacker::SkylinePacker(int width, int height) : width(std::max(width, 0)), height(std::max(height, 0))
+{
+  if (width > 0 && height > 0) skyline.push_back(Segment{ 0, 0, width });
+}
+
+void SkylinePacker::expand(int width, int height)
+{
+  if (width > 0 && height > 0) {
+    if (width > this->width) {
+      if (!skyline.empty() && skyline.back().y == 0)
+        skyline.back().w += width - this->width;
+      else
+        skyline.push_back(Segment{ this->width, 0, width - this->width });
+    }
+    this->width = width, this->height = height;
+  }
+}
+
+bool SkylinePacker::findPosition(Position &position, int w, int h) const
+{
+  // Bottom-left rule - the lowest top edge wins, ties are broken by the narrowest supporting segment
+  int bestTop = height + 1, bestWidth = 0;
+  for (int i = 0; i < (int)skyline.size(); ++i) {
+    int x = skyline[i].x;
+    if (x + w > width) break;
+    int y = skyline[i].y;
+    for (int j = i + 1; j < (int)skyline.size() && skyline[j].x < x + w; ++j) y = std::max(y, skyline[j].y);
+    if (y + h < bestTop || (y + h == bestTop && skyline[i].w < bestWidth)) {
+      position.segment = i;
+      position.x = x;
+      position.y = y;
+      bestTop = y + h;
+      bestWidth = skyline[i].w;
+    }
+  }
+  return bestTop <= height;
+}
+
+void SkylinePacker::place(const Position &position, int w, int h)
+{
+  if (!(w > 0 && h > 0)) return;
+  int i = position.segment;
+  skyline.insert(skyline.begin() + i, Segment{ position.x, position.y + h, w });
+  // Cut the segments which are now covered by the new one
+  for (int j = i + 1; j < (int)skyline.size();) {
+    Segment &segment = skyline[j];
+    int overlap = position.x + w - segment.x;
+    if (overlap <= 0) break;
+    if (overlap < segment.w) {
+      segment.x += overlap;
+      segment.w -= overlap;
+      break;
+    }
+    skyline.erase(skyline.begin() + j);
+  }
+  // Merge with neighboring segments of the same height
+  if (i + 1 < (int)skyline.size() && skyline[i + 1].y == skyline[i].y) {
+    skyline[i].w += skyline[i + 1].w;
+    skyline.erase(skyline.begin() + i + 1);
+  }
+  if (i > 0 && skyline[i - 1].y == skyline[i].y) {
+    skyline[i - 1].w += skyline[i].w;
+    skyline.erase(skyline.begin() + i);
+  }
+}
+
+int SkylinePacker::pack(Rectangle *rectangles, int count)
+{
+  std::vector<int> order(count);
+  for (int i = 0; i < count; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [rectangles](int a, int b) {
+    return rectangles[a].h > rectangles[b].h
+           || (rectangles[a].h == rectangles[b].h && rectangles[a].w > rectangles[b].w);
+  });
+  int remaining = 0;
+  for (int index : order) {
+    Rectangle &rect = rectangles[index];
+    Position position;
+    if (findPosition(position, rect.w, rect.h)) {
+      rect.x = position.x;
+      rect.y = position.y;
+      place(position, rect.w, rect.h);
+    } else
+      ++remaining;
+  }
+  return remaining;
+}
+
+int SkylinePacker::pack(OrientedRectangle *rectangles, int count)
+{
+  std::vector<int> order(count);
+  for (int i = 0; i < count; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [rectangles](int a, int b) {
+    int aMax = std::max(rectangles[a].w, rectangles[a].h), bMax = std::max(rectangles[b].w, rectangles[b].h);
+    int aMin = std::min(rectangles[a].w, rectangles[a].h), bMin = std::min(rectangles[b].w, rectangles[b].h);
+    return aMax > bMax || (aMax == bMax && aMin > bMin);
+  });
+  int remaining = 0;
+  for (int index : order) {
+    OrientedRectangle &rect = rectangles[index];
+    Position position, rotatedPosition;
+    bool fits = findPosition(position, rect.w, rect.h);
+    bool rotatedFits = rect.w != rect.h && findPosition(rotatedPosition, rect.h, rect.w);
+    if (rotatedFits && (!fits || rotatedPosition.y + rect.w < position.y + rect.h)) {
+      rect.x = rotatedPosition.x;
+      rect.y = rotatedPosition.y;
+      rect.rotated = true;
+      place(rotatedPosition, rect.h, rect.w);
+    } else if (fits) {
+      rect.x = position.x;
+      rect.y = position.y;
+      rect.rotated = false;
+      place(position, rect.w, rect.h);
+    } else
+      ++remaining;
+  }
+  return remaining;
+}
+}// namespace msdf_atlas
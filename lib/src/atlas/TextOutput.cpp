@@ -0,0 +1,70 @@
+#include <charconv>
+#include <cstring>
+
+#include "atlas/TextOutput.hpp"
+
+namespace msdf_atlas {
+#define TEXT_OUTPUT_BLOCK_SIZE 0x100000
+
+TextOutput::TextOutput() : file(nullptr), failed(false) {}
+
+TextOutput::TextOutput(FILE *file) : file(file), failed(false) { buffer.reserve(TEXT_OUTPUT_BLOCK_SIZE + 256); }
+
+void TextOutput::write(char c)
+{
+  buffer.push_back(c);
+  flushIfFull();
+}
+
+void TextOutput::write(const char *str) { write(str, strlen(str)); }
+
+void TextOutput::write(const char *str, size_t length)
+{
+  buffer.append(str, length);
+  flushIfFull();
+}
+
+void TextOutput::write(const std::string &str) { write(str.data(), str.size()); }
+
+void TextOutput::write(const TextOutput &output) { write(output.buffer); }
+
+void TextOutput::writeInt(int value)
+{
+  char str[16];
+  write(str, std::to_chars(str, str + sizeof(str), value).ptr - str);
+}
+
+void TextOutput::writeUnsigned(unsigned value)
+{
+  char str[16];
+  write(str, std::to_chars(str, str + sizeof(str), value).ptr - str);
+}
+
+void TextOutput::writeDouble(double value)
+{
+  char str[32];
+  write(str, std::to_chars(str, str + sizeof(str), value).ptr - str);
+}
+
+bool TextOutput::flush()
+{
+  if (file && !buffer.empty()) {
+    failed |= fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size();
+    buffer.clear();
+  }
+  return !failed;
+}
+
+const std::string &TextOutput::getBuffer() const { return buffer; }
+
+void TextOutput::takeBuffer(std::string &output)
+{
+  output = (std::string &&)buffer;
+  buffer.clear();
+}
+
+void TextOutput::flushIfFull()
+{
+  if (file && buffer.size() >= TEXT_OUTPUT_BLOCK_SIZE) flush();
+}
+}// namespace msdf_atlas
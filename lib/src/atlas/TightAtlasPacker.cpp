@@ -1,38 +1,66 @@
+#include <algorithm>
+#include <functional>
 #include <vector>
 
 #include "atlas/Rectangle.hpp"
 #include "atlas/TightAtlasPacker.hpp"
+#include "atlas/Workload.hpp"
+#include "atlas/glyph-deduplication.hpp"
 #include "atlas/rectangle-packing.hpp"
 #include "atlas/size-selectors.hpp"
 
 namespace msdf_atlas {
 TightAtlasPacker::TightAtlasPacker()
-  : width(-1), height(-1), spacing(0), dimensionsConstraint(DimensionsConstraint::POWER_OF_TWO_SQUARE), scale(-1),
-    minScale(1), unitRange(0), pxRange(0), miterLimit(0), pxAlignOriginX(false), pxAlignOriginY(false),
-    scaleMaximizationTolerance(.001)
+  : width(-1), height(-1), maxPageWidth(-1), maxPageHeight(-1), pageCount(1), spacing(0),
+    dimensionsConstraint(DimensionsConstraint::POWER_OF_TWO_SQUARE), packingAlgorithm(PackingAlgorithm::GUILLOTINE),
+    rotationAllowed(false), deduplication(false), scale(-1), minScale(1), unitRange(0), pxRange(0), miterLimit(0),
+    pxAlignOriginX(false), pxAlignOriginY(false), scaleMaximizationTolerance(.001), threadCount(1)
 {}
 
+static bool isRectangleRotated(const Rectangle &) { return false; }
+
+static bool isRectangleRotated(const OrientedRectangle &rect) { return rect.rotated; }
+
+static bool rectangleFits(const Rectangle &rect, int width, int height)
+{
+  return rect.w <= width && rect.h <= height;
+}
+
+static bool rectangleFits(const OrientedRectangle &rect, int width, int height)
+{
+  return (rect.w <= width && rect.h <= height) || (rect.h <= width && rect.w <= height);
+}
+
+bool TightAtlasPacker::isDuplicate(int index) const { return !originals.empty() && originals[index] != index; }
+
+template<class Packer, typename RectangleType>
 int TightAtlasPacker::tryPack(GlyphGeometry *glyphs,
   int count,
   DimensionsConstraint dimensionsConstraint,
   int &width,
   int &height,
-  double scale) const
+  double scale,
+  int &pageCount,
+  int maxPages) const
 {
   double range = unitRange + pxRange / scale;
+  pageCount = 1;
   // Wrap glyphs into boxes
-  std::vector<Rectangle> rectangles;
+  std::vector<RectangleType> rectangles;
   std::vector<GlyphGeometry *> rectangleGlyphs;
   rectangles.reserve(count);
   rectangleGlyphs.reserve(count);
+  long long totalArea = 0;
   for (GlyphGeometry *glyph = glyphs, *end = glyphs + count; glyph < end; ++glyph) {
+    glyph->setBoxPage(0);
     if (!glyph->isWhitespace()) {
-      Rectangle rect = {};
+      RectangleType rect = {};
       glyph->wrapBox(scale, range, miterLimit, pxAlignOriginX, pxAlignOriginY);
       glyph->getBoxSize(rect.w, rect.h);
-      if (rect.w > 0 && rect.h > 0) {
+      if (rect.w > 0 && rect.h > 0 && !isDuplicate((int)(glyph - glyphs))) {
         rectangles.push_back(rect);
         rectangleGlyphs.push_back(glyph);
+        totalArea += (long long)(rect.w + spacing) * (rect.h + spacing);
       }
     }
   }
@@ -42,81 +70,271 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs,
     return 0;
   }
   // Box rectangle packing
+  std::vector<int> pages(rectangles.size(), 0);
+  if (int result = packBoxes<Packer>(rectangles.data(),
+        pages.data(),
+        rectangles.size(),
+        totalArea,
+        dimensionsConstraint,
+        width,
+        height,
+        pageCount,
+        maxPages))
+    return result;
+  for (size_t i = 0; i < rectangles.size(); ++i) {
+    rectangleGlyphs[i]->setBoxPage(pages[i]);
+    rectangleGlyphs[i]->setBoxRotated(isRectangleRotated(rectangles[i]));
+  }
+  // Set glyph box placement
+  for (size_t i = 0; i < rectangles.size(); ++i) {
+    int w, h;
+    rectangleGlyphs[i]->getBoxSize(w, h);
+    rectangleGlyphs[i]->placeBox(rectangles[i].x, height - (rectangles[i].y + h));
+  }
+  // Duplicate glyphs share the box of the first identical glyph
+  for (int i = 0; i < count; ++i) {
+    if (isDuplicate(i)) {
+      const GlyphGeometry &original = glyphs[originals[i]];
+      Rectangle rect = original.getBoxRect();
+      glyphs[i].setBoxPage(original.getBoxPage());
+      glyphs[i].setBoxRotated(original.isBoxRotated());
+      glyphs[i].placeBox(rect.x, rect.y);
+      glyphs[i].setBoxDuplicate(true);
+    }
+  }
+  return 0;
+}
+
+template<class Packer, typename RectangleType>
+int TightAtlasPacker::packBoxes(RectangleType *rectangles,
+  int *pages,
+  int count,
+  long long totalArea,
+  DimensionsConstraint dimensionsConstraint,
+  int &width,
+  int &height,
+  int &pageCount,
+  int maxPages) const
+{
+  bool paged = maxPageWidth > 0 && maxPageHeight > 0;
   if (width < 0 || height < 0) {
     std::pair<int, int> dimensions = std::make_pair(width, height);
-    switch (dimensionsConstraint) {
-    case DimensionsConstraint::POWER_OF_TWO_SQUARE:
-      dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
-      break;
-    case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
-      dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
-      break;
-    case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
-      dimensions = packRectangles<SquareSizeSelector<4>>(rectangles.data(), rectangles.size(), spacing);
-      break;
-    case DimensionsConstraint::EVEN_SQUARE:
-      dimensions = packRectangles<SquareSizeSelector<2>>(rectangles.data(), rectangles.size(), spacing);
-      break;
-    case DimensionsConstraint::SQUARE:
-    default:
-      dimensions = packRectangles<SquareSizeSelector<>>(rectangles.data(), rectangles.size(), spacing);
-      break;
+    // Don't look for single page dimensions if the boxes obviously cannot fit into one page
+    if (!paged || totalArea <= (long long)(maxPageWidth + spacing) * (maxPageHeight + spacing)) {
+      switch (dimensionsConstraint) {
+      case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+        dimensions = packRectangles<SquarePowerOfTwoSizeSelector, Packer>(rectangles, count, spacing);
+        break;
+      case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+        dimensions = packRectangles<PowerOfTwoSizeSelector, Packer>(rectangles, count, spacing);
+        break;
+      case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+        dimensions = packRectangles<SquareSizeSelector<4>, Packer>(rectangles, count, spacing);
+        break;
+      case DimensionsConstraint::EVEN_SQUARE:
+        dimensions = packRectangles<SquareSizeSelector<2>, Packer>(rectangles, count, spacing);
+        break;
+      case DimensionsConstraint::SQUARE:
+      default:
+        dimensions = packRectangles<SquareSizeSelector<>, Packer>(rectangles, count, spacing);
+        break;
+      }
     }
-    if (!(dimensions.first > 0 && dimensions.second > 0)) return -1;
-    width = dimensions.first, height = dimensions.second;
-  } else {
-    if (int result = packRectangles(rectangles.data(), rectangles.size(), width, height, spacing)) return result;
+    if (dimensions.first > 0 && dimensions.second > 0
+        && !(paged && (dimensions.first > maxPageWidth || dimensions.second > maxPageHeight))) {
+      width = dimensions.first, height = dimensions.second;
+      paged = false;
+    } else if (paged)
+      width = maxPageWidth, height = maxPageHeight;
+    else
+      return -1;
+  } else if (!paged) {
+    if (int result = packRectangles<Packer>(rectangles, count, width, height, spacing)) return result;
   }
-  // Set glyph box placement
-  for (size_t i = 0; i < rectangles.size(); ++i)
-    rectangleGlyphs[i]->placeBox(rectangles[i].x, height - (rectangles[i].y + rectangles[i].h));
+  if (paged) return packRectanglePages<Packer>(rectangles, pages, count, width, height, pageCount, spacing, maxPages);
   return 0;
 }
 
-double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) const
+template<class Packer, typename RectangleType>
+bool TightAtlasPacker::tryScale(const GlyphGeometry *glyphs,
+  int count,
+  int width,
+  int height,
+  double scale,
+  int maxPages,
+  std::vector<RectangleType> &rectangles,
+  std::vector<int> &pages) const
+{
+  // Same as tryPack with fixed dimensions, except that the glyphs are left untouched and the packing is skipped
+  // if the boxes obviously cannot fit
+  double range = unitRange + pxRange / scale;
+  bool paged = maxPageWidth > 0 && maxPageHeight > 0;
+  long long areaLimit = (long long)(width + spacing) * (height + spacing);
+  if (paged) areaLimit = maxPages > 0 ? maxPages * areaLimit : -1;
+  rectangles.clear();
+  long long totalArea = 0;
+  for (const GlyphGeometry *glyph = glyphs, *end = glyphs + count; glyph < end; ++glyph) {
+    if (!glyph->isWhitespace() && !isDuplicate((int)(glyph - glyphs))) {
+      RectangleType rect = {};
+      glyph->measureBox(rect.w, rect.h, scale, range, miterLimit, pxAlignOriginX, pxAlignOriginY);
+      if (rect.w > 0 && rect.h > 0) {
+        if (!rectangleFits(rect, width, height)) return false;
+        totalArea += (long long)(rect.w + spacing) * (rect.h + spacing);
+        if (areaLimit >= 0 && totalArea > areaLimit) return false;
+        rectangles.push_back(rect);
+      }
+    }
+  }
+  if (rectangles.empty()) return true;
+  pages.resize(rectangles.size());
+  int pageCount = 1;
+  return !packBoxes<Packer>(rectangles.data(),
+    pages.data(),
+    rectangles.size(),
+    totalArea,
+    DimensionsConstraint(),
+    width,
+    height,
+    pageCount,
+    maxPages);
+}
+
+template<class Packer, typename RectangleType>
+double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count, int &pageCount) const
 {
-  bool lastResult = false;
   int w = width, h = height;
-#define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), w, h, (scale)))
+  // The number of pages must not increase while the scale is being maximized
+  int maxPages = pageCount;
+  int threads = std::max(threadCount, 1);
+  // Each round, the scales the serial search would try next are evaluated concurrently (speculatively),
+  // then the search advances by as many steps as are covered, so the result is the same for any number of threads
+  std::vector<double> scales;
+  std::vector<char> results;
+  std::vector<std::vector<RectangleType>> rectangleBuffers(threads);
+  std::vector<std::vector<int>> pageBuffers(threads);
+  auto evaluate = [&]() {
+    results.assign(scales.size(), false);
+    Workload(
+      [&](int i, int threadNo) -> bool {
+        results[i] = tryScale<Packer>(
+          glyphs, count, w, h, scales[i], maxPages, rectangleBuffers[threadNo], pageBuffers[threadNo]);
+        return true;
+      },
+      scales.size())
+      .finish(threads);
+  };
   double minScale = 1, maxScale = 1;
-  if (TRY_PACK(1)) {
-    while (maxScale < 1e+32 && ((maxScale = 2 * minScale), TRY_PACK(maxScale))) minScale = maxScale;
+  scales.assign(1, 1.);
+  evaluate();
+  if (results[0]) {
+    // Keep doubling the scale until it no longer fits
+    for (;;) {
+      scales.clear();
+      for (double s = minScale; (int)scales.size() < threads && s < 1e+32;) scales.push_back(s *= 2);
+      if (scales.empty()) break;
+      evaluate();
+      size_t i = 0;
+      while (i < scales.size() && results[i]) minScale = maxScale = scales[i++];
+      if (i < scales.size()) {
+        maxScale = scales[i];
+        break;
+      }
+    }
   } else {
-    while (minScale > 1e-32 && ((minScale = .5 * maxScale), !TRY_PACK(minScale))) maxScale = minScale;
+    // Keep halving the scale until it fits
+    for (;;) {
+      scales.clear();
+      for (double s = maxScale; (int)scales.size() < threads && s > 1e-32;) scales.push_back(s *= .5);
+      if (scales.empty()) break;
+      evaluate();
+      size_t i = 0;
+      while (i < scales.size() && !results[i]) minScale = maxScale = scales[i++];
+      if (i < scales.size()) {
+        minScale = scales[i];
+        break;
+      }
+    }
   }
   if (minScale == maxScale) return 0;
+  // Bisection - each round evaluates a complete tree of the next midpoints of the given depth in pre-order,
+  // where the subtree following a successful midpoint comes before the one following a failed midpoint
+  int depth = 1;
+  while ((2 << depth) - 1 <= threads) ++depth;
+  std::function<void(double, double, int)> addMidpoints = [&](double lo, double hi, int level) {
+    if (level > 0) {
+      double mid = .5 * (lo + hi);
+      scales.push_back(mid);
+      addMidpoints(mid, hi, level - 1);
+      addMidpoints(lo, mid, level - 1);
+    }
+  };
   while (minScale / maxScale < 1 - scaleMaximizationTolerance) {
-    double midScale = .5 * (minScale + maxScale);
-    if (TRY_PACK(midScale))
-      minScale = midScale;
-    else
-      maxScale = midScale;
+    scales.clear();
+    addMidpoints(minScale, maxScale, depth);
+    evaluate();
+    for (int level = depth, i = 0; level > 0 && minScale / maxScale < 1 - scaleMaximizationTolerance; --level) {
+      if (results[i]) {
+        minScale = scales[i];
+        i += 1;
+      } else {
+        maxScale = scales[i];
+        i += 1 << (level - 1);
+      }
+    }
   }
-  if (!lastResult) TRY_PACK(minScale);
+  tryPack<Packer, RectangleType>(glyphs, count, DimensionsConstraint(), w, h, minScale, pageCount, maxPages);
   return minScale;
 }
 
-int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count)
+template<class Packer, typename RectangleType> int TightAtlasPacker::packGlyphs(GlyphGeometry *glyphs, int count)
 {
+  originals.clear();
+  if (deduplication && !findDuplicateGlyphs(originals, glyphs, count)) originals.clear();
   double initialScale = scale > 0 ? scale : minScale;
   if (initialScale > 0) {
-    if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale)) return remaining;
+    if (int remaining = tryPack<Packer, RectangleType>(
+          glyphs, count, dimensionsConstraint, width, height, initialScale, pageCount, 0))
+      return remaining;
   } else if (width < 0 || height < 0)
     return -1;
-  if (scale <= 0) scale = packAndScale(glyphs, count);
+  if (scale <= 0) scale = packAndScale<Packer, RectangleType>(glyphs, count, pageCount);
   if (scale <= 0) return -1;
   return 0;
 }
 
+int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count)
+{
+  if (packingAlgorithm == PackingAlgorithm::SKYLINE) {
+    return rotationAllowed ? packGlyphs<SkylinePacker, OrientedRectangle>(glyphs, count)
+                           : packGlyphs<SkylinePacker, Rectangle>(glyphs, count);
+  }
+  return rotationAllowed ? packGlyphs<RectanglePacker, OrientedRectangle>(glyphs, count)
+                         : packGlyphs<RectanglePacker, Rectangle>(glyphs, count);
+}
+
 void TightAtlasPacker::setDimensions(int width, int height) { this->width = width, this->height = height; }
 
 void TightAtlasPacker::unsetDimensions() { width = -1, height = -1; }
 
+void TightAtlasPacker::setMaximumPageDimensions(int width, int height)
+{
+  maxPageWidth = width, maxPageHeight = height;
+}
+
 void TightAtlasPacker::setDimensionsConstraint(DimensionsConstraint dimensionsConstraint)
 {
   this->dimensionsConstraint = dimensionsConstraint;
 }
 
+void TightAtlasPacker::setPackingAlgorithm(PackingAlgorithm packingAlgorithm)
+{
+  this->packingAlgorithm = packingAlgorithm;
+}
+
+void TightAtlasPacker::setRotationAllowed(bool allowRotation) { rotationAllowed = allowRotation; }
+
+void TightAtlasPacker::setDeduplication(bool deduplication) { this->deduplication = deduplication; }
+
 void TightAtlasPacker::setSpacing(int spacing) { this->spacing = spacing; }
 
 void TightAtlasPacker::setScale(double scale) { this->scale = scale; }
@@ -136,8 +354,12 @@ void TightAtlasPacker::setOriginPixelAlignment(bool alignX, bool alignY)
   pxAlignOriginX = alignX, pxAlignOriginY = alignY;
 }
 
+void TightAtlasPacker::setThreadCount(int threadCount) { this->threadCount = threadCount; }
+
 void TightAtlasPacker::getDimensions(int &width, int &height) const { width = this->width, height = this->height; }
 
+int TightAtlasPacker::getPageCount() const { return pageCount; }
+
 double TightAtlasPacker::getScale() const { return scale; }
 
 double TightAtlasPacker::getPixelRange() const { return pxRange + scale * unitRange; }
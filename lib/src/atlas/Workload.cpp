@@ -1,11 +1,70 @@
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
 #include "atlas/Workload.hpp"
 
 namespace msdf_atlas {
+/// Threads that are kept alive and reused by all workloads
+class WorkerPool
+{
+
+public:
+  static WorkerPool &instance()
+  {
+    static WorkerPool pool;
+    return pool;
+  }
+
+  ~WorkerPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    condition.notify_all();
+    for (std::thread &thread : threads) thread.join();
+  }
+
+  /// Queues a task to be run by one of the pool's threads, which are added as needed up to threadCount
+  void submit(std::function<void()> &&task, int threadCount)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      tasks.push_back((std::function<void()> &&)task);
+      while ((int)threads.size() < threadCount) threads.emplace_back(&WorkerPool::run, this);
+    }
+    condition.notify_one();
+  }
+
+private:
+  std::mutex mutex;
+  std::condition_variable condition;
+  std::deque<std::function<void()>> tasks;
+  std::vector<std::thread> threads;
+  bool stopping = false;
+
+  void run()
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+      condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+      if (tasks.empty()) return;
+      std::function<void()> task = (std::function<void()> &&)tasks.front();
+      tasks.pop_front();
+      lock.unlock();
+      task();
+      lock.lock();
+    }
+  }
+};
+
 Workload::Workload() : chunks(0) {}
 
 Workload::Workload(const std::function<bool(int, int)> &workerFunction, int chunks)
@@ -21,18 +80,65 @@ bool Workload::finishSequential()
 
 bool Workload::finishParallel(int threadCount)
 {
-  bool result = true;
-  std::atomic<int> next(0);
-  std::function<void(int)> threadWorker = [this, &result, &next](int threadNo) {
-    for (int i = next++; result && i < chunks; i = next++) {
-      if (!workerFunction(i, threadNo)) result = false;
+  // Helper tasks may only get to run after the calling thread has processed all chunks (e.g. if the pool is busy
+  // with other workloads), in which case they must not touch the workload anymore
+  struct State
+  {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::atomic<int> next{ 0 }, nextThreadNo{ 1 };
+    std::atomic<bool> result{ true };
+    int activeHelpers = 0;
+    bool closed = false;
+    /// The first exception thrown by any thread, which is rethrown once all helpers are done
+    std::exception_ptr exception;
+
+    void fail(std::exception_ptr &&e)
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!exception) exception = (std::exception_ptr &&)e;
+      result = false;
     }
   };
-  std::vector<std::thread> threads;
-  threads.reserve(threadCount);
-  for (int i = 0; i < threadCount; ++i) threads.emplace_back(threadWorker, i);
-  for (std::thread &thread : threads) thread.join();
-  return result;
+  std::shared_ptr<State> state = std::make_shared<State>();
+  std::function<void(int)> threadWorker = [this, state](int threadNo) {
+    for (int i = state->next++; state->result && i < chunks; i = state->next++) {
+      try {
+        if (!workerFunction(i, threadNo)) state->result = false;
+      } catch (...) {
+        state->fail(std::current_exception());
+      }
+    }
+  };
+  for (int i = 1; i < threadCount; ++i) {
+    try {
+      WorkerPool::instance().submit(
+        [state, threadWorker]() {
+          {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->closed) return;
+            ++state->activeHelpers;
+          }
+          threadWorker(state->nextThreadNo++);
+          {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            --state->activeHelpers;
+          }
+          state->condition.notify_all();
+        },
+        threadCount - 1);
+    } catch (...) {
+      // The calling thread still processes the chunks and waits for the helpers submitted so far
+      state->fail(std::current_exception());
+      break;
+    }
+  }
+  threadWorker(0);
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->closed = true;
+  state->condition.wait(lock, [&state]() { return !state->activeHelpers; });
+  if (state->exception) std::rethrow_exception(state->exception);
+  return state->result;
 }
 
 bool Workload::finish(int threadCount)
@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "atlas/BinaryLayout.hpp"
+#include "atlas/GlyphGeometry.hpp"
+#include "atlas/binary-layout-export.hpp"
+#include "core/save-file.hpp"
+
+namespace msdf_atlas {
+struct KerningEntry
+{
+  uint32_t identifier1, identifier2;
+  double advance;
+};
+
+static size_t alignSize(size_t size) { return (size + 7) & ~(size_t)7; }
+
+static void putU32(byte *dst, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) dst[i] = (byte)(value >> 8 * i);
+}
+
+static void putU64(byte *dst, uint64_t value)
+{
+  for (int i = 0; i < 8; ++i) dst[i] = (byte)(value >> 8 * i);
+}
+
+static void putF64(byte *dst, double value)
+{
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  putU64(dst, bits);
+}
+
+void exportBinaryLayout(std::vector<byte> &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  bool kerning)
+{
+  bool topDown = metrics.yDirection == YDirection::TOP_DOWN;
+  output.assign(BinaryLayout::HEADER_SIZE + BinaryLayout::FONT_RECORD_SIZE * fontCount, 0);
+
+  // Header
+  {
+    byte *header = output.data();
+    memcpy(header, "MSDFBLAY", 8);
+    putU32(header + 8, BinaryLayout::VERSION);
+    uint32_t flags = topDown ? (uint32_t)BinaryLayout::Y_TOP_DOWN : 0u;
+    putU32(header + 16, (uint32_t)imageType);
+    putU32(header + 20, (uint32_t)fontCount);
+    putF64(header + 24, metrics.distanceRange);
+    putF64(header + 32, metrics.size);
+    putU32(header + 40, (uint32_t)metrics.width);
+    putU32(header + 44, (uint32_t)metrics.height);
+    putU32(header + 48, (uint32_t)metrics.pageCount);
+    if (metrics.grid) {
+      flags |= BinaryLayout::GRID;
+      putU32(header + 52, (uint32_t)metrics.grid->cellWidth);
+      putU32(header + 56, (uint32_t)metrics.grid->cellHeight);
+      putU32(header + 60, (uint32_t)metrics.grid->columns);
+      putU32(header + 64, (uint32_t)metrics.grid->rows);
+      if (metrics.grid->originX) {
+        flags |= BinaryLayout::GRID_ORIGIN_X;
+        putF64(header + 72, *metrics.grid->originX);
+      }
+      if (metrics.grid->originY) {
+        flags |= BinaryLayout::GRID_ORIGIN_Y;
+        putF64(header + 80,
+          topDown ? (metrics.grid->cellHeight - metrics.grid->spacing - 1) / metrics.size - *metrics.grid->originY
+                  : *metrics.grid->originY);
+      }
+    }
+    putU32(header + 12, flags);
+    putU64(header + 88, BinaryLayout::HEADER_SIZE);
+  }
+
+  std::vector<const GlyphGeometry *> glyphs;
+  std::vector<KerningEntry> kerningEntries;
+  for (int i = 0; i < fontCount; ++i) {
+    const FontGeometry &font = fonts[i];
+    GlyphIdentifierType identifierType = font.getPreferredIdentifierType();
+    auto identifier = [identifierType](const GlyphGeometry &glyph) -> uint32_t {
+      return identifierType == GlyphIdentifierType::UNICODE_CODEPOINT ? glyph.getCodepoint()
+                                                                       : (uint32_t)glyph.getIndex();
+    };
+
+    // Glyphs sorted by identifier
+    glyphs.clear();
+    for (const GlyphGeometry &glyph : font.getGlyphs()) glyphs.push_back(&glyph);
+    std::stable_sort(glyphs.begin(), glyphs.end(), [&](const GlyphGeometry *a, const GlyphGeometry *b) {
+      return identifier(*a) < identifier(*b);
+    });
+
+    // Kerning pairs sorted by identifiers
+    kerningEntries.clear();
+    if (kerning) {
+      for (const std::pair<const std::pair<int, int>, double> &kernPair : font.getKerning()) {
+        if (identifierType == GlyphIdentifierType::UNICODE_CODEPOINT) {
+          const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
+          const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
+          if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint())
+            kerningEntries.push_back(KerningEntry{ glyph1->getCodepoint(), glyph2->getCodepoint(), kernPair.second });
+        } else
+          kerningEntries.push_back(
+            KerningEntry{ (uint32_t)kernPair.first.first, (uint32_t)kernPair.first.second, kernPair.second });
+      }
+      // Pairs of glyph indices are already sorted
+      if (identifierType == GlyphIdentifierType::UNICODE_CODEPOINT) {
+        std::sort(kerningEntries.begin(), kerningEntries.end(), [](const KerningEntry &a, const KerningEntry &b) {
+          return a.identifier1 < b.identifier1 || (a.identifier1 == b.identifier1 && a.identifier2 < b.identifier2);
+        });
+      }
+    }
+
+    const char *name = font.getName();
+    size_t nameLength = name ? strlen(name) : 0;
+    size_t glyphOffset = alignSize(output.size());
+    size_t kerningOffset = alignSize(glyphOffset + BinaryLayout::GLYPH_RECORD_SIZE * glyphs.size());
+    size_t nameOffset = alignSize(kerningOffset + BinaryLayout::KERNING_RECORD_SIZE * kerningEntries.size());
+    output.resize(nameOffset + nameLength + 1);
+
+    // Font record
+    {
+      double yFactor = topDown ? -1 : 1;
+      const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
+      byte *record = output.data() + BinaryLayout::HEADER_SIZE + BinaryLayout::FONT_RECORD_SIZE * i;
+      putF64(record, fontMetrics.emSize);
+      putF64(record + 8, fontMetrics.lineHeight);
+      putF64(record + 16, yFactor * fontMetrics.ascenderY);
+      putF64(record + 24, yFactor * fontMetrics.descenderY);
+      putF64(record + 32, yFactor * fontMetrics.underlineY);
+      putF64(record + 40, fontMetrics.underlineThickness);
+      putU32(record + 48, (uint32_t)identifierType);
+      putU32(record + 52, (uint32_t)glyphs.size());
+      putU64(record + 56, glyphOffset);
+      putU64(record + 64, kerningEntries.size());
+      putU64(record + 72, kerningOffset);
+      putU64(record + 80, nameOffset);
+      putU64(record + 88, nameLength);
+    }
+
+    // Glyph records
+    byte *record = output.data() + glyphOffset;
+    for (const GlyphGeometry *glyph : glyphs) {
+      double l, b, r, t;
+      putU32(record, identifier(*glyph));
+      putU32(record + 4, (uint32_t)glyph->getBoxPage());
+      putU32(record + 8, glyph->isBoxRotated() ? (uint32_t)BinaryLayout::GLYPH_ROTATED : 0u);
+      putF64(record + 16, glyph->getAdvance());
+      // Absent bounds remain zero, as they are omitted in the JSON output
+      glyph->getQuadPlaneBounds(l, b, r, t);
+      if (l || b || r || t) {
+        putF64(record + 24, l);
+        putF64(record + 32, topDown ? -b : b);
+        putF64(record + 40, r);
+        putF64(record + 48, topDown ? -t : t);
+      }
+      glyph->getQuadAtlasBounds(l, b, r, t);
+      if (l || b || r || t) {
+        putF64(record + 56, l);
+        putF64(record + 64, topDown ? metrics.height - b : b);
+        putF64(record + 72, r);
+        putF64(record + 80, topDown ? metrics.height - t : t);
+      }
+      record += BinaryLayout::GLYPH_RECORD_SIZE;
+    }
+
+    // Kerning records
+    record = output.data() + kerningOffset;
+    for (const KerningEntry &entry : kerningEntries) {
+      putU32(record, entry.identifier1);
+      putU32(record + 4, entry.identifier2);
+      putF64(record + 8, entry.advance);
+      record += BinaryLayout::KERNING_RECORD_SIZE;
+    }
+
+    if (nameLength) memcpy(output.data() + nameOffset, name, nameLength);
+  }
+  output.resize(alignSize(output.size()));
+}
+
+bool exportBinaryLayout(const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  const char *filename,
+  bool kerning)
+{
+  std::vector<byte> output;
+  exportBinaryLayout(output, fonts, fontCount, imageType, metrics, kerning);
+  return msdfgen::saveFile(output, filename);
+}
+}// namespace msdf_atlas
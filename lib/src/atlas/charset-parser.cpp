@@ -141,7 +141,7 @@ bool Charset::load(const char *filename, bool disableCharLiterals)
           state = RANGE_START;
           break;
         case RANGE_SEPARATOR:
-          for (unicode_t u = rangeStart; (int)u <= cp; ++u) add(u);
+          if (cp >= 0) addRange(rangeStart, (unicode_t)cp);
           state = RANGE_END;
           break;
         default:;
@@ -164,7 +164,7 @@ bool Charset::load(const char *filename, bool disableCharLiterals)
           state = RANGE_START;
           break;
         case RANGE_SEPARATOR:
-          for (unicode_t u = rangeStart; u <= unicodeBuffer[0]; ++u) add(u);
+          addRange(rangeStart, unicodeBuffer[0]);
           state = RANGE_END;
           break;
         default:;
@@ -1,47 +1,131 @@
 #include <cstdio>
+#include <vector>
 
 #include "atlas/GlyphGeometry.hpp"
+#include "atlas/TextOutput.hpp"
+#include "atlas/Workload.hpp"
 #include "atlas/csv-export.hpp"
 
 namespace msdf_atlas {
+static void writeBounds(TextOutput &out, double l, double b, double r, double t)
+{
+  out.writeDouble(l);
+  out.write(',');
+  out.writeDouble(b);
+  out.write(',');
+  out.writeDouble(r);
+  out.write(',');
+  out.writeDouble(t);
+}
+
+static void writeFontCSV(TextOutput &out,
+  const FontGeometry &font,
+  int fontIndex,
+  int fontCount,
+  int atlasHeight,
+  YDirection yDirection,
+  int pageCount,
+  bool rotation)
+{
+  for (const GlyphGeometry &glyph : font.getGlyphs()) {
+    double l, b, r, t;
+    if (fontCount > 1) {
+      out.writeInt(fontIndex);
+      out.write(',');
+    }
+    out.writeInt(glyph.getIdentifier(font.getPreferredIdentifierType()));
+    out.write(',');
+    out.writeDouble(glyph.getAdvance());
+    out.write(',');
+    glyph.getQuadPlaneBounds(l, b, r, t);
+    switch (yDirection) {
+    case YDirection::BOTTOM_UP:
+      writeBounds(out, l, b, r, t);
+      break;
+    case YDirection::TOP_DOWN:
+      writeBounds(out, l, -t, r, -b);
+      break;
+    }
+    out.write(',');
+    if (pageCount > 1) {
+      out.writeInt(glyph.getBoxPage());
+      out.write(',');
+    }
+    glyph.getQuadAtlasBounds(l, b, r, t);
+    switch (yDirection) {
+    case YDirection::BOTTOM_UP:
+      writeBounds(out, l, b, r, t);
+      break;
+    case YDirection::TOP_DOWN:
+      writeBounds(out, l, atlasHeight - t, r, atlasHeight - b);
+      break;
+    }
+    if (rotation) {
+      out.write(',');
+      out.writeInt((int)glyph.isBoxRotated());
+    }
+    out.write('\n');
+  }
+}
+
+static void writeCSV(TextOutput &out,
+  const FontGeometry *fonts,
+  int fontCount,
+  int atlasHeight,
+  YDirection yDirection,
+  int pageCount,
+  bool rotation,
+  int threadCount)
+{
+  if (threadCount > 1 && fontCount > 1) {
+    // Fonts are formatted in parallel and concatenated in order
+    std::vector<TextOutput> fontOutputs(fontCount);
+    Workload workload(
+      [&](int i, int) -> bool {
+        writeFontCSV(fontOutputs[i], fonts[i], i, fontCount, atlasHeight, yDirection, pageCount, rotation);
+        return true;
+      },
+      fontCount);
+    workload.finish(threadCount);
+    for (const TextOutput &fontOutput : fontOutputs) out.write(fontOutput);
+  } else {
+    for (int i = 0; i < fontCount; ++i)
+      writeFontCSV(out, fonts[i], i, fontCount, atlasHeight, yDirection, pageCount, rotation);
+  }
+}
+
 bool exportCSV(const FontGeometry *fonts,
   int fontCount,
   int atlasWidth,
   int atlasHeight,
   YDirection yDirection,
-  const char *filename)
+  const char *filename,
+  int pageCount,
+  bool rotation,
+  int threadCount)
 {
   FILE *f = nullptr;
   errno_t err = fopen_s(&f, filename, "w");
   if (err != 0) { return false; }
+  TextOutput out(f);
+  writeCSV(out, fonts, fontCount, atlasHeight, yDirection, pageCount, rotation, threadCount);
+  bool success = out.flush();
+  success &= fclose(f) == 0;
+  return success;
+}
 
-  for (int i = 0; i < fontCount; ++i) {
-    for (const GlyphGeometry &glyph : fonts[i].getGlyphs()) {
-      double l, b, r, t;
-      if (fontCount > 1) fprintf(f, "%d,", i);
-      fprintf(f, "%d,%.17g,", glyph.getIdentifier(fonts[i].getPreferredIdentifierType()), glyph.getAdvance());
-      glyph.getQuadPlaneBounds(l, b, r, t);
-      switch (yDirection) {
-      case YDirection::BOTTOM_UP:
-        fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, b, r, t);
-        break;
-      case YDirection::TOP_DOWN:
-        fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, -t, r, -b);
-        break;
-      }
-      glyph.getQuadAtlasBounds(l, b, r, t);
-      switch (yDirection) {
-      case YDirection::BOTTOM_UP:
-        fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, b, r, t);
-        break;
-      case YDirection::TOP_DOWN:
-        fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, atlasHeight - t, r, atlasHeight - b);
-        break;
-      }
-    }
-  }
-
-  fclose(f);
-  return true;
+void exportCSV(std::string &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  int atlasWidth,
+  int atlasHeight,
+  YDirection yDirection,
+  int pageCount,
+  bool rotation,
+  int threadCount)
+{
+  TextOutput out;
+  writeCSV(out, fonts, fontCount, atlasHeight, yDirection, pageCount, rotation, threadCount);
+  out.takeBuffer(output);
 }
 }// namespace msdf_atlas
@@ -0,0 +1,274 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "atlas/MappedFile.hpp"
+#include "atlas/geometry-serialization.hpp"
+
+namespace msdf_atlas {
+#define GEOMETRY_FILE_MAGIC "MSDFGEOM"
+#define GEOMETRY_FILE_VERSION 1U
+#define GEOMETRY_FLAG_COLORED 0x01U
+
+/*
+ * The file consists of the header followed by these arrays, each starting at a multiple of 8 bytes:
+ * font records, glyph records (in font order), kerning records (in font order), points (pairs of doubles),
+ * contours (numbers of edges), edges (one byte each - edge type in the upper and color in the lower 4 bits),
+ * font names. Each edge consumes as many points as it has control points (its type + 1).
+ */
+
+struct GeometryFileHeader
+{
+  char magic[8];
+  unsigned int version;
+  unsigned int flags;
+  unsigned int fontCount;
+  unsigned int glyphCount;
+  unsigned long long kerningCount;
+  unsigned long long pointCount;
+  unsigned long long contourCount;
+  unsigned long long edgeCount;
+  unsigned long long nameSize;
+};
+
+struct FontRecord
+{
+  double geometryScale;
+  double emSize, ascenderY, descenderY, lineHeight, underlineY, underlineThickness;
+  int identifierType;
+  unsigned int glyphCount;
+  unsigned long long kerningCount;
+  unsigned long long nameOffset;
+  unsigned long long nameLength;
+};
+
+struct GlyphRecord
+{
+  int index;
+  unicode_t codepoint;
+  double geometryScale;
+  double advance;
+  double l, b, r, t;
+  int inverseYAxis;
+  unsigned int contourCount;
+};
+
+struct KerningRecord
+{
+  int index1, index2;
+  double advance;
+};
+
+static size_t alignSize(size_t size) { return (size + 7) & ~(size_t)7; }
+
+template<typename T> static bool writeArray(FILE *f, const T *data, size_t count)
+{
+  static const byte padding[8] = {};
+  size_t size = sizeof(T) * count;
+  return (!count || fwrite(data, sizeof(T), count, f) == count)
+         && (alignSize(size) == size || fwrite(padding, 1, alignSize(size) - size, f) == alignSize(size) - size);
+}
+
+bool saveGeometry(const FontGeometry *fonts, int fontCount, bool colored, const char *filename)
+{
+  std::vector<FontRecord> fontRecords;
+  std::vector<GlyphRecord> glyphRecords;
+  std::vector<KerningRecord> kerningRecords;
+  std::vector<double> points;
+  std::vector<unsigned int> contours;
+  std::vector<byte> edges;
+  std::string names;
+  for (int i = 0; i < fontCount; ++i) {
+    const FontGeometry &font = fonts[i];
+    const msdfgen::FontMetrics &metrics = font.getMetrics();
+    const char *name = font.getName();
+    FontRecord fontRecord = { font.getGeometryScale(),
+      metrics.emSize,
+      metrics.ascenderY,
+      metrics.descenderY,
+      metrics.lineHeight,
+      metrics.underlineY,
+      metrics.underlineThickness,
+      (int)font.getPreferredIdentifierType(),
+      (unsigned int)font.getGlyphs().size(),
+      (unsigned long long)font.getKerning().size(),
+      (unsigned long long)names.size(),
+      name ? (unsigned long long)strlen(name) : 0 };
+    fontRecords.push_back(fontRecord);
+    if (name) names += name;
+    for (const GlyphGeometry &glyph : font.getGlyphs()) {
+      const msdfgen::Shape &shape = glyph.getShape();
+      const msdfgen::Shape::Bounds &bounds = glyph.getShapeBounds();
+      GlyphRecord glyphRecord = { glyph.getIndex(),
+        glyph.getCodepoint(),
+        glyph.getGeometryScale(),
+        glyph.getAdvance(),
+        bounds.l,
+        bounds.b,
+        bounds.r,
+        bounds.t,
+        (int)shape.inverseYAxis,
+        (unsigned int)shape.contours.size() };
+      glyphRecords.push_back(glyphRecord);
+      for (const msdfgen::Contour &contour : shape.contours) {
+        contours.push_back((unsigned int)contour.edges.size());
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+          int type = edge->type();
+          edges.push_back((byte)(type << 4 | (edge->color & 0x0f)));
+          const msdfgen::Point2 *controlPoints = edge->controlPoints();
+          for (int j = 0; j <= type; ++j) {
+            points.push_back(controlPoints[j].x);
+            points.push_back(controlPoints[j].y);
+          }
+        }
+      }
+    }
+    for (const std::pair<const std::pair<int, int>, double> &kerningPair : font.getKerning())
+      kerningRecords.push_back(KerningRecord{ kerningPair.first.first, kerningPair.first.second, kerningPair.second });
+  }
+
+  GeometryFileHeader header = {};
+  memcpy(header.magic, GEOMETRY_FILE_MAGIC, sizeof(header.magic));
+  header.version = GEOMETRY_FILE_VERSION;
+  header.flags = colored ? GEOMETRY_FLAG_COLORED : 0;
+  header.fontCount = (unsigned int)fontRecords.size();
+  header.glyphCount = (unsigned int)glyphRecords.size();
+  header.kerningCount = kerningRecords.size();
+  header.pointCount = points.size() / 2;
+  header.contourCount = contours.size();
+  header.edgeCount = edges.size();
+  header.nameSize = names.size();
+
+  FILE *f = nullptr;
+  errno_t err = fopen_s(&f, filename, "wb");
+  if (err != 0) { return false; }
+  bool success = writeArray(f, &header, 1) && writeArray(f, fontRecords.data(), fontRecords.size())
+                 && writeArray(f, glyphRecords.data(), glyphRecords.size())
+                 && writeArray(f, kerningRecords.data(), kerningRecords.size())
+                 && writeArray(f, points.data(), points.size()) && writeArray(f, contours.data(), contours.size())
+                 && writeArray(f, edges.data(), edges.size()) && writeArray(f, names.data(), names.size());
+  success &= fclose(f) == 0;
+  return success;
+}
+
+bool loadGeometry(std::vector<FontGeometry> &fonts,
+  std::vector<GlyphGeometry> &glyphStorage,
+  bool &colored,
+  const char *filename)
+{
+  MappedFile file;
+  if (!(file.open(filename) && file.size() >= sizeof(GeometryFileHeader))) return false;
+  const byte *data = file.data();
+  GeometryFileHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, GEOMETRY_FILE_MAGIC, sizeof(header.magic)) || header.version != GEOMETRY_FILE_VERSION)
+    return false;
+
+  // Locate the arrays - the counts are checked against the file size first so that the offsets cannot overflow
+  size_t fileSize = file.size();
+  if (header.kerningCount > fileSize || header.pointCount > fileSize || header.contourCount > fileSize
+      || header.edgeCount > fileSize || header.nameSize > fileSize)
+    return false;
+  size_t fontOffset = alignSize(sizeof(GeometryFileHeader));
+  size_t glyphOffset = fontOffset + alignSize(sizeof(FontRecord) * header.fontCount);
+  size_t kerningOffset = glyphOffset + alignSize(sizeof(GlyphRecord) * header.glyphCount);
+  size_t pointOffset = kerningOffset + alignSize(sizeof(KerningRecord) * header.kerningCount);
+  size_t contourOffset = pointOffset + alignSize(2 * sizeof(double) * header.pointCount);
+  size_t edgeOffset = contourOffset + alignSize(sizeof(unsigned int) * header.contourCount);
+  size_t nameOffset = edgeOffset + alignSize(header.edgeCount);
+  if (nameOffset + alignSize(header.nameSize) != fileSize) return false;
+  const FontRecord *fontRecords = reinterpret_cast<const FontRecord *>(data + fontOffset);
+  const GlyphRecord *glyphRecords = reinterpret_cast<const GlyphRecord *>(data + glyphOffset);
+  const KerningRecord *kerningRecords = reinterpret_cast<const KerningRecord *>(data + kerningOffset);
+  const double *points = reinterpret_cast<const double *>(data + pointOffset);
+  const unsigned int *contours = reinterpret_cast<const unsigned int *>(data + contourOffset);
+  const byte *edges = data + edgeOffset;
+  const char *names = reinterpret_cast<const char *>(data + nameOffset);
+
+  // Validate all counts before anything is appended
+  {
+    unsigned long long glyphCount = 0, kerningCount = 0, contourCount = 0, edgeCount = 0, pointCount = 0;
+    for (unsigned int i = 0; i < header.fontCount; ++i) {
+      glyphCount += fontRecords[i].glyphCount;
+      kerningCount += fontRecords[i].kerningCount;
+      if (fontRecords[i].nameOffset > header.nameSize
+          || fontRecords[i].nameLength > header.nameSize - fontRecords[i].nameOffset)
+        return false;
+    }
+    if (glyphCount != header.glyphCount || kerningCount != header.kerningCount) return false;
+    for (unsigned int i = 0; i < header.glyphCount; ++i) {
+      contourCount += glyphRecords[i].contourCount;
+      if (contourCount > header.contourCount) return false;
+    }
+    for (unsigned long long i = 0; i < header.contourCount; ++i) {
+      edgeCount += contours[i];
+      if (edgeCount > header.edgeCount) return false;
+    }
+    for (unsigned long long i = 0; i < header.edgeCount; ++i) {
+      int type = edges[i] >> 4;
+      if (!(type >= 1 && type <= 3)) return false;
+      pointCount += type + 1;
+    }
+    if (contourCount != header.contourCount || edgeCount != header.edgeCount || pointCount != header.pointCount)
+      return false;
+  }
+
+  colored = (header.flags & GEOMETRY_FLAG_COLORED) != 0;
+  glyphStorage.reserve(glyphStorage.size() + header.glyphCount);
+  fonts.reserve(fonts.size() + header.fontCount);
+  for (unsigned int i = 0; i < header.fontCount; ++i) {
+    const FontRecord &fontRecord = fontRecords[i];
+    FontGeometry font(&glyphStorage);
+    msdfgen::FontMetrics metrics = { fontRecord.emSize,
+      fontRecord.ascenderY,
+      fontRecord.descenderY,
+      fontRecord.lineHeight,
+      fontRecord.underlineY,
+      fontRecord.underlineThickness };
+    font.setMetrics(fontRecord.geometryScale, metrics);
+    font.setPreferredIdentifierType((GlyphIdentifierType)fontRecord.identifierType);
+    for (unsigned int j = 0; j < fontRecord.glyphCount; ++j, ++glyphRecords) {
+      msdfgen::Shape shape;
+      shape.inverseYAxis = glyphRecords->inverseYAxis != 0;
+      shape.contours.resize(glyphRecords->contourCount);
+      for (msdfgen::Contour &contour : shape.contours) {
+        contour.edges.reserve(*contours);
+        for (unsigned int k = *contours++; k; --k, ++edges) {
+          msdfgen::EdgeColor color = (msdfgen::EdgeColor)(*edges & 0x0f);
+          msdfgen::Point2 p0(points[0], points[1]), p1(points[2], points[3]);
+          switch (*edges >> 4) {
+          case 1:
+            contour.edges.emplace_back(p0, p1, color);
+            points += 4;
+            break;
+          case 2:
+            contour.edges.emplace_back(p0, p1, msdfgen::Point2(points[4], points[5]), color);
+            points += 6;
+            break;
+          case 3:
+            contour.edges.emplace_back(
+              p0, p1, msdfgen::Point2(points[4], points[5]), msdfgen::Point2(points[6], points[7]), color);
+            points += 8;
+            break;
+          }
+        }
+      }
+      msdfgen::Shape::Bounds bounds = { glyphRecords->l, glyphRecords->b, glyphRecords->r, glyphRecords->t };
+      GlyphGeometry glyph;
+      glyph.setGeometry(glyphRecords->index,
+        glyphRecords->codepoint,
+        glyphRecords->geometryScale,
+        (msdfgen::Shape &&)shape,
+        bounds,
+        glyphRecords->advance);
+      font.addGlyph((GlyphGeometry &&)glyph);
+    }
+    for (unsigned long long j = 0; j < fontRecord.kerningCount; ++j, ++kerningRecords)
+      font.setKerning(kerningRecords->index1, kerningRecords->index2, kerningRecords->advance);
+    if (fontRecord.nameLength)
+      font.setName(std::string(names + fontRecord.nameOffset, (size_t)fontRecord.nameLength).c_str());
+    fonts.push_back((FontGeometry &&)font);
+  }
+  return true;
+}
+}// namespace msdf_atlas
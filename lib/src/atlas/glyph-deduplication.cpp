@@ -0,0 +1,28 @@
+#include <unordered_map>
+
+#include "atlas/glyph-deduplication.hpp"
+#include "core/shape-hash.hpp"
+
+namespace msdf_atlas {
+int findDuplicateGlyphs(std::vector<int> &originals, const GlyphGeometry *glyphs, int count)
+{
+  int duplicates = 0;
+  originals.resize(count);
+  std::unordered_map<unsigned long long, std::vector<int>> candidates;
+  for (int i = 0; i < count; ++i) {
+    originals[i] = i;
+    if (glyphs[i].isWhitespace()) continue;
+    std::vector<int> &bucket = candidates[msdfgen::shapeHash(glyphs[i].getShape())];
+    for (int j : bucket) {
+      if (glyphs[j].getGeometryScale() == glyphs[i].getGeometryScale()
+          && msdfgen::shapeGeometryEquals(glyphs[j].getShape(), glyphs[i].getShape())) {
+        originals[i] = j;
+        ++duplicates;
+        break;
+      }
+    }
+    if (originals[i] == i) bucket.push_back(i);
+  }
+  return duplicates;
+}
+}// namespace msdf_atlas
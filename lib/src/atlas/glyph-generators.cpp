@@ -1,47 +1,53 @@
 #include "atlas/glyph-generators.hpp"
-#include "core/msdf-error-correction.hpp"
-#include "core/rasterization.hpp"
-#include "msdfgen.hpp"
+#include "core/GeneratorContext.hpp"
 
 namespace msdf_atlas {
 void scanlineGenerator(const msdfgen::BitmapRef<float, 1> &output,
   const GlyphGeometry &glyph,
   const GeneratorAttributes &attribs)
 {
-  msdfgen::rasterize(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
+  msdfgen::GeneratorContext localContext;
+  msdfgen::GeneratorContext &context = attribs.context ? *attribs.context : localContext;
+  context.rasterize(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
 }
 
 void sdfGenerator(const msdfgen::BitmapRef<float, 1> &output,
   const GlyphGeometry &glyph,
   const GeneratorAttributes &attribs)
 {
-  msdfgen::generateSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
+  msdfgen::GeneratorContext localContext;
+  msdfgen::GeneratorContext &context = attribs.context ? *attribs.context : localContext;
+  context.generateSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
   if (attribs.scanlinePass)
-    msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
+    context.distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
 }
 
 void psdfGenerator(const msdfgen::BitmapRef<float, 1> &output,
   const GlyphGeometry &glyph,
   const GeneratorAttributes &attribs)
 {
-  msdfgen::generatePSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
+  msdfgen::GeneratorContext localContext;
+  msdfgen::GeneratorContext &context = attribs.context ? *attribs.context : localContext;
+  context.generatePSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
   if (attribs.scanlinePass)
-    msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
+    context.distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
 }
 
 void msdfGenerator(const msdfgen::BitmapRef<float, 3> &output,
   const GlyphGeometry &glyph,
   const GeneratorAttributes &attribs)
 {
+  msdfgen::GeneratorContext localContext;
+  msdfgen::GeneratorContext &context = attribs.context ? *attribs.context : localContext;
   msdfgen::MSDFGeneratorConfig config = attribs.config;
   if (attribs.scanlinePass) config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
-  msdfgen::generateMSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+  context.generateMSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
   if (attribs.scanlinePass) {
-    msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
+    context.distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
     if (attribs.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED) {
       config.errorCorrection.mode = attribs.config.errorCorrection.mode;
       config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
-      msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+      context.msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
     }
   }
 }
@@ -50,15 +56,17 @@ void mtsdfGenerator(const msdfgen::BitmapRef<float, 4> &output,
   const GlyphGeometry &glyph,
   const GeneratorAttributes &attribs)
 {
+  msdfgen::GeneratorContext localContext;
+  msdfgen::GeneratorContext &context = attribs.context ? *attribs.context : localContext;
   msdfgen::MSDFGeneratorConfig config = attribs.config;
   if (attribs.scanlinePass) config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
-  msdfgen::generateMTSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+  context.generateMTSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
   if (attribs.scanlinePass) {
-    msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
+    context.distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDFLIB_GLYPH_FILL_RULE);
     if (attribs.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED) {
       config.errorCorrection.mode = attribs.config.errorCorrection.mode;
       config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
-      msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+      context.msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
     }
   }
 }
@@ -1,6 +1,9 @@
 #include <string>
+#include <vector>
 
 #include "atlas/GlyphGeometry.hpp"
+#include "atlas/TextOutput.hpp"
+#include "atlas/Workload.hpp"
 #include "atlas/json-export.hpp"
 
 namespace msdf_atlas {
@@ -85,163 +88,283 @@ static const char *imageTypeString(ImageType type)
   return nullptr;
 }
 
-bool exportJSON(const FontGeometry *fonts,
+static void writeBounds(TextOutput &out,
+  const char *name,
+  YDirection yDirection,
+  double l,
+  double y0,
+  double r,
+  double y1)
+{
+  bool topDown = yDirection == YDirection::TOP_DOWN;
+  out.write(",\"");
+  out.write(name);
+  out.write("\":{\"left\":");
+  out.writeDouble(l);
+  out.write(topDown ? ",\"top\":" : ",\"bottom\":");
+  out.writeDouble(y0);
+  out.write(",\"right\":");
+  out.writeDouble(r);
+  out.write(topDown ? ",\"bottom\":" : ",\"top\":");
+  out.writeDouble(y1);
+  out.write('}');
+}
+
+static void writeKerningPair(TextOutput &out,
+  const char *key1,
+  unsigned id1,
+  const char *key2,
+  unsigned id2,
+  double advance)
+{
+  out.write(key1);
+  out.writeUnsigned(id1);
+  out.write(key2);
+  out.writeUnsigned(id2);
+  out.write(",\"advance\":");
+  out.writeDouble(advance);
+  out.write('}');
+}
+
+static void writeFontJSON(TextOutput &out, const FontGeometry &font, const JsonAtlasMetrics &metrics, bool kerning)
+{
+  // Font name
+  const char *name = font.getName();
+  if (name) {
+    out.write("\"name\":\"");
+    out.write(escapeJsonString(name));
+    out.write("\",");
+  }
+
+  // Font metrics
+  out.write("\"metrics\":{");
+  {
+    double yFactor = metrics.yDirection == YDirection::TOP_DOWN ? -1 : 1;
+    const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
+    out.write("\"emSize\":");
+    out.writeDouble(fontMetrics.emSize);
+    out.write(",\"lineHeight\":");
+    out.writeDouble(fontMetrics.lineHeight);
+    out.write(",\"ascender\":");
+    out.writeDouble(yFactor * fontMetrics.ascenderY);
+    out.write(",\"descender\":");
+    out.writeDouble(yFactor * fontMetrics.descenderY);
+    out.write(",\"underlineY\":");
+    out.writeDouble(yFactor * fontMetrics.underlineY);
+    out.write(",\"underlineThickness\":");
+    out.writeDouble(fontMetrics.underlineThickness);
+  }
+  out.write("},");
+
+  // Glyph mapping
+  out.write("\"glyphs\":[");
+  bool firstGlyph = true;
+  for (const GlyphGeometry &glyph : font.getGlyphs()) {
+    out.write(firstGlyph ? "{" : ",{");
+    switch (font.getPreferredIdentifierType()) {
+    case GlyphIdentifierType::GLYPH_INDEX:
+      out.write("\"index\":");
+      out.writeInt(glyph.getIndex());
+      break;
+    case GlyphIdentifierType::UNICODE_CODEPOINT:
+      out.write("\"unicode\":");
+      out.writeUnsigned(glyph.getCodepoint());
+      break;
+    }
+    out.write(",\"advance\":");
+    out.writeDouble(glyph.getAdvance());
+    double l, b, r, t;
+    glyph.getQuadPlaneBounds(l, b, r, t);
+    if (l || b || r || t) {
+      switch (metrics.yDirection) {
+      case YDirection::BOTTOM_UP:
+        writeBounds(out, "planeBounds", metrics.yDirection, l, b, r, t);
+        break;
+      case YDirection::TOP_DOWN:
+        writeBounds(out, "planeBounds", metrics.yDirection, l, -t, r, -b);
+        break;
+      }
+    }
+    glyph.getQuadAtlasBounds(l, b, r, t);
+    if (l || b || r || t) {
+      switch (metrics.yDirection) {
+      case YDirection::BOTTOM_UP:
+        writeBounds(out, "atlasBounds", metrics.yDirection, l, b, r, t);
+        break;
+      case YDirection::TOP_DOWN:
+        writeBounds(out, "atlasBounds", metrics.yDirection, l, metrics.height - t, r, metrics.height - b);
+        break;
+      }
+      if (metrics.pageCount > 1) {
+        out.write(",\"page\":");
+        out.writeInt(glyph.getBoxPage());
+      }
+      if (glyph.isBoxRotated()) out.write(",\"rotated\":true");
+    }
+    out.write('}');
+    firstGlyph = false;
+  }
+  out.write(']');
+
+  // Kerning pairs
+  if (kerning) {
+    out.write(",\"kerning\":[");
+    bool firstPair = true;
+    switch (font.getPreferredIdentifierType()) {
+    case GlyphIdentifierType::GLYPH_INDEX:
+      for (const std::pair<const std::pair<int, int>, double> &kernPair : font.getKerning()) {
+        out.write(firstPair ? "{" : ",{");
+        writeKerningPair(out,
+          "\"index1\":",
+          kernPair.first.first,
+          ",\"index2\":",
+          kernPair.first.second,
+          kernPair.second);
+        firstPair = false;
+      }
+      break;
+    case GlyphIdentifierType::UNICODE_CODEPOINT:
+      for (const std::pair<const std::pair<int, int>, double> &kernPair : font.getKerning()) {
+        const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
+        const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
+        if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
+          out.write(firstPair ? "{" : ",{");
+          writeKerningPair(out,
+            "\"unicode1\":",
+            glyph1->getCodepoint(),
+            ",\"unicode2\":",
+            glyph2->getCodepoint(),
+            kernPair.second);
+          firstPair = false;
+        }
+      }
+      break;
+    }
+    out.write(']');
+  }
+}
+
+static void writeJSON(TextOutput &out,
+  const FontGeometry *fonts,
   int fontCount,
   ImageType imageType,
   const JsonAtlasMetrics &metrics,
-  const char *filename,
-  bool kerning)
+  bool kerning,
+  int threadCount)
 {
-  FILE *f = nullptr;
-  errno_t err = fopen_s(&f, filename, "w");
-  if (err != 0) { return false; }
-
-  fputs("{", f);
+  out.write('{');
 
   // Atlas properties
-  fputs("\"atlas\":{", f);
+  out.write("\"atlas\":{");
   {
-    fprintf(f, "\"type\":\"%s\",", imageTypeString(imageType));
+    out.write("\"type\":\"");
+    out.write(imageTypeString(imageType));
+    out.write("\",");
     if (imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF
-        || imageType == ImageType::MTSDF)
-      fprintf(f, "\"distanceRange\":%.17g,", metrics.distanceRange);
-    fprintf(f, "\"size\":%.17g,", metrics.size);
-    fprintf(f, "\"width\":%d,", metrics.width);
-    fprintf(f, "\"height\":%d,", metrics.height);
-    fprintf(f, "\"yOrigin\":\"%s\"", metrics.yDirection == YDirection::TOP_DOWN ? "top" : "bottom");
+        || imageType == ImageType::MTSDF) {
+      out.write("\"distanceRange\":");
+      out.writeDouble(metrics.distanceRange);
+      out.write(',');
+    }
+    out.write("\"size\":");
+    out.writeDouble(metrics.size);
+    out.write(",\"width\":");
+    out.writeInt(metrics.width);
+    out.write(",\"height\":");
+    out.writeInt(metrics.height);
+    out.write(',');
+    if (metrics.pageCount > 1) {
+      out.write("\"pages\":");
+      out.writeInt(metrics.pageCount);
+      out.write(',');
+    }
+    out.write(metrics.yDirection == YDirection::TOP_DOWN ? "\"yOrigin\":\"top\"" : "\"yOrigin\":\"bottom\"");
     if (metrics.grid) {
-      fputs(",\"grid\":{", f);
-      fprintf(f, "\"cellWidth\":%d,", metrics.grid->cellWidth);
-      fprintf(f, "\"cellHeight\":%d,", metrics.grid->cellHeight);
-      fprintf(f, "\"columns\":%d,", metrics.grid->columns);
-      fprintf(f, "\"rows\":%d", metrics.grid->rows);
-      if (metrics.grid->originX) fprintf(f, ",\"originX\":%.17g", *metrics.grid->originX);
+      out.write(",\"grid\":{\"cellWidth\":");
+      out.writeInt(metrics.grid->cellWidth);
+      out.write(",\"cellHeight\":");
+      out.writeInt(metrics.grid->cellHeight);
+      out.write(",\"columns\":");
+      out.writeInt(metrics.grid->columns);
+      out.write(",\"rows\":");
+      out.writeInt(metrics.grid->rows);
+      if (metrics.grid->originX) {
+        out.write(",\"originX\":");
+        out.writeDouble(*metrics.grid->originX);
+      }
       if (metrics.grid->originY) {
+        out.write(",\"originY\":");
         switch (metrics.yDirection) {
         case YDirection::BOTTOM_UP:
-          fprintf(f, ",\"originY\":%.17g", *metrics.grid->originY);
+          out.writeDouble(*metrics.grid->originY);
           break;
         case YDirection::TOP_DOWN:
-          fprintf(f,
-            ",\"originY\":%.17g",
+          out.writeDouble(
             (metrics.grid->cellHeight - metrics.grid->spacing - 1) / metrics.size - *metrics.grid->originY);
           break;
         }
       }
-      fputs("}", f);
+      out.write('}');
     }
   }
-  fputs("},", f);
-
-  if (fontCount > 1) fputs("\"variants\":[", f);
-  for (int i = 0; i < fontCount; ++i) {
-    const FontGeometry &font = fonts[i];
-    if (fontCount > 1) fputs(i == 0 ? "{" : ",{", f);
-
-    // Font name
-    const char *name = font.getName();
-    if (name) fprintf(f, "\"name\":\"%s\",", escapeJsonString(name).c_str());
+  out.write("},");
 
-    // Font metrics
-    fputs("\"metrics\":{", f);
-    {
-      double yFactor = metrics.yDirection == YDirection::TOP_DOWN ? -1 : 1;
-      const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
-      fprintf(f, "\"emSize\":%.17g,", fontMetrics.emSize);
-      fprintf(f, "\"lineHeight\":%.17g,", fontMetrics.lineHeight);
-      fprintf(f, "\"ascender\":%.17g,", yFactor * fontMetrics.ascenderY);
-      fprintf(f, "\"descender\":%.17g,", yFactor * fontMetrics.descenderY);
-      fprintf(f, "\"underlineY\":%.17g,", yFactor * fontMetrics.underlineY);
-      fprintf(f, "\"underlineThickness\":%.17g", fontMetrics.underlineThickness);
+  if (fontCount > 1) {
+    // Fonts are formatted in parallel and concatenated in order
+    std::vector<TextOutput> fontOutputs(threadCount > 1 ? fontCount : 0);
+    if (!fontOutputs.empty()) {
+      Workload workload(
+        [&](int i, int) -> bool {
+          writeFontJSON(fontOutputs[i], fonts[i], metrics, kerning);
+          return true;
+        },
+        fontCount);
+      workload.finish(threadCount);
     }
-    fputs("},", f);
-
-    // Glyph mapping
-    fputs("\"glyphs\":[", f);
-    bool firstGlyph = true;
-    for (const GlyphGeometry &glyph : font.getGlyphs()) {
-      fputs(firstGlyph ? "{" : ",{", f);
-      switch (font.getPreferredIdentifierType()) {
-      case GlyphIdentifierType::GLYPH_INDEX:
-        fprintf(f, "\"index\":%d,", glyph.getIndex());
-        break;
-      case GlyphIdentifierType::UNICODE_CODEPOINT:
-        fprintf(f, "\"unicode\":%u,", glyph.getCodepoint());
-        break;
-      }
-      fprintf(f, "\"advance\":%.17g", glyph.getAdvance());
-      double l, b, r, t;
-      glyph.getQuadPlaneBounds(l, b, r, t);
-      if (l || b || r || t) {
-        switch (metrics.yDirection) {
-        case YDirection::BOTTOM_UP:
-          fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
-          break;
-        case YDirection::TOP_DOWN:
-          fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, -t, r, -b);
-          break;
-        }
-      }
-      glyph.getQuadAtlasBounds(l, b, r, t);
-      if (l || b || r || t) {
-        switch (metrics.yDirection) {
-        case YDirection::BOTTOM_UP:
-          fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
-          break;
-        case YDirection::TOP_DOWN:
-          fprintf(f,
-            ",\"atlasBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}",
-            l,
-            metrics.height - t,
-            r,
-            metrics.height - b);
-          break;
-        }
-      }
-      fputs("}", f);
-      firstGlyph = false;
+    out.write("\"variants\":[");
+    for (int i = 0; i < fontCount; ++i) {
+      out.write(i == 0 ? "{" : ",{");
+      if (fontOutputs.empty())
+        writeFontJSON(out, fonts[i], metrics, kerning);
+      else
+        out.write(fontOutputs[i]);
+      out.write('}');
     }
-    fputs("]", f);
+    out.write(']');
+  } else if (fontCount == 1)
+    writeFontJSON(out, fonts[0], metrics, kerning);
 
-    // Kerning pairs
-    if (kerning) {
-      fputs(",\"kerning\":[", f);
-      bool firstPair = true;
-      switch (font.getPreferredIdentifierType()) {
-      case GlyphIdentifierType::GLYPH_INDEX:
-        for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-          fputs(firstPair ? "{" : ",{", f);
-          fprintf(f, "\"index1\":%d,", kernPair.first.first);
-          fprintf(f, "\"index2\":%d,", kernPair.first.second);
-          fprintf(f, "\"advance\":%.17g", kernPair.second);
-          fputs("}", f);
-          firstPair = false;
-        }
-        break;
-      case GlyphIdentifierType::UNICODE_CODEPOINT:
-        for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-          const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
-          const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
-          if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
-            fputs(firstPair ? "{" : ",{", f);
-            fprintf(f, "\"unicode1\":%u,", glyph1->getCodepoint());
-            fprintf(f, "\"unicode2\":%u,", glyph2->getCodepoint());
-            fprintf(f, "\"advance\":%.17g", kernPair.second);
-            fputs("}", f);
-            firstPair = false;
-          }
-        }
-        break;
-      }
-      fputs("]", f);
-    }
+  out.write("}\n");
+}
 
-    if (fontCount > 1) fputs("}", f);
-  }
-  if (fontCount > 1) fputs("]", f);
+bool exportJSON(const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  const char *filename,
+  bool kerning,
+  int threadCount)
+{
+  FILE *f = nullptr;
+  errno_t err = fopen_s(&f, filename, "w");
+  if (err != 0) { return false; }
+  TextOutput out(f);
+  writeJSON(out, fonts, fontCount, imageType, metrics, kerning, threadCount);
+  bool success = out.flush();
+  success &= fclose(f) == 0;
+  return success;
+}
 
-  fputs("}\n", f);
-  fclose(f);
-  return true;
+void exportJSON(std::string &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  ImageType imageType,
+  const JsonAtlasMetrics &metrics,
+  bool kerning,
+  int threadCount)
+{
+  TextOutput out;
+  writeJSON(out, fonts, fontCount, imageType, metrics, kerning, threadCount);
+  out.takeBuffer(output);
 }
 }// namespace msdf_atlas
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <set>
+
+#include "atlas/kerning-tables.hpp"
+
+namespace msdf_atlas {
+#define GPOS_PAIR_ADJUSTMENT 2
+#define GPOS_EXTENSION 9
+#define VALUE_FORMAT_X_PLACEMENT 0x0001U
+#define VALUE_FORMAT_Y_PLACEMENT 0x0002U
+#define VALUE_FORMAT_X_ADVANCE 0x0004U
+
+/// Bounds-checked big-endian reader of a font table, reads outside of the table yield zero
+class TableReader
+{
+
+public:
+  TableReader(const byte *data, size_t length) : data(data), length(length) {}
+  bool contains(size_t offset, size_t size) const { return offset <= length && size <= length - offset; }
+  unsigned u16(size_t offset) const
+  {
+    return contains(offset, 2) ? (unsigned)data[offset] << 8 | (unsigned)data[offset + 1] : 0U;
+  }
+  int s16(size_t offset) const { return (int)(short)u16(offset); }
+  unsigned long u32(size_t offset) const { return (unsigned long)u16(offset) << 16 | u16(offset + 2); }
+  bool tag(size_t offset, const char *tag) const
+  {
+    return contains(offset, 4) && data[offset] == (byte)tag[0] && data[offset + 1] == (byte)tag[1]
+           && data[offset + 2] == (byte)tag[2] && data[offset + 3] == (byte)tag[3];
+  }
+
+private:
+  const byte *data;
+  size_t length;
+};
+
+struct KernRecord
+{
+  int left, right;
+  int value;
+};
+
+static bool isMasked(const std::vector<bool> &glyphMask, unsigned glyph)
+{
+  return glyph < glyphMask.size() && glyphMask[glyph];
+}
+
+static int popCount(unsigned x)
+{
+  int count = 0;
+  for (; x; x &= x - 1) ++count;
+  return count;
+}
+
+bool readKernTable(std::map<std::pair<int, int>, int> &pairs,
+  const byte *data,
+  size_t length,
+  const std::vector<bool> &glyphMask)
+{
+  TableReader table(data, length);
+  if (length < 4) return false;
+  // FreeType only considers the first 32 subtables
+  unsigned subtableCount = std::min(table.u16(2), 32U);
+  std::vector<KernRecord> records;
+  size_t offset = 4;
+  for (unsigned i = 0; i < subtableCount && offset + 6 <= length; ++i) {
+    size_t subtableLength = table.u16(offset + 2);
+    unsigned coverage = table.u16(offset + 4);
+    if (subtableLength <= 6 + 8) break;
+    size_t next = std::min(offset + subtableLength, length);
+    // Only horizontal format 0 subtables are supported
+    if ((coverage >> 8) == 0 && (coverage & 3U) == 1 && offset + 6 + 8 <= next) {
+      size_t recordsOffset = offset + 6 + 8;
+      size_t recordCount = std::min((size_t)table.u16(offset + 6), (next - recordsOffset) / 6);
+      records.clear();
+      for (size_t j = 0; j < recordCount; ++j) {
+        size_t record = recordsOffset + 6 * j;
+        unsigned left = table.u16(record), right = table.u16(record + 2);
+        if (isMasked(glyphMask, left) && isMasked(glyphMask, right))
+          records.push_back(KernRecord{ (int)left, (int)right, table.s16(record + 4) });
+      }
+      // If a pair occurs more than once, the first occurrence counts
+      std::stable_sort(records.begin(), records.end(), [](const KernRecord &a, const KernRecord &b) {
+        return a.left < b.left || (a.left == b.left && a.right < b.right);
+      });
+      bool override = (coverage & 8U) != 0;
+      for (size_t j = 0; j < records.size(); ++j) {
+        if (j && records[j].left == records[j - 1].left && records[j].right == records[j - 1].right) continue;
+        int &value = pairs[std::make_pair(records[j].left, records[j].right)];
+        value = override ? records[j].value : value + records[j].value;
+      }
+    }
+    offset = next;
+  }
+  return true;
+}
+
+/// Calls fn(glyph, coverageIndex) for each glyph of a coverage table
+template<typename FN> static void forEachCovered(const TableReader &table, size_t coverage, FN fn)
+{
+  switch (table.u16(coverage)) {
+  case 1:
+    for (unsigned i = 0, count = table.u16(coverage + 2); i < count; ++i) fn(table.u16(coverage + 4 + 2 * i), i);
+    break;
+  case 2:
+    for (unsigned i = 0, count = table.u16(coverage + 2); i < count; ++i) {
+      size_t range = coverage + 4 + 6 * i;
+      unsigned start = table.u16(range), end = table.u16(range + 2), startIndex = table.u16(range + 4);
+      for (unsigned glyph = start; glyph <= end; ++glyph) fn(glyph, startIndex + glyph - start);
+    }
+    break;
+  }
+}
+
+/// Returns the class of the glyph in a class definition table
+static unsigned glyphClass(const TableReader &table, size_t classDef, unsigned glyph)
+{
+  switch (table.u16(classDef)) {
+  case 1: {
+    unsigned start = table.u16(classDef + 2), count = table.u16(classDef + 4);
+    if (glyph >= start && glyph - start < count) return table.u16(classDef + 6 + 2 * (glyph - start));
+    break;
+  }
+  case 2: {
+    // Ranges are sorted by their start glyph
+    unsigned low = 0, high = table.u16(classDef + 2);
+    while (low < high) {
+      unsigned mid = (low + high) / 2;
+      size_t range = classDef + 4 + 6 * mid;
+      if (glyph < table.u16(range))
+        high = mid;
+      else if (glyph > table.u16(range + 2))
+        low = mid + 1;
+      else
+        return table.u16(range + 4);
+    }
+    break;
+  }
+  }
+  return 0;
+}
+
+static void readPairAdjustment(std::map<std::pair<int, int>, int> &lookupPairs,
+  std::vector<bool> &coveredFirst,
+  const TableReader &table,
+  size_t subtable,
+  const std::vector<bool> &glyphMask,
+  const std::vector<unsigned> &glyphs)
+{
+  unsigned format = table.u16(subtable);
+  size_t coverage = subtable + table.u16(subtable + 2);
+  unsigned valueFormat1 = table.u16(subtable + 4), valueFormat2 = table.u16(subtable + 6);
+  size_t valueSize = 2 * (popCount(valueFormat1) + popCount(valueFormat2));
+  // Only the first glyph's advance is adjusted by kerning
+  bool hasAdvance = (valueFormat1 & VALUE_FORMAT_X_ADVANCE) != 0;
+  size_t advanceOffset = 2 * popCount(valueFormat1 & (VALUE_FORMAT_X_PLACEMENT | VALUE_FORMAT_Y_PLACEMENT));
+
+  if (format == 1) {
+    unsigned pairSetCount = table.u16(subtable + 8);
+    forEachCovered(table, coverage, [&](unsigned first, unsigned coverageIndex) {
+      if (coverageIndex >= pairSetCount || !isMasked(glyphMask, first) || coveredFirst[first]) return;
+      size_t pairSet = subtable + table.u16(subtable + 10 + 2 * coverageIndex);
+      size_t recordSize = 2 + valueSize;
+      unsigned recordCount = table.u16(pairSet);
+      if (!table.contains(pairSet + 2, recordSize * recordCount)) return;
+      for (unsigned i = 0; i < recordCount; ++i) {
+        size_t record = pairSet + 2 + recordSize * i;
+        unsigned second = table.u16(record);
+        if (isMasked(glyphMask, second)) {
+          int value = hasAdvance ? table.s16(record + 2 + advanceOffset) : 0;
+          lookupPairs.emplace(std::make_pair((int)first, (int)second), value);
+        }
+      }
+    });
+  } else if (format == 2) {
+    size_t classDef1 = subtable + table.u16(subtable + 8), classDef2 = subtable + table.u16(subtable + 10);
+    unsigned class1Count = table.u16(subtable + 12), class2Count = table.u16(subtable + 14);
+    size_t records = subtable + 16;
+    if (!table.contains(records, valueSize * class1Count * class2Count)) return;
+    // Group the second glyphs by class so that only the pairs with non-zero values are enumerated
+    std::vector<std::vector<unsigned>> secondGlyphs(class2Count);
+    for (unsigned glyph : glyphs) {
+      unsigned secondClass = glyphClass(table, classDef2, glyph);
+      if (secondClass < class2Count) secondGlyphs[secondClass].push_back(glyph);
+    }
+    forEachCovered(table, coverage, [&](unsigned first, unsigned) {
+      if (!isMasked(glyphMask, first) || coveredFirst[first]) return;
+      unsigned firstClass = glyphClass(table, classDef1, first);
+      if (firstClass >= class1Count) return;
+      // The subtable applies to all pairs starting with this glyph, which subsequent subtables must not override
+      coveredFirst[first] = true;
+      if (!hasAdvance) return;
+      for (unsigned secondClass = 0; secondClass < class2Count; ++secondClass) {
+        int value = table.s16(records + valueSize * (firstClass * class2Count + secondClass) + advanceOffset);
+        if (value) {
+          for (unsigned second : secondGlyphs[secondClass])
+            lookupPairs.emplace(std::make_pair((int)first, (int)second), value);
+        }
+      }
+    });
+  }
+}
+
+bool readGposKerning(std::map<std::pair<int, int>, int> &pairs,
+  const byte *data,
+  size_t length,
+  const std::vector<bool> &glyphMask)
+{
+  TableReader table(data, length);
+  if (!(length >= 10 && table.u16(0) == 1)) return false;
+  size_t featureList = table.u16(6), lookupList = table.u16(8);
+
+  // Collect the lookups of all 'kern' features, they are applied in the order of the lookup list
+  std::set<unsigned> lookupIndices;
+  for (unsigned i = 0, featureCount = table.u16(featureList); i < featureCount; ++i) {
+    size_t featureRecord = featureList + 2 + 6 * i;
+    if (!table.tag(featureRecord, "kern")) continue;
+    size_t feature = featureList + table.u16(featureRecord + 4);
+    for (unsigned j = 0, count = table.u16(feature + 2); j < count; ++j)
+      lookupIndices.insert(table.u16(feature + 4 + 2 * j));
+  }
+
+  std::vector<unsigned> glyphs;
+  for (unsigned glyph = 0; glyph < glyphMask.size(); ++glyph)
+    if (glyphMask[glyph]) glyphs.push_back(glyph);
+  unsigned lookupCount = table.u16(lookupList);
+  for (unsigned lookupIndex : lookupIndices) {
+    if (lookupIndex >= lookupCount) continue;
+    size_t lookup = lookupList + table.u16(lookupList + 2 + 2 * lookupIndex);
+    unsigned lookupType = table.u16(lookup);
+    if (!(lookupType == GPOS_PAIR_ADJUSTMENT || lookupType == GPOS_EXTENSION)) continue;
+    std::map<std::pair<int, int>, int> lookupPairs;
+    std::vector<bool> coveredFirst(glyphMask.size());
+    for (unsigned i = 0, subtableCount = table.u16(lookup + 4); i < subtableCount; ++i) {
+      size_t subtable = lookup + table.u16(lookup + 6 + 2 * i);
+      if (lookupType == GPOS_EXTENSION) {
+        if (!(table.u16(subtable) == 1 && table.u16(subtable + 2) == GPOS_PAIR_ADJUSTMENT)) continue;
+        subtable += table.u32(subtable + 4);
+      }
+      readPairAdjustment(lookupPairs, coveredFirst, table, subtable, glyphMask, glyphs);
+    }
+    for (const std::pair<const std::pair<int, int>, int> &pair : lookupPairs) pairs[pair.first] += pair.second;
+  }
+  return true;
+}
+}// namespace msdf_atlas
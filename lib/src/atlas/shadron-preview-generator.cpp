@@ -1,4 +1,6 @@
 #include <algorithm>
+#include <cstdarg>
+#include <cstdio>
 #include <string>
 
 #include "atlas/shadron-preview-generator.hpp"
@@ -73,6 +75,26 @@ static std::string relativizePath(const char *base, const char *target)
   return output;
 }
 
+static void appendFormatted(std::string &output, const char *format, ...)
+{
+  char buffer[1024];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length < 0) return;
+  if ((size_t)length < sizeof(buffer)) {
+    output.append(buffer, length);
+    return;
+  }
+  size_t start = output.size();
+  output.resize(start + length + 1);
+  va_start(args, format);
+  vsnprintf(&output[start], length + 1, format, args);
+  va_end(args);
+  output.resize(start + length);
+}
+
 static std::string escapeString(const std::string &str)
 {
   std::string output;
@@ -91,38 +113,34 @@ static std::string escapeString(const std::string &str)
   return output;
 }
 
-bool generateShadronPreview(const FontGeometry *fonts,
+static bool writeShadronPreview(std::string &output,
+  const FontGeometry *fonts,
   int fontCount,
   ImageType atlasType,
   int atlasWidth,
   int atlasHeight,
   double pxRange,
   const unicode_t *text,
-  const char *imageFilename,
-  bool fullRange,
-  const char *outputFilename)
+  const char *imagePath,
+  bool fullRange)
 {
-  if (fontCount <= 0) return false;
   double texelWidth = 1. / atlasWidth;
   double texelHeight = 1. / atlasHeight;
   bool anyGlyphs = false;
-  FILE *file = nullptr;
-  errno_t err = fopen_s(&file, outputFilename, "w");
-  if (err != 0) { return false; }
 
-  fprintf(file,
+  appendFormatted(output,
     shadronPreviewPreamble,
     atlasType == ImageType::HARD_MASK || atlasType == ImageType::SOFT_MASK ? shadronFillGlyphMask
                                                                            : shadronFillGlyphSdf);
-  if (imageFilename)
-    fprintf(file, "image Atlas = file(\"%s\")", escapeString(relativizePath(outputFilename, imageFilename)).c_str());
+  if (imagePath)
+    appendFormatted(output, "image Atlas = file(\"%s\")", escapeString(imagePath).c_str());
   else
-    fprintf(file, "image Atlas = file()");
-  fprintf(file,
+    appendFormatted(output, "image Atlas = file()");
+  appendFormatted(output,
     " : %sfilter(%s), map(repeat);\n",
     fullRange ? "full_range(true), " : "",
     atlasType == ImageType::HARD_MASK ? "nearest" : "linear");
-  fprintf(file, "const vec2 txRange = vec2(%.9g, %.9g);\n\n", pxRange * texelWidth, pxRange * texelHeight);
+  appendFormatted(output, "const vec2 txRange = vec2(%.9g, %.9g);\n\n", pxRange * texelWidth, pxRange * texelHeight);
   {
     msdfgen::FontMetrics fontMetrics = fonts->getMetrics();
     for (int i = 1; i < fontCount; ++i) {
@@ -131,7 +149,7 @@ bool generateShadronPreview(const FontGeometry *fonts,
       fontMetrics.descenderY = std::min(fontMetrics.descenderY, fonts[i].getMetrics().descenderY);
     }
     double fsScale = 1 / (fontMetrics.ascenderY - fontMetrics.descenderY);
-    fputs("vertex_list GlyphVertex textQuadVertices = {\n", file);
+    output += "vertex_list GlyphVertex textQuadVertices = {\n";
     double x = 0, y = -fsScale * fontMetrics.ascenderY;
     double textWidth = 0;
     for (const unicode_t *cp = text; *cp; ++cp) {
@@ -153,33 +171,39 @@ bool generateShadronPreview(const FontGeometry *fonts,
             pl *= fsScale, pb *= fsScale, pr *= fsScale, pt *= fsScale;
             pl += x, pb += y, pr += x, pt += y;
             il *= texelWidth, ib *= texelHeight, ir *= texelWidth, it *= texelHeight;
-            fprintf(file,
+            // Texture coordinates of the left-bottom, right-bottom, left-top, and right-top corners of the quad
+            double lbx = il, lby = ib, rbx = ir, rby = ib, ltx = il, lty = it, rtx = ir, rty = it;
+            if (glyph->isBoxRotated()) {
+              lbx = ir, lby = ib, rbx = ir, rby = it;
+              ltx = il, lty = ib, rtx = il, rty = it;
+            }
+            appendFormatted(output,
               "    %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, "
               "%.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g, %.9g,\n",
               pl,
               pb,
-              il,
-              ib,
+              lbx,
+              lby,
               pr,
               pb,
-              ir,
-              ib,
+              rbx,
+              rby,
               pl,
               pt,
-              il,
-              it,
+              ltx,
+              lty,
               pr,
               pt,
-              ir,
-              it,
+              rtx,
+              rty,
               pl,
               pt,
-              il,
-              it,
+              ltx,
+              lty,
               pr,
               pb,
-              ir,
-              ib);
+              rbx,
+              rby);
           }
           double advance = glyph->getAdvance();
           fonts[i].getAdvance(advance, cp[0], cp[1]);
@@ -191,12 +215,68 @@ bool generateShadronPreview(const FontGeometry *fonts,
     }
     textWidth = std::max(textWidth, x);
     y += fsScale * fontMetrics.descenderY;
-    fputs("};\n", file);
-    fprintf(file, "const vec2 textSize = vec2(%.9g, %.9g);\n\n", textWidth, -y);
+    output += "};\n";
+    appendFormatted(output, "const vec2 textSize = vec2(%.9g, %.9g);\n\n", textWidth, -y);
   }
-  fputs("PREVIEW_IMAGE(Preview, Atlas, txRange, vec3(1.0), textQuadVertices, textSize, ivec2(1200, 400));\n", file);
-  fputs("export png(Preview, \"preview.png\");\n", file);
+  output += "PREVIEW_IMAGE(Preview, Atlas, txRange, vec3(1.0), textQuadVertices, textSize, ivec2(1200, 400));\n";
+  output += "export png(Preview, \"preview.png\");\n";
+  return anyGlyphs;
+}
+
+bool generateShadronPreview(const FontGeometry *fonts,
+  int fontCount,
+  ImageType atlasType,
+  int atlasWidth,
+  int atlasHeight,
+  double pxRange,
+  const unicode_t *text,
+  const char *imageFilename,
+  bool fullRange,
+  const char *outputFilename)
+{
+  if (fontCount <= 0) return false;
+  std::string output;
+  std::string imagePath = imageFilename ? relativizePath(outputFilename, imageFilename) : std::string();
+  bool anyGlyphs = writeShadronPreview(output,
+    fonts,
+    fontCount,
+    atlasType,
+    atlasWidth,
+    atlasHeight,
+    pxRange,
+    text,
+    imageFilename ? imagePath.c_str() : nullptr,
+    fullRange);
+  FILE *file = nullptr;
+  errno_t err = fopen_s(&file, outputFilename, "w");
+  if (err != 0) { return false; }
+  fwrite(output.data(), 1, output.size(), file);
   fclose(file);
   return anyGlyphs;
 }
+
+bool generateShadronPreview(std::string &output,
+  const FontGeometry *fonts,
+  int fontCount,
+  ImageType atlasType,
+  int atlasWidth,
+  int atlasHeight,
+  double pxRange,
+  const unicode_t *text,
+  const char *imagePath,
+  bool fullRange)
+{
+  output.clear();
+  if (fontCount <= 0) return false;
+  return writeShadronPreview(output,
+    fonts,
+    fontCount,
+    atlasType,
+    atlasWidth,
+    atlasHeight,
+    pxRange,
+    text,
+    imagePath,
+    fullRange);
+}
 }// namespace msdf_atlas
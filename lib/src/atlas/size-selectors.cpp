@@ -1,18 +1,22 @@
+#include <algorithm>
 #include <cmath>
 
 #include "atlas/size-selectors.hpp"
 
 namespace msdf_atlas {
-template<int MULTIPLE> SquareSizeSelector<MULTIPLE>::SquareSizeSelector(int minArea) : lowerBound(0), upperBound(-1)
+template<int MULTIPLE>
+SquareSizeSelector<MULTIPLE>::SquareSizeSelector(int minArea, int minWidth, int minHeight)
+  : lowerBound(0), upperBound(-1)
 {
   if (minArea > 0) lowerBound = int(sqrt(minArea - 1)) / MULTIPLE + 1;
+  lowerBound = std::max(lowerBound, (std::max(minWidth, minHeight) + MULTIPLE - 1) / MULTIPLE);
   updateCurrent();
 }
 
 template<int MULTIPLE> void SquareSizeSelector<MULTIPLE>::updateCurrent()
 {
   if (upperBound < 0)
-    current = 5 * lowerBound / 4 + 16 / MULTIPLE + 1;
+    current = lowerBound + lowerBound / 16 + 16 / MULTIPLE + 1;
   else
     current = lowerBound + (upperBound - lowerBound) / 2;
 }
@@ -41,9 +45,9 @@ template class SquareSizeSelector<1>;
 template class SquareSizeSelector<2>;
 template class SquareSizeSelector<4>;
 
-SquarePowerOfTwoSizeSelector::SquarePowerOfTwoSizeSelector(int minArea) : side(1)
+SquarePowerOfTwoSizeSelector::SquarePowerOfTwoSizeSelector(int minArea, int minWidth, int minHeight) : side(1)
 {
-  while (side * side < minArea) side <<= 1;
+  while (side * side < minArea || side < minWidth || side < minHeight) side <<= 1;
 }
 
 bool SquarePowerOfTwoSizeSelector::operator()(int &width, int &height) const
@@ -64,9 +68,9 @@ SquarePowerOfTwoSizeSelector &SquarePowerOfTwoSizeSelector::operator--()
   return *this;
 }
 
-PowerOfTwoSizeSelector::PowerOfTwoSizeSelector(int minArea) : w(1), h(1)
+PowerOfTwoSizeSelector::PowerOfTwoSizeSelector(int minArea, int minWidth, int minHeight) : w(1), h(1)
 {
-  while (w * h < minArea) ++*this;
+  while (w * h < minArea || w < minWidth || h < minHeight) ++*this;
 }
 
 bool PowerOfTwoSizeSelector::operator()(int &width, int &height) const
@@ -0,0 +1,289 @@
+#include "core/GeneratorContext.hpp"
+#include "core/MSDFErrorCorrection.hpp"
+#include "core/arithmetics.hpp"
+
+namespace msdfgen {
+template<typename DistanceType> class DistancePixelConversion;
+
+template<> class DistancePixelConversion<double>
+{
+  double invRange;
+
+public:
+  typedef BitmapRef<float, 1> BitmapRefType;
+  inline explicit DistancePixelConversion(double range) : invRange(1 / range) {}
+  inline void operator()(float *pixels, double distance) const { *pixels = float(invRange * distance + .5); }
+};
+
+template<> class DistancePixelConversion<MultiDistance>
+{
+  double invRange;
+
+public:
+  typedef BitmapRef<float, 3> BitmapRefType;
+  inline explicit DistancePixelConversion(double range) : invRange(1 / range) {}
+  inline void operator()(float *pixels, const MultiDistance &distance) const
+  {
+    pixels[0] = float(invRange * distance.r + .5);
+    pixels[1] = float(invRange * distance.g + .5);
+    pixels[2] = float(invRange * distance.b + .5);
+  }
+};
+
+template<> class DistancePixelConversion<MultiAndTrueDistance>
+{
+  double invRange;
+
+public:
+  typedef BitmapRef<float, 4> BitmapRefType;
+  inline explicit DistancePixelConversion(double range) : invRange(1 / range) {}
+  inline void operator()(float *pixels, const MultiAndTrueDistance &distance) const
+  {
+    pixels[0] = float(invRange * distance.r + .5);
+    pixels[1] = float(invRange * distance.g + .5);
+    pixels[2] = float(invRange * distance.b + .5);
+    pixels[3] = float(invRange * distance.a + .5);
+  }
+};
+
+template<class ContourCombiner>
+static void generateDistanceField(
+  const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output,
+  ShapeDistanceFinder<ContourCombiner> &distanceFinder,
+  const Shape &shape,
+  const Projection &projection,
+  double range)
+{
+  DistancePixelConversion<typename ContourCombiner::DistanceType> distancePixelConversion(range);
+  distanceFinder.setShape(shape);
+  bool rightToLeft = false;
+  for (int y = 0; y < output.height; ++y) {
+    int row = shape.inverseYAxis ? output.height - y - 1 : y;
+    for (int col = 0; col < output.width; ++col) {
+      int x = rightToLeft ? output.width - col - 1 : col;
+      Point2 p = projection.unproject(Point2(x + .5, y + .5));
+      typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
+      distancePixelConversion(output(x, row), distance);
+    }
+    rightToLeft = !rightToLeft;
+  }
+}
+
+GeneratorContext::GeneratorContext() {}
+
+void GeneratorContext::generateSDF(const BitmapRef<float, 1> &output,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const GeneratorConfig &config)
+{
+  if (config.overlapSupport)
+    generateDistanceField(output, overlappingFinders.trueDistance, shape, projection, range);
+  else
+    generateDistanceField(output, simpleFinders.trueDistance, shape, projection, range);
+}
+
+void GeneratorContext::generatePSDF(const BitmapRef<float, 1> &output,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const GeneratorConfig &config)
+{
+  if (config.overlapSupport)
+    generateDistanceField(output, overlappingFinders.perpendicularDistance, shape, projection, range);
+  else
+    generateDistanceField(output, simpleFinders.perpendicularDistance, shape, projection, range);
+}
+
+void GeneratorContext::generateMSDF(const BitmapRef<float, 3> &output,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const MSDFGeneratorConfig &config)
+{
+  if (config.overlapSupport)
+    generateDistanceField(output, overlappingFinders.multiDistance, shape, projection, range);
+  else
+    generateDistanceField(output, simpleFinders.multiDistance, shape, projection, range);
+  msdfErrorCorrection(output, shape, projection, range, config);
+}
+
+void GeneratorContext::generateMTSDF(const BitmapRef<float, 4> &output,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const MSDFGeneratorConfig &config)
+{
+  if (config.overlapSupport)
+    generateDistanceField(output, overlappingFinders.multiAndTrueDistance, shape, projection, range);
+  else
+    generateDistanceField(output, simpleFinders.multiAndTrueDistance, shape, projection, range);
+  msdfErrorCorrection(output, shape, projection, range, config);
+}
+
+template<int N>
+void GeneratorContext::msdfErrorCorrectionInner(const BitmapRef<float, N> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const MSDFGeneratorConfig &config)
+{
+  if (config.errorCorrection.mode == ErrorCorrectionConfig::DISABLED || !(sdf.width && sdf.height)) return;
+  BitmapRef<byte, 1> stencilRef(config.errorCorrection.buffer, sdf.width, sdf.height);
+  if (!stencilRef.pixels) {
+    if (stencil.size() < (size_t)sdf.width * sdf.height) stencil.resize((size_t)sdf.width * sdf.height);
+    stencilRef.pixels = stencil.data();
+  }
+  MSDFErrorCorrection ec(stencilRef, projection, range);
+  ec.setMinDeviationRatio(config.errorCorrection.minDeviationRatio);
+  ec.setMinImproveRatio(config.errorCorrection.minImproveRatio);
+  switch (config.errorCorrection.mode) {
+  case ErrorCorrectionConfig::DISABLED:
+  case ErrorCorrectionConfig::INDISCRIMINATE:
+    break;
+  case ErrorCorrectionConfig::EDGE_PRIORITY:
+    ec.protectCorners(shape);
+    ec.protectEdges<N>(sdf);
+    break;
+  case ErrorCorrectionConfig::EDGE_ONLY:
+    ec.protectAll();
+    break;
+  }
+  if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE
+      || (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE
+          && config.errorCorrection.mode != ErrorCorrectionConfig::EDGE_ONLY)) {
+    ec.findErrors<N>(sdf);
+    if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE) ec.protectAll();
+  }
+  if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::ALWAYS_CHECK_DISTANCE
+      || config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE) {
+    if (config.overlapSupport) {
+      overlappingFinders.perpendicularDistance.setShape(shape);
+      ec.findErrors<OverlappingContourCombiner, N>(sdf, shape, overlappingFinders.perpendicularDistance);
+    } else {
+      simpleFinders.perpendicularDistance.setShape(shape);
+      ec.findErrors<SimpleContourCombiner, N>(sdf, shape, simpleFinders.perpendicularDistance);
+    }
+  }
+  ec.apply(sdf);
+}
+
+void GeneratorContext::msdfErrorCorrection(const BitmapRef<float, 3> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const MSDFGeneratorConfig &config)
+{
+  msdfErrorCorrectionInner(sdf, shape, projection, range, config);
+}
+
+void GeneratorContext::msdfErrorCorrection(const BitmapRef<float, 4> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  double range,
+  const MSDFGeneratorConfig &config)
+{
+  msdfErrorCorrectionInner(sdf, shape, projection, range, config);
+}
+
+void GeneratorContext::rasterize(const BitmapRef<float, 1> &output,
+  const Shape &shape,
+  const Projection &projection,
+  FillRule fillRule)
+{
+  for (int y = 0; y < output.height; ++y) {
+    int row = shape.inverseYAxis ? output.height - y - 1 : y;
+    shape.scanline(scanline, projection.unprojectY(y + .5), intersections);
+    for (int x = 0; x < output.width; ++x)
+      *output(x, row) = (float)scanline.filled(projection.unprojectX(x + .5), fillRule);
+  }
+}
+
+void GeneratorContext::distanceSignCorrection(const BitmapRef<float, 1> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  FillRule fillRule)
+{
+  for (int y = 0; y < sdf.height; ++y) {
+    int row = shape.inverseYAxis ? sdf.height - y - 1 : y;
+    shape.scanline(scanline, projection.unprojectY(y + .5), intersections);
+    for (int x = 0; x < sdf.width; ++x) {
+      bool fill = scanline.filled(projection.unprojectX(x + .5), fillRule);
+      float &sd = *sdf(x, row);
+      if ((sd > .5f) != fill) sd = 1.f - sd;
+    }
+  }
+}
+
+template<int N>
+void GeneratorContext::multiDistanceSignCorrection(const BitmapRef<float, N> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  FillRule fillRule)
+{
+  int w = sdf.width, h = sdf.height;
+  if (!(w * h)) return;
+  bool ambiguous = false;
+  signMatches.assign(w * h, 0);
+  char *match = &signMatches[0];
+  for (int y = 0; y < h; ++y) {
+    int row = shape.inverseYAxis ? h - y - 1 : y;
+    shape.scanline(scanline, projection.unprojectY(y + .5), intersections);
+    for (int x = 0; x < w; ++x) {
+      bool fill = scanline.filled(projection.unprojectX(x + .5), fillRule);
+      float *msd = sdf(x, row);
+      float sd = median(msd[0], msd[1], msd[2]);
+      if (sd == .5f)
+        ambiguous = true;
+      else if ((sd > .5f) != fill) {
+        msd[0] = 1.f - msd[0];
+        msd[1] = 1.f - msd[1];
+        msd[2] = 1.f - msd[2];
+        *match = -1;
+      } else
+        *match = 1;
+      if (N >= 4 && (msd[3] > .5f) != fill) msd[3] = 1.f - msd[3];
+      ++match;
+    }
+  }
+  // This step is necessary to avoid artifacts when whole shape is inverted
+  if (ambiguous) {
+    match = &signMatches[0];
+    for (int y = 0; y < h; ++y) {
+      int row = shape.inverseYAxis ? h - y - 1 : y;
+      for (int x = 0; x < w; ++x) {
+        if (!*match) {
+          int neighborMatch = 0;
+          if (x > 0) neighborMatch += *(match - 1);
+          if (x < w - 1) neighborMatch += *(match + 1);
+          if (y > 0) neighborMatch += *(match - w);
+          if (y < h - 1) neighborMatch += *(match + w);
+          if (neighborMatch < 0) {
+            float *msd = sdf(x, row);
+            msd[0] = 1.f - msd[0];
+            msd[1] = 1.f - msd[1];
+            msd[2] = 1.f - msd[2];
+          }
+        }
+        ++match;
+      }
+    }
+  }
+}
+
+void GeneratorContext::distanceSignCorrection(const BitmapRef<float, 3> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  FillRule fillRule)
+{
+  multiDistanceSignCorrection(sdf, shape, projection, fillRule);
+}
+
+void GeneratorContext::distanceSignCorrection(const BitmapRef<float, 4> &sdf,
+  const Shape &shape,
+  const Projection &projection,
+  FillRule fillRule)
+{
+  multiDistanceSignCorrection(sdf, shape, projection, fillRule);
+}
+}// namespace msdfgen
@@ -101,11 +101,11 @@ public:
   const float *msd;
   bool protectedFlag;
   inline ShapeDistanceChecker(const BitmapConstRef<float, N> &sdf,
-    const Shape &shape,
+    ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> &distanceFinder,
     const Projection &projection,
     double invRange,
     double minImproveRatio)
-    : distanceFinder(shape), sdf(sdf), invRange(invRange), minImproveRatio(minImproveRatio)
+    : distanceFinder(distanceFinder), sdf(sdf), invRange(invRange), minImproveRatio(minImproveRatio)
   {
     texelSize = projection.unprojectVector(Vector2(1));
   }
@@ -115,7 +115,7 @@ public:
   }
 
 private:
-  ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> distanceFinder;
+  ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> &distanceFinder;
   BitmapConstRef<float, N> sdf;
   double invRange;
   Vector2 texelSize;
@@ -456,13 +456,23 @@ template<int N> void MSDFErrorCorrection::findErrors(const BitmapConstRef<float,
 
 template<template<typename> class ContourCombiner, int N>
 void MSDFErrorCorrection::findErrors(const BitmapConstRef<float, N> &sdf, const Shape &shape)
+{
+  ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> distanceFinder(shape);
+  findErrors<ContourCombiner, N>(sdf, shape, distanceFinder);
+}
+
+template<template<typename> class ContourCombiner, int N>
+void MSDFErrorCorrection::findErrors(const BitmapConstRef<float, N> &sdf,
+  const Shape &shape,
+  ShapeDistanceFinder<ContourCombiner<PerpendicularDistanceSelector>> &distanceFinder)
 {
   // Compute the expected deltas between values of horizontally, vertically, and diagonally adjacent texels.
   double hSpan = minDeviationRatio * projection.unprojectVector(Vector2(invRange, 0)).length();
   double vSpan = minDeviationRatio * projection.unprojectVector(Vector2(0, invRange)).length();
   double dSpan = minDeviationRatio * projection.unprojectVector(Vector2(invRange)).length();
   {
-    ShapeDistanceChecker<ContourCombiner, N> shapeDistanceChecker(sdf, shape, projection, invRange, minImproveRatio);
+    ShapeDistanceChecker<ContourCombiner, N> shapeDistanceChecker(
+      sdf, distanceFinder, projection, invRange, minImproveRatio);
     bool rightToLeft = false;
     for (int y = 0; y < sdf.height; ++y) {
       int row = shape.inverseYAxis ? sdf.height - y - 1 : y;
@@ -539,6 +549,18 @@ template void MSDFErrorCorrection::findErrors<OverlappingContourCombiner>(const
   const Shape &shape);
 template void MSDFErrorCorrection::findErrors<OverlappingContourCombiner>(const BitmapConstRef<float, 4> &sdf,
   const Shape &shape);
+template void MSDFErrorCorrection::findErrors<SimpleContourCombiner>(const BitmapConstRef<float, 3> &sdf,
+  const Shape &shape,
+  ShapeDistanceFinder<SimpleContourCombiner<PerpendicularDistanceSelector>> &distanceFinder);
+template void MSDFErrorCorrection::findErrors<SimpleContourCombiner>(const BitmapConstRef<float, 4> &sdf,
+  const Shape &shape,
+  ShapeDistanceFinder<SimpleContourCombiner<PerpendicularDistanceSelector>> &distanceFinder);
+template void MSDFErrorCorrection::findErrors<OverlappingContourCombiner>(const BitmapConstRef<float, 3> &sdf,
+  const Shape &shape,
+  ShapeDistanceFinder<OverlappingContourCombiner<PerpendicularDistanceSelector>> &distanceFinder);
+template void MSDFErrorCorrection::findErrors<OverlappingContourCombiner>(const BitmapConstRef<float, 4> &sdf,
+  const Shape &shape,
+  ShapeDistanceFinder<OverlappingContourCombiner<PerpendicularDistanceSelector>> &distanceFinder);
 template void MSDFErrorCorrection::apply(const BitmapRef<float, 3> &sdf) const;
 template void MSDFErrorCorrection::apply(const BitmapRef<float, 4> &sdf) const;
 
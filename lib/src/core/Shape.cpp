@@ -95,9 +95,10 @@ Shape::Bounds Shape::getBounds(double border, double miterLimit, int polarity) c
   return bounds;
 }
 
-void Shape::scanline(Scanline &line, double y) const
+static void collectIntersections(std::vector<Scanline::Intersection> &intersections,
+  const std::vector<Contour> &contours,
+  double y)
 {
-  std::vector<Scanline::Intersection> intersections;
   double x[3];
   int dy[3];
   for (std::vector<Contour>::const_iterator contour = contours.begin(); contour != contours.end(); ++contour) {
@@ -109,9 +110,23 @@ void Shape::scanline(Scanline &line, double y) const
       }
     }
   }
+}
+
+void Shape::scanline(Scanline &line, double y) const
+{
+  std::vector<Scanline::Intersection> intersections;
+  collectIntersections(intersections, contours, y);
   line.setIntersections((std::vector<Scanline::Intersection> &&)intersections);
 }
 
+void Shape::scanline(Scanline &line, double y, std::vector<Scanline::Intersection> &intersections) const
+{
+  intersections.clear();
+  collectIntersections(intersections, contours, y);
+  // Copied rather than moved, so that both the buffer and the scanline keep their memory
+  line.setIntersections(intersections);
+}
+
 int Shape::edgeCount() const
 {
   int total = 0;
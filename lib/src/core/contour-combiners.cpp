@@ -28,8 +28,15 @@ static double resolveDistance(double distance) { return distance; }
 
 static double resolveDistance(const MultiDistance &distance) { return median(distance.r, distance.g, distance.b); }
 
+template<class EdgeSelector> SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner() {}
+
 template<class EdgeSelector> SimpleContourCombiner<EdgeSelector>::SimpleContourCombiner(const Shape &shape) {}
 
+template<class EdgeSelector> void SimpleContourCombiner<EdgeSelector>::setShape(const Shape &shape)
+{
+  shapeEdgeSelector = EdgeSelector();
+}
+
 template<class EdgeSelector> void SimpleContourCombiner<EdgeSelector>::reset(const Point2 &p)
 {
   shapeEdgeSelector.reset(p);
@@ -51,13 +58,22 @@ template class SimpleContourCombiner<PerpendicularDistanceSelector>;
 template class SimpleContourCombiner<MultiDistanceSelector>;
 template class SimpleContourCombiner<MultiAndTrueDistanceSelector>;
 
+template<class EdgeSelector> OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner() {}
+
 template<class EdgeSelector> OverlappingContourCombiner<EdgeSelector>::OverlappingContourCombiner(const Shape &shape)
 {
+  setShape(shape);
+}
+
+template<class EdgeSelector> void OverlappingContourCombiner<EdgeSelector>::setShape(const Shape &shape)
+{
+  windings.clear();
   windings.reserve(shape.contours.size());
   for (std::vector<Contour>::const_iterator contour = shape.contours.begin(); contour != shape.contours.end();
        ++contour)
     windings.push_back(contour->winding());
-  edgeSelectors.resize(shape.contours.size());
+  // The selectors keep the minimum distance between queries, which must not carry over from another shape
+  edgeSelectors.assign(shape.contours.size(), EdgeSelector());
 }
 
 template<class EdgeSelector> void OverlappingContourCombiner<EdgeSelector>::reset(const Point2 &p)
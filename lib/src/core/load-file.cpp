@@ -0,0 +1,21 @@
+#include <cstdio>
+
+#include "core/load-file.hpp"
+
+namespace msdfgen {
+bool loadFile(std::vector<byte> &data, const char *filename)
+{
+  FILE *file;
+  errno_t err = fopen_s(&file, filename, "rb");
+  if (err != 0) return false;
+  bool success = !fseek(file, 0, SEEK_END);
+  long size = success ? ftell(file) : -1;
+  success = size >= 0 && !fseek(file, 0, SEEK_SET);
+  if (success) {
+    data.resize((size_t)size);
+    success = fread(data.data(), 1, data.size(), file) == data.size();
+  }
+  fclose(file);
+  return success;
+}
+}// namespace msdfgen
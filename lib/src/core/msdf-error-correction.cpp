@@ -1,54 +1,10 @@
 #include "core/msdf-error-correction.hpp"
 #include "core/Bitmap.hpp"
+#include "core/GeneratorContext.hpp"
 #include "core/MSDFErrorCorrection.hpp"
-#include "core/contour-combiners.hpp"
 
 namespace msdfgen {
 
-template<int N>
-static void msdfErrorCorrectionInner(const BitmapRef<float, N> &sdf,
-  const Shape &shape,
-  const Projection &projection,
-  double range,
-  const MSDFGeneratorConfig &config)
-{
-  if (config.errorCorrection.mode == ErrorCorrectionConfig::DISABLED) return;
-  Bitmap<byte, 1> stencilBuffer;
-  if (!config.errorCorrection.buffer) stencilBuffer = Bitmap<byte, 1>(sdf.width, sdf.height);
-  BitmapRef<byte, 1> stencil;
-  stencil.pixels = config.errorCorrection.buffer ? config.errorCorrection.buffer : (byte *)stencilBuffer;
-  stencil.width = sdf.width, stencil.height = sdf.height;
-  MSDFErrorCorrection ec(stencil, projection, range);
-  ec.setMinDeviationRatio(config.errorCorrection.minDeviationRatio);
-  ec.setMinImproveRatio(config.errorCorrection.minImproveRatio);
-  switch (config.errorCorrection.mode) {
-  case ErrorCorrectionConfig::DISABLED:
-  case ErrorCorrectionConfig::INDISCRIMINATE:
-    break;
-  case ErrorCorrectionConfig::EDGE_PRIORITY:
-    ec.protectCorners(shape);
-    ec.protectEdges<N>(sdf);
-    break;
-  case ErrorCorrectionConfig::EDGE_ONLY:
-    ec.protectAll();
-    break;
-  }
-  if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE
-      || (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE
-          && config.errorCorrection.mode != ErrorCorrectionConfig::EDGE_ONLY)) {
-    ec.findErrors<N>(sdf);
-    if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE) ec.protectAll();
-  }
-  if (config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::ALWAYS_CHECK_DISTANCE
-      || config.errorCorrection.distanceCheckMode == ErrorCorrectionConfig::CHECK_DISTANCE_AT_EDGE) {
-    if (config.overlapSupport)
-      ec.findErrors<OverlappingContourCombiner, N>(sdf, shape);
-    else
-      ec.findErrors<SimpleContourCombiner, N>(sdf, shape);
-  }
-  ec.apply(sdf);
-}
-
 template<int N>
 static void msdfErrorCorrectionShapeless(const BitmapRef<float, N> &sdf,
   const Projection &projection,
@@ -70,7 +26,7 @@ void msdfErrorCorrection(const BitmapRef<float, 3> &sdf,
   double range,
   const MSDFGeneratorConfig &config)
 {
-  msdfErrorCorrectionInner(sdf, shape, projection, range, config);
+  GeneratorContext().msdfErrorCorrection(sdf, shape, projection, range, config);
 }
 void msdfErrorCorrection(const BitmapRef<float, 4> &sdf,
   const Shape &shape,
@@ -78,7 +34,7 @@ void msdfErrorCorrection(const BitmapRef<float, 4> &sdf,
   double range,
   const MSDFGeneratorConfig &config)
 {
-  msdfErrorCorrectionInner(sdf, shape, projection, range, config);
+  GeneratorContext().msdfErrorCorrection(sdf, shape, projection, range, config);
 }
 
 void msdfFastDistanceErrorCorrection(const BitmapRef<float, 3> &sdf,
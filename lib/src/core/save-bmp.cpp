@@ -3,156 +3,131 @@
 
 #include "core/pixel-conversion.hpp"
 #include "core/save-bmp.hpp"
+#include "core/save-file.hpp"
 
 namespace msdfgen {
 
-template<typename T> static bool writeValue(FILE *file, T value)
+template<typename T> static void writeValue(std::vector<byte> &output, T value)
 {
-#ifdef __BIG_ENDIAN__
-  T reverse = 0;
-  for (int i = 0; i < sizeof(T); ++i) {
-    reverse <<= 8;
-    reverse |= value & T(0xff);
-    value >>= 8;
-  }
-  return fwrite(&reverse, sizeof(T), 1, file) == 1;
-#else
-  return fwrite(&value, sizeof(T), 1, file) == 1;
-#endif
+  // BMP is always little-endian
+  for (int i = 0; i < (int)sizeof(T); ++i) output.push_back((byte)((uint64_t)value >> 8 * i));
 }
 
-static bool writeBmpHeader(FILE *file, int width, int height, int &paddedWidth)
+void writeBmpHeader(std::vector<byte> &output, int width, int height, int &paddedWidth)
 {
   paddedWidth = (3 * width + 3) & ~3;
   const uint32_t bitmapStart = 54;
   const uint32_t bitmapSize = paddedWidth * height;
   const uint32_t fileSize = bitmapStart + bitmapSize;
 
-  writeValue<uint16_t>(file, 0x4d42u);
-  writeValue<uint32_t>(file, fileSize);
-  writeValue<uint16_t>(file, 0);
-  writeValue<uint16_t>(file, 0);
-  writeValue<uint32_t>(file, bitmapStart);
-
-  writeValue<uint32_t>(file, 40);
-  writeValue<int32_t>(file, width);
-  writeValue<int32_t>(file, height);
-  writeValue<uint16_t>(file, 1);
-  writeValue<uint16_t>(file, 24);
-  writeValue<uint32_t>(file, 0);
-  writeValue<uint32_t>(file, bitmapSize);
-  writeValue<uint32_t>(file, 2835);
-  writeValue<uint32_t>(file, 2835);
-  writeValue<uint32_t>(file, 0);
-  writeValue<uint32_t>(file, 0);
+  writeValue<uint16_t>(output, 0x4d42u);
+  writeValue<uint32_t>(output, fileSize);
+  writeValue<uint16_t>(output, 0);
+  writeValue<uint16_t>(output, 0);
+  writeValue<uint32_t>(output, bitmapStart);
+
+  writeValue<uint32_t>(output, 40);
+  writeValue<int32_t>(output, width);
+  writeValue<int32_t>(output, height);
+  writeValue<uint16_t>(output, 1);
+  writeValue<uint16_t>(output, 24);
+  writeValue<uint32_t>(output, 0);
+  writeValue<uint32_t>(output, bitmapSize);
+  writeValue<uint32_t>(output, 2835);
+  writeValue<uint32_t>(output, 2835);
+  writeValue<uint32_t>(output, 0);
+  writeValue<uint32_t>(output, 0);
+}
 
-  return true;
+bool writeBmpHeader(FILE *file, int width, int height, int &paddedWidth)
+{
+  std::vector<byte> header;
+  writeBmpHeader(header, width, height, paddedWidth);
+  return fwrite(header.data(), 1, header.size(), file) == header.size();
 }
 
-bool saveBmp(const BitmapConstRef<byte, 1> &bitmap, const char *filename)
+template<typename T, int N>
+static void writeBmpStart(std::vector<byte> &output, const BitmapConstRef<T, N> &bitmap, int &paddedWidth)
 {
-  FILE *file;
-  errno_t err = fopen_s(&file, filename, "wb");
-  if (err != 0) return false;
+  writeBmpHeader(output, bitmap.width, bitmap.height, paddedWidth);
+  output.reserve(output.size() + (size_t)paddedWidth * bitmap.height);
+}
 
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<byte, 1> &bitmap)
+{
   int paddedWidth;
-  writeBmpHeader(file, bitmap.width, bitmap.height, paddedWidth);
-
-  const uint8_t padding[4] = {};
-  int padLength = paddedWidth - 3 * bitmap.width;
+  writeBmpStart(output, bitmap, paddedWidth);
   for (int y = 0; y < bitmap.height; ++y) {
-    for (int x = 0; x < bitmap.width; ++x) {
-      uint8_t px = (uint8_t)*bitmap(x, y);
-      fwrite(&px, sizeof(uint8_t), 1, file);
-      fwrite(&px, sizeof(uint8_t), 1, file);
-      fwrite(&px, sizeof(uint8_t), 1, file);
-    }
-    fwrite(padding, 1, padLength, file);
+    for (int x = 0; x < bitmap.width; ++x) output.insert(output.end(), 3, *bitmap(x, y));
+    output.insert(output.end(), paddedWidth - 3 * bitmap.width, 0);
   }
-
-  return !fclose(file);
+  return true;
 }
 
-bool saveBmp(const BitmapConstRef<byte, 3> &bitmap, const char *filename)
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<byte, 3> &bitmap)
 {
-  FILE *file;
-  errno_t err = fopen_s(&file, filename, "wb");
-  if (err != 0) return false;
-
   int paddedWidth;
-  writeBmpHeader(file, bitmap.width, bitmap.height, paddedWidth);
-
-  const uint8_t padding[4] = {};
-  int padLength = paddedWidth - 3 * bitmap.width;
+  writeBmpStart(output, bitmap, paddedWidth);
   for (int y = 0; y < bitmap.height; ++y) {
     for (int x = 0; x < bitmap.width; ++x) {
-      uint8_t bgr[3] = { (uint8_t)bitmap(x, y)[2], (uint8_t)bitmap(x, y)[1], (uint8_t)bitmap(x, y)[0] };
-      fwrite(bgr, sizeof(uint8_t), 3, file);
+      byte bgr[3] = { bitmap(x, y)[2], bitmap(x, y)[1], bitmap(x, y)[0] };
+      output.insert(output.end(), bgr, bgr + 3);
     }
-    fwrite(padding, 1, padLength, file);
+    output.insert(output.end(), paddedWidth - 3 * bitmap.width, 0);
   }
-
-  return !fclose(file);
+  return true;
 }
 
-bool saveBmp(const BitmapConstRef<byte, 4> &bitmap, const char *filename)
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<byte, 4> &bitmap)
 {
   // RGBA not supported by the BMP format
   return false;
 }
 
-bool saveBmp(const BitmapConstRef<float, 1> &bitmap, const char *filename)
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<float, 1> &bitmap)
 {
-  FILE *file;
-  errno_t err = fopen_s(&file, filename, "wb");
-  if (err != 0) return false;
-
   int paddedWidth;
-  writeBmpHeader(file, bitmap.width, bitmap.height, paddedWidth);
-
-  const uint8_t padding[4] = {};
-  int padLength = paddedWidth - 3 * bitmap.width;
+  writeBmpStart(output, bitmap, paddedWidth);
   for (int y = 0; y < bitmap.height; ++y) {
-    for (int x = 0; x < bitmap.width; ++x) {
-      uint8_t px = (uint8_t)pixelFloatToByte(*bitmap(x, y));
-      fwrite(&px, sizeof(uint8_t), 1, file);
-      fwrite(&px, sizeof(uint8_t), 1, file);
-      fwrite(&px, sizeof(uint8_t), 1, file);
-    }
-    fwrite(padding, 1, padLength, file);
+    for (int x = 0; x < bitmap.width; ++x) output.insert(output.end(), 3, pixelFloatToByte(*bitmap(x, y)));
+    output.insert(output.end(), paddedWidth - 3 * bitmap.width, 0);
   }
-
-  return !fclose(file);
+  return true;
 }
 
-bool saveBmp(const BitmapConstRef<float, 3> &bitmap, const char *filename)
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<float, 3> &bitmap)
 {
-  FILE *file;
-  errno_t err = fopen_s(&file, filename, "wb");
-  if (err != 0) return false;
-
   int paddedWidth;
-  writeBmpHeader(file, bitmap.width, bitmap.height, paddedWidth);
-
-  const uint8_t padding[4] = {};
-  int padLength = paddedWidth - 3 * bitmap.width;
+  writeBmpStart(output, bitmap, paddedWidth);
   for (int y = 0; y < bitmap.height; ++y) {
     for (int x = 0; x < bitmap.width; ++x) {
-      uint8_t bgr[3] = { (uint8_t)pixelFloatToByte(bitmap(x, y)[2]),
-        (uint8_t)pixelFloatToByte(bitmap(x, y)[1]),
-        (uint8_t)pixelFloatToByte(bitmap(x, y)[0]) };
-      fwrite(bgr, sizeof(uint8_t), 3, file);
+      byte bgr[3] = { pixelFloatToByte(bitmap(x, y)[2]),
+        pixelFloatToByte(bitmap(x, y)[1]),
+        pixelFloatToByte(bitmap(x, y)[0]) };
+      output.insert(output.end(), bgr, bgr + 3);
     }
-    fwrite(padding, 1, padLength, file);
+    output.insert(output.end(), paddedWidth - 3 * bitmap.width, 0);
   }
-
-  return !fclose(file);
+  return true;
 }
 
-bool saveBmp(const BitmapConstRef<float, 4> &bitmap, const char *filename)
+bool encodeBmp(std::vector<byte> &output, const BitmapConstRef<float, 4> &bitmap)
 {
   // RGBA not supported by the BMP format
   return false;
 }
 
+template<typename T, int N> static bool saveBmpFile(const BitmapConstRef<T, N> &bitmap, const char *filename)
+{
+  std::vector<byte> data;
+  return encodeBmp(data, bitmap) && saveFile(data, filename);
+}
+
+bool saveBmp(const BitmapConstRef<byte, 1> &bitmap, const char *filename) { return saveBmpFile(bitmap, filename); }
+bool saveBmp(const BitmapConstRef<byte, 3> &bitmap, const char *filename) { return saveBmpFile(bitmap, filename); }
+bool saveBmp(const BitmapConstRef<byte, 4> &bitmap, const char *filename) { return saveBmpFile(bitmap, filename); }
+bool saveBmp(const BitmapConstRef<float, 1> &bitmap, const char *filename) { return saveBmpFile(bitmap, filename); }
+bool saveBmp(const BitmapConstRef<float, 3> &bitmap, const char *filename) { return saveBmpFile(bitmap, filename); }
+bool saveBmp(const BitmapConstRef<float, 4> &bitmap, const char *filename) { return saveBmpFile(bitmap, filename); }
+
 }// namespace msdfgen
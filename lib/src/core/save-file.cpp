@@ -0,0 +1,14 @@
+#include <cstdio>
+
+#include "core/save-file.hpp"
+
+namespace msdfgen {
+bool saveFile(const std::vector<byte> &data, const char *filename)
+{
+  FILE *file;
+  errno_t err = fopen_s(&file, filename, "wb");
+  if (err != 0) return false;
+  bool success = fwrite(data.data(), 1, data.size(), file) == data.size();
+  return !fclose(file) && success;
+}
+}// namespace msdfgen
@@ -1,170 +1,203 @@
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 
 #include "core/save-tiff.hpp"
+#include "core/save-file.hpp"
 
 namespace msdfgen {
 
-template<typename T> static bool writeValue(FILE *file, T value) { return fwrite(&value, sizeof(T), 1, file) == 1; }
-template<typename T> static void writeValueRepeated(FILE *file, T value, int times)
+// TIFF is written in native byte order, which is indicated at the start of the header
+template<typename T> static void writeValue(std::vector<byte> &output, T value)
 {
-  for (int i = 0; i < times; ++i) writeValue(file, value);
+  byte bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  output.insert(output.end(), bytes, bytes + sizeof(T));
+}
+template<typename T> static void writeValueRepeated(std::vector<byte> &output, T value, int times)
+{
+  for (int i = 0; i < times; ++i) writeValue(output, value);
 }
 
-static bool writeTiffHeader(FILE *file, int width, int height, int channels)
+void writeTiffHeader(std::vector<byte> &output, int width, int height, int channels)
 {
 #ifdef __BIG_ENDIAN__
-  writeValue<uint16_t>(file, 0x4d4du);
+  writeValue<uint16_t>(output, 0x4d4du);
 #else
-  writeValue<uint16_t>(file, 0x4949u);
+  writeValue<uint16_t>(output, 0x4949u);
 #endif
-  writeValue<uint16_t>(file, 42);
-  writeValue<uint32_t>(file, 0x0008u);// Offset of first IFD
+  writeValue<uint16_t>(output, 42);
+  writeValue<uint32_t>(output, 0x0008u);// Offset of first IFD
   // Offset = 0x0008
 
-  writeValue<uint16_t>(file, 15);// Number of IFD entries
+  writeValue<uint16_t>(output, 15);// Number of IFD entries
 
   // ImageWidth
-  writeValue<uint16_t>(file, 0x0100u);
-  writeValue<uint16_t>(file, 0x0004u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<int32_t>(file, width);
+  writeValue<uint16_t>(output, 0x0100u);
+  writeValue<uint16_t>(output, 0x0004u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<int32_t>(output, width);
   // ImageLength
-  writeValue<uint16_t>(file, 0x0101u);
-  writeValue<uint16_t>(file, 0x0004u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<int32_t>(file, height);
+  writeValue<uint16_t>(output, 0x0101u);
+  writeValue<uint16_t>(output, 0x0004u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<int32_t>(output, height);
   // BitsPerSample
-  writeValue<uint16_t>(file, 0x0102u);
-  writeValue<uint16_t>(file, 0x0003u);
-  writeValue<uint32_t>(file, channels);
+  writeValue<uint16_t>(output, 0x0102u);
+  writeValue<uint16_t>(output, 0x0003u);
+  writeValue<uint32_t>(output, channels);
   if (channels > 1)
-    writeValue<uint32_t>(file, 0x00c2u);// Offset of 32, 32, ...
+    writeValue<uint32_t>(output, 0x00c2u);// Offset of 32, 32, ...
   else {
-    writeValue<uint16_t>(file, 32);
-    writeValue<uint16_t>(file, 0);
+    writeValue<uint16_t>(output, 32);
+    writeValue<uint16_t>(output, 0);
   }
   // Compression
-  writeValue<uint16_t>(file, 0x0103u);
-  writeValue<uint16_t>(file, 0x0003u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint16_t>(file, 1);
-  writeValue<uint16_t>(file, 0);
+  writeValue<uint16_t>(output, 0x0103u);
+  writeValue<uint16_t>(output, 0x0003u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint16_t>(output, 1);
+  writeValue<uint16_t>(output, 0);
   // PhotometricInterpretation
-  writeValue<uint16_t>(file, 0x0106u);
-  writeValue<uint16_t>(file, 0x0003u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint16_t>(file, channels >= 3 ? 2 : 1);
-  writeValue<uint16_t>(file, 0);
+  writeValue<uint16_t>(output, 0x0106u);
+  writeValue<uint16_t>(output, 0x0003u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint16_t>(output, channels >= 3 ? 2 : 1);
+  writeValue<uint16_t>(output, 0);
   // StripOffsets
-  writeValue<uint16_t>(file, 0x0111u);
-  writeValue<uint16_t>(file, 0x0004u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint32_t>(file, 0x00d2u + (channels > 1) * channels * 12);// Offset of pixel data
+  writeValue<uint16_t>(output, 0x0111u);
+  writeValue<uint16_t>(output, 0x0004u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint32_t>(output, 0x00d2u + (channels > 1) * channels * 12);// Offset of pixel data
   // SamplesPerPixel
-  writeValue<uint16_t>(file, 0x0115u);
-  writeValue<uint16_t>(file, 0x0003u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint16_t>(file, channels);
-  writeValue<uint16_t>(file, 0);
+  writeValue<uint16_t>(output, 0x0115u);
+  writeValue<uint16_t>(output, 0x0003u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint16_t>(output, channels);
+  writeValue<uint16_t>(output, 0);
   // RowsPerStrip
-  writeValue<uint16_t>(file, 0x0116u);
-  writeValue<uint16_t>(file, 0x0004u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<int32_t>(file, height);
+  writeValue<uint16_t>(output, 0x0116u);
+  writeValue<uint16_t>(output, 0x0004u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<int32_t>(output, height);
   // StripByteCounts
-  writeValue<uint16_t>(file, 0x0117u);
-  writeValue<uint16_t>(file, 0x0004u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<int32_t>(file, sizeof(float) * channels * width * height);
+  writeValue<uint16_t>(output, 0x0117u);
+  writeValue<uint16_t>(output, 0x0004u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<int32_t>(output, sizeof(float) * channels * width * height);
   // XResolution
-  writeValue<uint16_t>(file, 0x011au);
-  writeValue<uint16_t>(file, 0x0005u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint32_t>(file, 0x00c2u + (channels > 1) * channels * 2);// Offset of 300, 1
+  writeValue<uint16_t>(output, 0x011au);
+  writeValue<uint16_t>(output, 0x0005u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint32_t>(output, 0x00c2u + (channels > 1) * channels * 2);// Offset of 300, 1
   // YResolution
-  writeValue<uint16_t>(file, 0x011bu);
-  writeValue<uint16_t>(file, 0x0005u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint32_t>(file, 0x00cau + (channels > 1) * channels * 2);// Offset of 300, 1
+  writeValue<uint16_t>(output, 0x011bu);
+  writeValue<uint16_t>(output, 0x0005u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint32_t>(output, 0x00cau + (channels > 1) * channels * 2);// Offset of 300, 1
   // ResolutionUnit
-  writeValue<uint16_t>(file, 0x0128u);
-  writeValue<uint16_t>(file, 0x0003u);
-  writeValue<uint32_t>(file, 1);
-  writeValue<uint16_t>(file, 2);
-  writeValue<uint16_t>(file, 0);
+  writeValue<uint16_t>(output, 0x0128u);
+  writeValue<uint16_t>(output, 0x0003u);
+  writeValue<uint32_t>(output, 1);
+  writeValue<uint16_t>(output, 2);
+  writeValue<uint16_t>(output, 0);
   // SampleFormat
-  writeValue<uint16_t>(file, 0x0153u);
-  writeValue<uint16_t>(file, 0x0003u);
-  writeValue<uint32_t>(file, channels);
+  writeValue<uint16_t>(output, 0x0153u);
+  writeValue<uint16_t>(output, 0x0003u);
+  writeValue<uint32_t>(output, channels);
   if (channels > 1)
-    writeValue<uint32_t>(file, 0x00d2u + channels * 2);// Offset of 3, 3, ...
+    writeValue<uint32_t>(output, 0x00d2u + channels * 2);// Offset of 3, 3, ...
   else {
-    writeValue<uint16_t>(file, 3);
-    writeValue<uint16_t>(file, 0);
+    writeValue<uint16_t>(output, 3);
+    writeValue<uint16_t>(output, 0);
   }
   // SMinSampleValue
-  writeValue<uint16_t>(file, 0x0154u);
-  writeValue<uint16_t>(file, 0x000bu);
-  writeValue<uint32_t>(file, channels);
+  writeValue<uint16_t>(output, 0x0154u);
+  writeValue<uint16_t>(output, 0x000bu);
+  writeValue<uint32_t>(output, channels);
   if (channels > 1)
-    writeValue<uint32_t>(file, 0x00d2u + channels * 4);// Offset of 0.f, 0.f, ...
+    writeValue<uint32_t>(output, 0x00d2u + channels * 4);// Offset of 0.f, 0.f, ...
   else
-    writeValue<float>(file, 0.f);
+    writeValue<float>(output, 0.f);
   // SMaxSampleValue
-  writeValue<uint16_t>(file, 0x0155u);
-  writeValue<uint16_t>(file, 0x000bu);
-  writeValue<uint32_t>(file, channels);
+  writeValue<uint16_t>(output, 0x0155u);
+  writeValue<uint16_t>(output, 0x000bu);
+  writeValue<uint32_t>(output, channels);
   if (channels > 1)
-    writeValue<uint32_t>(file, 0x00d2u + channels * 8);// Offset of 1.f, 1.f, ...
+    writeValue<uint32_t>(output, 0x00d2u + channels * 8);// Offset of 1.f, 1.f, ...
   else
-    writeValue<float>(file, 1.f);
+    writeValue<float>(output, 1.f);
   // Offset = 0x00be
 
-  writeValue<uint32_t>(file, 0);
+  writeValue<uint32_t>(output, 0);
 
   if (channels > 1) {
     // 0x00c2 BitsPerSample data
-    writeValueRepeated<uint16_t>(file, 32, channels);
+    writeValueRepeated<uint16_t>(output, 32, channels);
     // 0x00c2 + 2*N XResolution data
-    writeValue<uint32_t>(file, 300);
-    writeValue<uint32_t>(file, 1);
+    writeValue<uint32_t>(output, 300);
+    writeValue<uint32_t>(output, 1);
     // 0x00ca + 2*N YResolution data
-    writeValue<uint32_t>(file, 300);
-    writeValue<uint32_t>(file, 1);
+    writeValue<uint32_t>(output, 300);
+    writeValue<uint32_t>(output, 1);
     // 0x00d2 + 2*N SampleFormat data
-    writeValueRepeated<uint16_t>(file, 3, channels);
+    writeValueRepeated<uint16_t>(output, 3, channels);
     // 0x00d2 + 4*N SMinSampleValue data
-    writeValueRepeated<float>(file, 0.f, channels);
+    writeValueRepeated<float>(output, 0.f, channels);
     // 0x00d2 + 8*N SMaxSampleValue data
-    writeValueRepeated<float>(file, 1.f, channels);
+    writeValueRepeated<float>(output, 1.f, channels);
     // Offset = 0x00d2 + 12*N
   } else {
     // 0x00c2 XResolution data
-    writeValue<uint32_t>(file, 300);
-    writeValue<uint32_t>(file, 1);
+    writeValue<uint32_t>(output, 300);
+    writeValue<uint32_t>(output, 1);
     // 0x00ca YResolution data
-    writeValue<uint32_t>(file, 300);
-    writeValue<uint32_t>(file, 1);
+    writeValue<uint32_t>(output, 300);
+    writeValue<uint32_t>(output, 1);
     // Offset = 0x00d2
   }
+}
 
-  return true;
+bool writeTiffHeader(FILE *file, int width, int height, int channels)
+{
+  std::vector<byte> header;
+  writeTiffHeader(header, width, height, channels);
+  return fwrite(header.data(), 1, header.size(), file) == header.size();
 }
 
-template<int N> bool saveTiffFloat(const BitmapConstRef<float, N> &bitmap, const char *filename)
+template<int N> static bool encodeTiffFloat(std::vector<byte> &output, const BitmapConstRef<float, N> &bitmap)
 {
-  FILE *file;
-  errno_t err = fopen_s(&file, filename, "wb");
-  if (err != 0) return false;
+  writeTiffHeader(output, bitmap.width, bitmap.height, N);
+  size_t rowSize = sizeof(float) * N * bitmap.width;
+  output.reserve(output.size() + rowSize * bitmap.height);
+  for (int y = bitmap.height - 1; y >= 0; --y) {
+    const byte *row = reinterpret_cast<const byte *>(bitmap(0, y));
+    output.insert(output.end(), row, row + rowSize);
+  }
+  return true;
+}
 
-  writeTiffHeader(file, bitmap.width, bitmap.height, N);
-  for (int y = bitmap.height - 1; y >= 0; --y) fwrite(bitmap(0, y), sizeof(float), N * bitmap.width, file);
-  return !fclose(file);
+template<int N> static bool saveTiffFloat(const BitmapConstRef<float, N> &bitmap, const char *filename)
+{
+  std::vector<byte> data;
+  return encodeTiffFloat(data, bitmap) && saveFile(data, filename);
 }
 
 bool saveTiff(const BitmapConstRef<float, 1> &bitmap, const char *filename) { return saveTiffFloat(bitmap, filename); }
 bool saveTiff(const BitmapConstRef<float, 3> &bitmap, const char *filename) { return saveTiffFloat(bitmap, filename); }
 bool saveTiff(const BitmapConstRef<float, 4> &bitmap, const char *filename) { return saveTiffFloat(bitmap, filename); }
 
+bool encodeTiff(std::vector<byte> &output, const BitmapConstRef<float, 1> &bitmap)
+{
+  return encodeTiffFloat(output, bitmap);
+}
+bool encodeTiff(std::vector<byte> &output, const BitmapConstRef<float, 3> &bitmap)
+{
+  return encodeTiffFloat(output, bitmap);
+}
+bool encodeTiff(std::vector<byte> &output, const BitmapConstRef<float, 4> &bitmap)
+{
+  return encodeTiffFloat(output, bitmap);
+}
+
 }// namespace msdfgen
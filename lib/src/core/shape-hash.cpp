@@ -0,0 +1,55 @@
+#include "core/shape-hash.hpp"
+#include "core/fnv-hash.hpp"
+
+namespace msdfgen {
+static void hashShape(unsigned long long &hash, const Shape &shape, bool colors)
+{
+  fnvHashValue(hash, (int)shape.inverseYAxis);
+  fnvHashValue(hash, (int)shape.contours.size());
+  for (const Contour &contour : shape.contours) {
+    fnvHashValue(hash, (int)contour.edges.size());
+    for (const EdgeHolder &edge : contour.edges) {
+      int type = edge->type();
+      fnvHashValue(hash, type);
+      if (colors) fnvHashValue(hash, (int)edge->color);
+      const Point2 *points = edge->controlPoints();
+      for (int i = 0; i <= type; ++i) {
+        fnvHashValue(hash, points[i].x);
+        fnvHashValue(hash, points[i].y);
+      }
+    }
+  }
+}
+
+unsigned long long shapeHash(const Shape &shape)
+{
+  unsigned long long hash = MSDFGEN_FNV_OFFSET_BASIS;
+  hashShape(hash, shape, false);
+  return hash;
+}
+
+unsigned long long coloredShapeHash(const Shape &shape)
+{
+  unsigned long long hash = MSDFGEN_FNV_OFFSET_BASIS;
+  hashShape(hash, shape, true);
+  return hash;
+}
+
+bool shapeGeometryEquals(const Shape &a, const Shape &b)
+{
+  if (a.inverseYAxis != b.inverseYAxis || a.contours.size() != b.contours.size()) return false;
+  for (size_t i = 0; i < a.contours.size(); ++i) {
+    const std::vector<EdgeHolder> &aEdges = a.contours[i].edges, &bEdges = b.contours[i].edges;
+    if (aEdges.size() != bEdges.size()) return false;
+    for (size_t j = 0; j < aEdges.size(); ++j) {
+      int type = aEdges[j]->type();
+      if (bEdges[j]->type() != type) return false;
+      const Point2 *aPoints = aEdges[j]->controlPoints(), *bPoints = bEdges[j]->controlPoints();
+      for (int k = 0; k <= type; ++k) {
+        if (aPoints[k] != bPoints[k]) return false;
+      }
+    }
+  }
+  return true;
+}
+}// namespace msdfgen
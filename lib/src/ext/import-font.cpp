@@ -5,6 +5,7 @@
 #include FT_FREETYPE_H
 #include FT_OUTLINE_H
 #include FT_MULTIPLE_MASTERS_H
+#include FT_TRUETYPE_TABLES_H
 
 #include "ext/import-font.hpp"
 
@@ -39,6 +40,7 @@ class FontHandle
   friend bool loadGlyph(Shape &output, FontHandle *font, unicode_t unicode, double *advance);
   friend bool getKerning(double &output, FontHandle *font, GlyphIndex glyphIndex0, GlyphIndex glyphIndex1);
   friend bool getKerning(double &output, FontHandle *font, unicode_t unicode0, unicode_t unicode1);
+  friend bool getFontTable(std::vector<byte> &output, FontHandle *font, const char *tag);
   friend bool setFontVariationAxis(FreetypeHandle *library, FontHandle *font, const char *name, double coordinate);
   friend bool listFontVariationAxes(std::vector<FontVariationAxis> &axes, FreetypeHandle *library, FontHandle *font);
 
@@ -245,6 +247,22 @@ bool getKerning(double &output, FontHandle *font, unicode_t unicode0, unicode_t
     GlyphIndex(FT_Get_Char_Index(font->face, unicode1)));
 }
 
+bool getFontTable(std::vector<byte> &output, FontHandle *font, const char *tag)
+{
+  output.clear();
+  if (!FT_IS_SFNT(font->face)) return false;
+  FT_ULong tableTag = FT_MAKE_TAG(tag[0], tag[1], tag[2], tag[3]);
+  FT_ULong length = 0;
+  // Querying the length fails if the table is missing
+  if (FT_Load_Sfnt_Table(font->face, tableTag, 0, NULL, &length) || !length) return true;
+  output.resize(length);
+  if (FT_Load_Sfnt_Table(font->face, tableTag, 0, output.data(), &length)) {
+    output.clear();
+    return false;
+  }
+  return true;
+}
+
 bool setFontVariationAxis(FreetypeHandle *library, FontHandle *font, const char *name, double coordinate)
 {
   bool success = false;
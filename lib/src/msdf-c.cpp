@@ -0,0 +1,468 @@
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "atlas/FontGeometry.hpp"
+#include "atlas/ImmediateAtlasGenerator.hpp"
+#include "atlas/TightAtlasPacker.hpp"
+#include "atlas/glyph-generators.hpp"
+#include "core/edge-coloring.hpp"
+#include "core/pixel-conversion.hpp"
+#include "ext/import-font.hpp"
+#include "msdf-c.h"
+
+using namespace msdf_atlas;
+
+struct msdf_font
+{
+  msdfgen::FreetypeHandle *ft;
+  msdfgen::FontHandle *handle;
+  /// Font file contents, which must outlive the handle when loaded from memory
+  std::vector<byte> data;
+  msdfgen::FontMetrics metrics;
+  double geometryScale;
+
+  msdf_font() : ft(msdfgen::initializeFreetype()), handle(nullptr), metrics(), geometryScale() {}
+  ~msdf_font()
+  {
+    if (handle) msdfgen::destroyFont(handle);
+    if (ft) msdfgen::deinitializeFreetype(ft);
+  }
+};
+
+struct msdf_glyph_set
+{
+  std::vector<GlyphGeometry> glyphs;
+  /// Atlas dimensions, only valid if packed
+  int width, height;
+  bool packed;
+
+  msdf_glyph_set() : width(0), height(0), packed(false) {}
+};
+
+struct msdf_context
+{
+  msdfgen::GeneratorContext generatorContext;
+  /// Float bitmap of the glyph being generated, before it is converted to bytes
+  std::vector<float> bitmap;
+};
+
+/// Atlas storage that writes into a buffer provided by the caller
+template<typename T, int N> class BufferAtlasStorage
+{
+
+public:
+  BufferAtlasStorage(int width, int height, T *pixels) : bitmap(pixels, width, height)
+  {
+    memset(pixels, 0, sizeof(T) * N * width * height);
+  }
+  template<typename S> void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap)
+  {
+    blit(bitmap, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
+  }
+
+private:
+  msdfgen::BitmapRef<T, N> bitmap;
+};
+
+/// Converts the exception being handled into a status, so that no exception crosses the C interface
+static msdf_status exceptionStatus()
+{
+  try {
+    throw;
+  } catch (const std::bad_alloc &) {
+    return MSDF_OUT_OF_MEMORY;
+  } catch (...) {
+    return MSDF_INTERNAL_ERROR;
+  }
+}
+
+static bool validImageType(msdf_image_type imageType)
+{
+  return imageType >= MSDF_IMAGE_HARD_MASK && imageType <= MSDF_IMAGE_MTSDF;
+}
+
+static int resolveThreadCount(int threadCount)
+{
+  return threadCount > 0 ? threadCount : std::max((int)std::thread::hardware_concurrency(), 1);
+}
+
+/// Same defaults as msdf-atlas-gen with preprocessed geometry
+static GeneratorAttributes defaultGeneratorAttributes()
+{
+  GeneratorAttributes attributes;
+  attributes.config.overlapSupport = true;
+  attributes.scanlinePass = true;
+  attributes.config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
+  return attributes;
+}
+
+static msdf_font *loadFont(msdf_font *font)
+{
+  if (!(font->handle && msdfgen::getFontMetrics(font->metrics, font->handle))) {
+    delete font;
+    return nullptr;
+  }
+  // Same normalization as FontGeometry::loadMetrics, which makes the geometry and metrics scale 1 em to 1 unit
+  msdfgen::FontMetrics &metrics = font->metrics;
+  if (metrics.emSize <= 0) metrics.emSize = MSDFLIB_DEFAULT_EM_SIZE;
+  font->geometryScale = 1 / metrics.emSize;
+  metrics.emSize = 1;
+  metrics.ascenderY *= font->geometryScale;
+  metrics.descenderY *= font->geometryScale;
+  metrics.lineHeight *= font->geometryScale;
+  metrics.underlineY *= font->geometryScale;
+  metrics.underlineThickness *= font->geometryScale;
+  return font;
+}
+
+template<typename T, int N, GeneratorFunction<float, N> GEN_FN>
+static void generateAtlasPixels(const msdf_glyph_set *glyphs, T *pixels, int threadCount)
+{
+  ImmediateAtlasGenerator<float, N, GEN_FN, BufferAtlasStorage<T, N>> generator(glyphs->width, glyphs->height, pixels);
+  generator.setAttributes(defaultGeneratorAttributes());
+  generator.setThreadCount(threadCount);
+  generator.generate(glyphs->glyphs.data(), (int)glyphs->glyphs.size());
+}
+
+template<typename T>
+static msdf_status generateAtlas(const msdf_glyph_set *glyphs,
+  msdf_image_type imageType,
+  T *pixels,
+  size_t size,
+  int threadCount)
+{
+  if (!(glyphs && glyphs->packed && validImageType(imageType) && pixels)) return MSDF_INVALID_ARGUMENT;
+  if (size < (size_t)msdf_image_type_channels(imageType) * glyphs->width * glyphs->height)
+    return MSDF_BUFFER_TOO_SMALL;
+  try {
+    threadCount = resolveThreadCount(threadCount);
+    switch (imageType) {
+    case MSDF_IMAGE_HARD_MASK:
+      generateAtlasPixels<T, 1, scanlineGenerator>(glyphs, pixels, threadCount);
+      break;
+    // A soft mask only differs from an SDF by its range of 1 pixel, which is given by the layout
+    case MSDF_IMAGE_SOFT_MASK:
+    case MSDF_IMAGE_SDF:
+      generateAtlasPixels<T, 1, sdfGenerator>(glyphs, pixels, threadCount);
+      break;
+    case MSDF_IMAGE_PSDF:
+      generateAtlasPixels<T, 1, psdfGenerator>(glyphs, pixels, threadCount);
+      break;
+    case MSDF_IMAGE_MSDF:
+      generateAtlasPixels<T, 3, msdfGenerator>(glyphs, pixels, threadCount);
+      break;
+    case MSDF_IMAGE_MTSDF:
+      generateAtlasPixels<T, 4, mtsdfGenerator>(glyphs, pixels, threadCount);
+      break;
+    }
+  } catch (...) {
+    return exceptionStatus();
+  }
+  return MSDF_OK;
+}
+
+/// Float pixels are generated directly into the caller's buffer, bytes are converted from the context's bitmap
+static float *glyphBitmap(msdf_context *, float *pixels, size_t) { return pixels; }
+
+static float *glyphBitmap(msdf_context *context, byte *, size_t size)
+{
+  if (context->bitmap.size() < size) context->bitmap.resize(size);
+  return context->bitmap.data();
+}
+
+static void storeGlyphBitmap(float *, const float *, size_t) {}
+
+static void storeGlyphBitmap(byte *pixels, const float *bitmap, size_t size)
+{
+  for (size_t i = 0; i < size; ++i) pixels[i] = msdfgen::pixelFloatToByte(bitmap[i]);
+}
+
+template<typename T>
+static msdf_status generateGlyph(msdf_context *context,
+  const msdf_glyph_set *glyphs,
+  size_t glyph,
+  msdf_image_type imageType,
+  T *pixels,
+  size_t size)
+{
+  if (!(context && glyphs && glyph < glyphs->glyphs.size() && validImageType(imageType))) return MSDF_INVALID_ARGUMENT;
+  const GlyphGeometry &geometry = glyphs->glyphs[glyph];
+  int w, h;
+  geometry.getBoxBitmapSize(w, h);
+  if (!(w > 0 && h > 0)) return MSDF_OK;
+  size_t bitmapSize = (size_t)msdf_image_type_channels(imageType) * w * h;
+  if (!pixels) return MSDF_INVALID_ARGUMENT;
+  if (size < bitmapSize) return MSDF_BUFFER_TOO_SMALL;
+  try {
+    float *bitmap = glyphBitmap(context, pixels, bitmapSize);
+    GeneratorAttributes attributes = defaultGeneratorAttributes();
+    attributes.context = &context->generatorContext;
+    switch (imageType) {
+    case MSDF_IMAGE_HARD_MASK:
+      scanlineGenerator(msdfgen::BitmapRef<float, 1>(bitmap, w, h), geometry, attributes);
+      break;
+    case MSDF_IMAGE_SOFT_MASK:
+    case MSDF_IMAGE_SDF:
+      sdfGenerator(msdfgen::BitmapRef<float, 1>(bitmap, w, h), geometry, attributes);
+      break;
+    case MSDF_IMAGE_PSDF:
+      psdfGenerator(msdfgen::BitmapRef<float, 1>(bitmap, w, h), geometry, attributes);
+      break;
+    case MSDF_IMAGE_MSDF:
+      msdfGenerator(msdfgen::BitmapRef<float, 3>(bitmap, w, h), geometry, attributes);
+      break;
+    case MSDF_IMAGE_MTSDF:
+      mtsdfGenerator(msdfgen::BitmapRef<float, 4>(bitmap, w, h), geometry, attributes);
+      break;
+    }
+    storeGlyphBitmap(pixels, bitmap, bitmapSize);
+  } catch (...) {
+    return exceptionStatus();
+  }
+  return MSDF_OK;
+}
+
+extern "C" {
+
+int msdf_get_api_version(void) { return MSDF_API_VERSION; }
+
+int msdf_image_type_channels(msdf_image_type image_type)
+{
+  switch (image_type) {
+  case MSDF_IMAGE_MSDF:
+    return 3;
+  case MSDF_IMAGE_MTSDF:
+    return 4;
+  default:
+    return 1;
+  }
+}
+
+msdf_font *msdf_font_load(const char *filename)
+{
+  if (!filename) return nullptr;
+  msdf_font *font = nullptr;
+  try {
+    font = new msdf_font;
+    if (font->ft) font->handle = msdfgen::loadFont(font->ft, filename);
+    return loadFont(font);
+  } catch (...) {
+    delete font;
+    return nullptr;
+  }
+}
+
+msdf_font *msdf_font_load_data(const unsigned char *data, size_t size)
+{
+  if (!(data && size && size <= 0x7fffffff)) return nullptr;
+  msdf_font *font = nullptr;
+  try {
+    font = new msdf_font;
+    font->data.assign(data, data + size);
+    if (font->ft) font->handle = msdfgen::loadFontData(font->ft, font->data.data(), (int)size);
+    return loadFont(font);
+  } catch (...) {
+    delete font;
+    return nullptr;
+  }
+}
+
+void msdf_font_destroy(msdf_font *font) { delete font; }
+
+msdf_status msdf_font_get_metrics(const msdf_font *font, msdf_font_metrics *metrics)
+{
+  if (!(font && metrics)) return MSDF_INVALID_ARGUMENT;
+  metrics->line_height = font->metrics.lineHeight;
+  metrics->ascender = font->metrics.ascenderY;
+  metrics->descender = font->metrics.descenderY;
+  metrics->underline_y = font->metrics.underlineY;
+  metrics->underline_thickness = font->metrics.underlineThickness;
+  return MSDF_OK;
+}
+
+msdf_glyph_set *msdf_glyph_set_create(void) { return new (std::nothrow) msdf_glyph_set; }
+
+void msdf_glyph_set_destroy(msdf_glyph_set *glyphs) { delete glyphs; }
+
+msdf_status msdf_glyph_set_add(msdf_glyph_set *glyphs,
+  msdf_font *font,
+  const uint32_t *identifiers,
+  size_t count,
+  int glyph_indices,
+  size_t *added)
+{
+  if (added) *added = 0;
+  if (!(glyphs && font && (identifiers || !count))) return MSDF_INVALID_ARGUMENT;
+  size_t prevCount = glyphs->glyphs.size();
+  try {
+    GlyphGeometry glyph;
+    for (size_t i = 0; i < count; ++i) {
+      bool loaded = glyph_indices ? glyph.load(font->handle, font->geometryScale, msdfgen::GlyphIndex(identifiers[i]))
+                                  : glyph.load(font->handle, font->geometryScale, (unicode_t)identifiers[i]);
+      if (loaded) glyphs->glyphs.push_back(glyph);
+    }
+  } catch (...) {
+    // Either all or none of the glyphs are added
+    glyphs->glyphs.erase(glyphs->glyphs.begin() + prevCount, glyphs->glyphs.end());
+    return exceptionStatus();
+  }
+  // The new glyphs have no boxes yet
+  if (glyphs->glyphs.size() > prevCount) glyphs->packed = false;
+  if (added) *added = glyphs->glyphs.size() - prevCount;
+  return MSDF_OK;
+}
+
+size_t msdf_glyph_set_get_count(const msdf_glyph_set *glyphs) { return glyphs ? glyphs->glyphs.size() : 0; }
+
+msdf_status msdf_glyph_set_get_glyph(const msdf_glyph_set *glyphs, size_t glyph, msdf_glyph_info *info)
+{
+  if (!(glyphs && glyph < glyphs->glyphs.size() && info)) return MSDF_INVALID_ARGUMENT;
+  const GlyphGeometry &geometry = glyphs->glyphs[glyph];
+  info->codepoint = geometry.getCodepoint();
+  info->glyph_index = geometry.getGlyphIndex().getIndex();
+  info->advance = geometry.getAdvance();
+  geometry.getBoxBitmapSize(info->width, info->height);
+  geometry.getQuadPlaneBounds(info->plane_left, info->plane_bottom, info->plane_right, info->plane_top);
+  if (glyphs->packed)
+    geometry.getQuadAtlasBounds(info->atlas_left, info->atlas_bottom, info->atlas_right, info->atlas_top);
+  else
+    info->atlas_left = 0, info->atlas_bottom = 0, info->atlas_right = 0, info->atlas_top = 0;
+  return MSDF_OK;
+}
+
+msdf_status msdf_glyph_set_color_edges(msdf_glyph_set *glyphs,
+  msdf_edge_coloring coloring,
+  double angle_threshold,
+  unsigned long long seed)
+{
+  void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long) = nullptr;
+  switch (coloring) {
+  case MSDF_COLORING_SIMPLE:
+    edgeColoring = &msdfgen::edgeColoringSimple;
+    break;
+  case MSDF_COLORING_INKTRAP:
+    edgeColoring = &msdfgen::edgeColoringInkTrap;
+    break;
+  case MSDF_COLORING_DISTANCE:
+    edgeColoring = &msdfgen::edgeColoringByDistance;
+    break;
+  }
+  if (!(glyphs && edgeColoring)) return MSDF_INVALID_ARGUMENT;
+  try {
+    for (size_t i = 0; i < glyphs->glyphs.size(); ++i) {
+      unsigned long long glyphSeed = (MSDFLIB_LCG_MULTIPLIER * (seed ^ i) + MSDFLIB_LCG_INCREMENT) * !!seed;
+      glyphs->glyphs[i].edgeColoring(edgeColoring, angle_threshold, glyphSeed);
+    }
+  } catch (...) {
+    return exceptionStatus();
+  }
+  return MSDF_OK;
+}
+
+void msdf_pack_settings_init(msdf_pack_settings *settings)
+{
+  if (!settings) return;
+  settings->width = 0, settings->height = 0;
+  settings->dimensions_constraint = MSDF_DIMENSIONS_MULTIPLE_OF_FOUR_SQUARE;
+  settings->em_size = 0;
+  settings->min_em_size = MSDFLIB_DEFAULT_EM_SIZE;
+  settings->px_range = 2;
+  settings->miter_limit = 1;
+  settings->spacing = 0;
+  settings->thread_count = 0;
+}
+
+msdf_status msdf_glyph_set_pack(msdf_glyph_set *glyphs, const msdf_pack_settings *settings, msdf_layout *layout)
+{
+  if (!(glyphs && settings && settings->dimensions_constraint >= MSDF_DIMENSIONS_NONE
+        && settings->dimensions_constraint <= MSDF_DIMENSIONS_POWER_OF_TWO_SQUARE))
+    return MSDF_INVALID_ARGUMENT;
+  glyphs->packed = false;
+  try {
+    TightAtlasPacker atlasPacker;
+    if (settings->width > 0 && settings->height > 0)
+      atlasPacker.setDimensions(settings->width, settings->height);
+    else
+      atlasPacker.setDimensionsConstraint((DimensionsConstraint)settings->dimensions_constraint);
+    atlasPacker.setSpacing(settings->spacing);
+    if (settings->em_size > 0)
+      atlasPacker.setScale(settings->em_size);
+    else
+      atlasPacker.setMinimumScale(settings->min_em_size);
+    atlasPacker.setPixelRange(settings->px_range);
+    atlasPacker.setMiterLimit(settings->miter_limit);
+    atlasPacker.setOriginPixelAlignment(false, true);
+    atlasPacker.setThreadCount(resolveThreadCount(settings->thread_count));
+    if (atlasPacker.pack(glyphs->glyphs.data(), (int)glyphs->glyphs.size())) return MSDF_PACKING_FAILED;
+    atlasPacker.getDimensions(glyphs->width, glyphs->height);
+    if (!(glyphs->width > 0 && glyphs->height > 0)) return MSDF_PACKING_FAILED;
+    glyphs->packed = true;
+    if (layout) {
+      layout->width = glyphs->width;
+      layout->height = glyphs->height;
+      layout->em_size = atlasPacker.getScale();
+      layout->px_range = atlasPacker.getPixelRange();
+    }
+  } catch (...) {
+    return exceptionStatus();
+  }
+  return MSDF_OK;
+}
+
+msdf_status msdf_glyph_set_wrap(msdf_glyph_set *glyphs, double em_size, double px_range, double miter_limit)
+{
+  if (!(glyphs && em_size > 0)) return MSDF_INVALID_ARGUMENT;
+  glyphs->packed = false;
+  try {
+    for (GlyphGeometry &glyph : glyphs->glyphs) glyph.wrapBox(em_size, px_range / em_size, miter_limit, false, true);
+  } catch (...) {
+    return exceptionStatus();
+  }
+  return MSDF_OK;
+}
+
+msdf_status msdf_glyph_set_generate_atlas(const msdf_glyph_set *glyphs,
+  msdf_image_type image_type,
+  float *pixels,
+  size_t size,
+  int thread_count)
+{
+  return generateAtlas(glyphs, image_type, pixels, size, thread_count);
+}
+
+msdf_status msdf_glyph_set_generate_atlas_8bit(const msdf_glyph_set *glyphs,
+  msdf_image_type image_type,
+  unsigned char *pixels,
+  size_t size,
+  int thread_count)
+{
+  return generateAtlas(glyphs, image_type, pixels, size, thread_count);
+}
+
+msdf_context *msdf_context_create(void) { return new (std::nothrow) msdf_context; }
+
+void msdf_context_destroy(msdf_context *context) { delete context; }
+
+msdf_status msdf_generate_glyph(msdf_context *context,
+  const msdf_glyph_set *glyphs,
+  size_t glyph,
+  msdf_image_type image_type,
+  float *pixels,
+  size_t size)
+{
+  return generateGlyph(context, glyphs, glyph, image_type, pixels, size);
+}
+
+msdf_status msdf_generate_glyph_8bit(msdf_context *context,
+  const msdf_glyph_set *glyphs,
+  size_t glyph,
+  msdf_image_type image_type,
+  unsigned char *pixels,
+  size_t size)
+{
+  return generateGlyph(context, glyphs, glyph, image_type, pixels, size);
+}
+}
@@ -1,87 +1,14 @@
 #include "msdfgen.hpp"
-#include "core/ShapeDistanceFinder.hpp"
-#include "core/contour-combiners.hpp"
-#include "core/edge-selectors.hpp"
-#include "core/msdf-error-correction.hpp"
+#include "core/GeneratorContext.hpp"
 
 namespace msdfgen {
-template<typename DistanceType> class DistancePixelConversion;
-
-template<> class DistancePixelConversion<double>
-{
-  double invRange;
-
-public:
-  typedef BitmapRef<float, 1> BitmapRefType;
-  inline explicit DistancePixelConversion(double range) : invRange(1 / range) {}
-  inline void operator()(float *pixels, double distance) const { *pixels = float(invRange * distance + .5); }
-};
-
-template<> class DistancePixelConversion<MultiDistance>
-{
-  double invRange;
-
-public:
-  typedef BitmapRef<float, 3> BitmapRefType;
-  inline explicit DistancePixelConversion(double range) : invRange(1 / range) {}
-  inline void operator()(float *pixels, const MultiDistance &distance) const
-  {
-    pixels[0] = float(invRange * distance.r + .5);
-    pixels[1] = float(invRange * distance.g + .5);
-    pixels[2] = float(invRange * distance.b + .5);
-  }
-};
-
-template<> class DistancePixelConversion<MultiAndTrueDistance>
-{
-  double invRange;
-
-public:
-  typedef BitmapRef<float, 4> BitmapRefType;
-  inline explicit DistancePixelConversion(double range) : invRange(1 / range) {}
-  inline void operator()(float *pixels, const MultiAndTrueDistance &distance) const
-  {
-    pixels[0] = float(invRange * distance.r + .5);
-    pixels[1] = float(invRange * distance.g + .5);
-    pixels[2] = float(invRange * distance.b + .5);
-    pixels[3] = float(invRange * distance.a + .5);
-  }
-};
-
-template<class ContourCombiner>
-void generateDistanceField(
-  const typename DistancePixelConversion<typename ContourCombiner::DistanceType>::BitmapRefType &output,
-  const Shape &shape,
-  const Projection &projection,
-  double range)
-{
-  DistancePixelConversion<typename ContourCombiner::DistanceType> distancePixelConversion(range);
-  {
-    ShapeDistanceFinder<ContourCombiner> distanceFinder(shape);
-    bool rightToLeft = false;
-    for (int y = 0; y < output.height; ++y) {
-      int row = shape.inverseYAxis ? output.height - y - 1 : y;
-      for (int col = 0; col < output.width; ++col) {
-        int x = rightToLeft ? output.width - col - 1 : col;
-        Point2 p = projection.unproject(Point2(x + .5, y + .5));
-        typename ContourCombiner::DistanceType distance = distanceFinder.distance(p);
-        distancePixelConversion(output(x, row), distance);
-      }
-      rightToLeft = !rightToLeft;
-    }
-  }
-}
-
 void generateSDF(const BitmapRef<float, 1> &output,
   const Shape &shape,
   const Projection &projection,
   double range,
   const GeneratorConfig &config)
 {
-  if (config.overlapSupport)
-    generateDistanceField<OverlappingContourCombiner<TrueDistanceSelector>>(output, shape, projection, range);
-  else
-    generateDistanceField<SimpleContourCombiner<TrueDistanceSelector>>(output, shape, projection, range);
+  GeneratorContext().generateSDF(output, shape, projection, range, config);
 }
 
 void generatePSDF(const BitmapRef<float, 1> &output,
@@ -90,10 +17,7 @@ void generatePSDF(const BitmapRef<float, 1> &output,
   double range,
   const GeneratorConfig &config)
 {
-  if (config.overlapSupport)
-    generateDistanceField<OverlappingContourCombiner<PerpendicularDistanceSelector>>(output, shape, projection, range);
-  else
-    generateDistanceField<SimpleContourCombiner<PerpendicularDistanceSelector>>(output, shape, projection, range);
+  GeneratorContext().generatePSDF(output, shape, projection, range, config);
 }
 
 void generateMSDF(const BitmapRef<float, 3> &output,
@@ -102,11 +26,7 @@ void generateMSDF(const BitmapRef<float, 3> &output,
   double range,
   const MSDFGeneratorConfig &config)
 {
-  if (config.overlapSupport)
-    generateDistanceField<OverlappingContourCombiner<MultiDistanceSelector>>(output, shape, projection, range);
-  else
-    generateDistanceField<SimpleContourCombiner<MultiDistanceSelector>>(output, shape, projection, range);
-  msdfErrorCorrection(output, shape, projection, range, config);
+  GeneratorContext().generateMSDF(output, shape, projection, range, config);
 }
 
 void generateMTSDF(const BitmapRef<float, 4> &output,
@@ -115,10 +35,6 @@ void generateMTSDF(const BitmapRef<float, 4> &output,
   double range,
   const MSDFGeneratorConfig &config)
 {
-  if (config.overlapSupport)
-    generateDistanceField<OverlappingContourCombiner<MultiAndTrueDistanceSelector>>(output, shape, projection, range);
-  else
-    generateDistanceField<SimpleContourCombiner<MultiAndTrueDistanceSelector>>(output, shape, projection, range);
-  msdfErrorCorrection(output, shape, projection, range, config);
+  GeneratorContext().generateMTSDF(output, shape, projection, range, config);
 }
 }// namespace msdfgen